@@ -3,16 +3,11 @@
 layout(location = 0) in vec3 vDirection;
 layout(location = 0) out vec4 outFragColor;
 
-layout(set = 0, binding = 0) uniform sampler2D hdrImage;
+layout(set = 0, binding = 0) uniform samplerCube hdrCubemap;
 
 void main() {
-    vec3 dir = normalize(vDirection);
-
-    vec2 uv;
-    uv.x = atan(dir.z, dir.x) / (2.0 * 3.1415926) + 0.5;
-    uv.y = asin(dir.y) / 3.1415926 + 0.5;
-
-    vec3 hdrColor = texture(hdrImage, uv).rgb;
+    // Resampled from the panorama at load time, one lookup and the hardware picks the mip
+    vec3 hdrColor = texture(hdrCubemap, vDirection).rgb;
 
     // Tonemapping: Reinhard
     hdrColor = hdrColor / (hdrColor + vec3(1.0));
@@ -0,0 +1,25 @@
+// Needs packed_vertex.glsl for VertexBufferRef
+
+// Matches GPUDrawObject in PantomirEngine.h
+struct DrawObject {
+    mat4 transform;
+    vec4 positionOffset;
+    vec4 positionScale;
+    vec4 boundingSphere;    // xyz object space center, w radius
+    VertexBufferRef vertexBuffer;
+    uint materialIndex;
+    uint firstIndex;
+    uint indexCount;
+    int vertexOffset;
+    uint batchIndex;        // Its draw count slot
+    uint firstCommand;      // Where its batch's indirect commands start
+    float maxScale;
+    uint lodCount;
+    uint padding0;
+    uint padding1;
+    uvec2 lods[4];          // Levels 1 to lodCount, x first index, y index count
+};
+
+layout(buffer_reference, std430) readonly buffer DrawObjectBufferRef {
+    DrawObject objects[];
+};
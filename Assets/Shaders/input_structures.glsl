@@ -8,7 +8,8 @@ layout (set = 0, binding = 0) uniform SceneData {
     vec4 sunlightColor;
 } sceneData;
 
-layout (set = 1, binding = 0) uniform GLTFMaterialData {
+// Matches GLTFMetallic_Roughness::GPUMaterial, texture fields index the bindless texture array
+struct MaterialData {
     vec4 colorFactors;
     vec4 metalRoughFactors;
     vec3 emissiveFactors;
@@ -16,10 +17,16 @@ layout (set = 1, binding = 0) uniform GLTFMaterialData {
     float specularFactor;
     float alphaCutoff;
     int alphaMode;
-} materialData;
+    float padding0;
+    uint colorTexture;
+    uint metalRoughTexture;
+    uint emissiveTexture;
+    uint normalTexture;
+    uint specularTexture;
+};
 
-layout (set = 1, binding = 1) uniform sampler2D colorTexSampler;
-layout (set = 1, binding = 2) uniform sampler2D metalRoughTexSampler;
-layout (set = 1, binding = 3) uniform sampler2D emissiveTexSampler;
-layout (set = 1, binding = 4) uniform sampler2D normalTexSampler;
-layout (set = 1, binding = 5) uniform sampler2D specularTexSampler;
\ No newline at end of file
+layout (set = 1, binding = 0, std430) readonly buffer MaterialBuffer {
+    MaterialData materials[];
+};
+
+layout (set = 1, binding = 1) uniform sampler2D textures[];
\ No newline at end of file
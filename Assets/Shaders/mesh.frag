@@ -1,6 +1,7 @@
 #version 450
 
 #extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_nonuniform_qualifier : require
 #include "input_structures.glsl"
 
 layout (location = 0) in vec3 inNormal;
@@ -10,15 +11,18 @@ layout (location = 3) in vec3 inTangent;
 layout (location = 4) in vec3 inBitangent;
 layout (location = 5) in vec3 inNormalWS;
 layout (location = 6) in vec3 inWorldPos;
+layout (location = 7) flat in uint inMaterialIndex;
 
 layout (location = 0) out vec4 outFragColor;
 
 void main()
 {
-    vec4 texColor       = texture(colorTexSampler, inUV);
-    vec4 texMetalRough  = texture(metalRoughTexSampler, inUV);
-    vec3 texEmissive    = texture(emissiveTexSampler, inUV).rgb;
-    vec3 texSpecular    = texture(specularTexSampler, inUV).rgb;
+    MaterialData materialData = materials[inMaterialIndex];
+
+    vec4 texColor       = texture(textures[nonuniformEXT(materialData.colorTexture)], inUV);
+    vec4 texMetalRough  = texture(textures[nonuniformEXT(materialData.metalRoughTexture)], inUV);
+    vec3 texEmissive    = texture(textures[nonuniformEXT(materialData.emissiveTexture)], inUV).rgb;
+    vec3 texSpecular    = texture(textures[nonuniformEXT(materialData.specularTexture)], inUV).rgb;
 
     if (texColor.a < 0.1)
     discard;
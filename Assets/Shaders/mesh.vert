@@ -2,8 +2,10 @@
 
 #extension GL_GOOGLE_include_directive : require
 #extension GL_EXT_buffer_reference : require
+#extension GL_EXT_nonuniform_qualifier : require
 
 #include "input_structures.glsl"
+#include "packed_vertex.glsl"
 
 layout (location = 0) out vec3 outNormal;
 layout (location = 1) out vec3 outColor;
@@ -12,37 +14,29 @@ layout (location = 3) out vec3 outTangent;
 layout (location = 4) out vec3 outBitangent;
 layout (location = 5) out vec3 outNormalWS;
 layout (location = 6) out vec3 outWorldPos;
-
-struct Vertex {
-    vec3 position;
-    float uv_x;
-    vec3 normal;
-    float uv_y;
-    vec4 tangent;
-    vec4 color;
-};
-
-layout(buffer_reference, std430) readonly buffer VertexBufferRef {
-    Vertex vertices[];
-};
+layout (location = 7) flat out uint outMaterialIndex;
 
 layout(push_constant) uniform constants {
     mat4 renderMatrix;
+    vec4 positionOffset;
+    vec4 positionScale;
     VertexBufferRef vertexBufferRef;
+    uint materialIndex;
 } PushConstants;
 
 void main()
 {
-    Vertex vertex = PushConstants.vertexBufferRef.vertices[gl_VertexIndex];
+    PackedVertex vertex = PushConstants.vertexBufferRef.vertices[gl_VertexIndex];
 
-    vec3 position = vertex.position;
-    vec3 normal = vertex.normal;
-    vec3 tangent = vertex.tangent.xyz;
-    float handedness = vertex.tangent.w;
+    vec2 positionZ = unpackUnorm2x16(vertex.positionZ);
+    vec3 position = PushConstants.positionOffset.xyz + vec3(unpackUnorm2x16(vertex.positionXY), positionZ.x) * PushConstants.positionScale.xyz;
+    vec3 normal = OctahedralDecode(unpackSnorm2x16(vertex.normal));
+    vec3 tangent = OctahedralDecode(unpackSnorm2x16(vertex.tangent));
+    float handedness = positionZ.y > 0.5 ? 1.0 : -1.0;
     vec3 bitangent = cross(normal, tangent) * handedness;
 
-    vec2 uv = vec2(vertex.uv_x, vertex.uv_y);
-    vec3 color = vertex.color.rgb;
+    vec2 uv = unpackHalf2x16(vertex.uv);
+    vec3 color = unpackUnorm4x8(vertex.color).rgb;
 
     vec4 worldPos = PushConstants.renderMatrix * vec4(position, 1.0);
     gl_Position = sceneData.viewproj * worldPos;
@@ -56,4 +50,5 @@ void main()
     outUV         = uv;
     outColor      = color;
     outWorldPos   = worldPos.xyz;
+    outMaterialIndex = PushConstants.materialIndex;
 }
@@ -0,0 +1,55 @@
+#version 460
+
+#extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_nonuniform_qualifier : require
+
+#include "input_structures.glsl"
+#include "packed_vertex.glsl"
+#include "draw_object.glsl"
+
+// mesh.vert for indirect draws. Every command carries its draw object's index as firstInstance, the object holds what
+// mesh.vert gets through push constants.
+layout (location = 0) out vec3 outNormal;
+layout (location = 1) out vec3 outColor;
+layout (location = 2) out vec2 outUV;
+layout (location = 3) out vec3 outTangent;
+layout (location = 4) out vec3 outBitangent;
+layout (location = 5) out vec3 outNormalWS;
+layout (location = 6) out vec3 outWorldPos;
+layout (location = 7) flat out uint outMaterialIndex;
+
+// Matches GPUDrawIndirectPushConstants in VkPushConstants.h
+layout(push_constant) uniform constants {
+    DrawObjectBufferRef drawObjectBuffer;
+} PushConstants;
+
+void main()
+{
+    DrawObject drawObject = PushConstants.drawObjectBuffer.objects[gl_InstanceIndex];
+    PackedVertex vertex = drawObject.vertexBuffer.vertices[gl_VertexIndex];
+
+    vec2 positionZ = unpackUnorm2x16(vertex.positionZ);
+    vec3 position = drawObject.positionOffset.xyz + vec3(unpackUnorm2x16(vertex.positionXY), positionZ.x) * drawObject.positionScale.xyz;
+    vec3 normal = OctahedralDecode(unpackSnorm2x16(vertex.normal));
+    vec3 tangent = OctahedralDecode(unpackSnorm2x16(vertex.tangent));
+    float handedness = positionZ.y > 0.5 ? 1.0 : -1.0;
+    vec3 bitangent = cross(normal, tangent) * handedness;
+
+    vec2 uv = unpackHalf2x16(vertex.uv);
+    vec3 color = unpackUnorm4x8(vertex.color).rgb;
+
+    vec4 worldPos = drawObject.transform * vec4(position, 1.0);
+    gl_Position = sceneData.viewproj * worldPos;
+
+    mat3 normalMatrix = transpose(inverse(mat3(drawObject.transform)));
+
+    outNormal     = normalize(normal);
+    outNormalWS   = normalize(normalMatrix * normal);
+    outTangent    = normalize(normalMatrix * tangent);
+    outBitangent  = normalize(normalMatrix * bitangent);
+    outUV         = uv;
+    outColor      = color;
+    outWorldPos   = worldPos.xyz;
+    outMaterialIndex = drawObject.materialIndex;
+}
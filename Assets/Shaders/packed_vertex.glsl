@@ -0,0 +1,22 @@
+// Matches PackedVertex in VkTypes.h
+struct PackedVertex {
+    uint positionXY;    // unorm16 x2, inside the mesh's quantization box
+    uint positionZ;     // unorm16 z, tangent handedness in the high half
+    uint normal;        // octahedral snorm16 x2
+    uint tangent;       // octahedral snorm16 x2
+    uint uv;            // half x2
+    uint color;         // unorm8 x4
+};
+
+layout(buffer_reference, std430) readonly buffer VertexBufferRef {
+    PackedVertex vertices[];
+};
+
+vec3 OctahedralDecode(vec2 encoded)
+{
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -fold : fold;
+    direction.y += direction.y >= 0.0 ? -fold : fold;
+    return normalize(direction);
+}
@@ -0,0 +1,54 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace Pantomir {
+
+	// Read-only memory mapping of a whole file. Pages are faulted in on first touch, so opening is cheap
+	// and copying out of Data() runs at disk (or page cache) speed without an intermediate buffer.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile&                operator=(MappedFile&& other) noexcept;
+
+		// Returns false if the file doesn't exist or can't be mapped. Empty files fail as well.
+		bool                       Open(const std::filesystem::path& path);
+		void                       Close();
+
+		bool                       IsOpen() const noexcept {
+			return m_data != nullptr;
+		}
+
+		const std::byte*           Data() const noexcept {
+			return m_data;
+		}
+
+		size_t                     Size() const noexcept {
+			return m_size;
+		}
+
+		std::span<const std::byte> Bytes() const noexcept {
+			return { m_data, m_size };
+		}
+
+	private:
+		const std::byte* m_data = nullptr;
+		size_t           m_size = 0;
+
+#ifdef _WIN32
+		void* m_fileHandle = nullptr;
+		void* m_mappingHandle = nullptr;
+#endif
+	};
+
+} // namespace Pantomir
+
+#endif /* MAPPEDFILE_H_ */
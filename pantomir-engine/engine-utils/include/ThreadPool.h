@@ -0,0 +1,65 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Pantomir {
+
+	// Fixed-size pool of worker threads for CPU-only jobs (decoding, cooking, parsing).
+	// Jobs must not record or submit Vulkan commands; hand results back to the main thread for that.
+	class ThreadPool {
+	public:
+		// A thread count of 0 uses every hardware thread except the caller's.
+		explicit ThreadPool(uint32_t threadCount = 0);
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		template <typename Function>
+		[[nodiscard]] std::future<std::invoke_result_t<std::decay_t<Function>>> Submit(Function&& function) {
+			using ResultType = std::invoke_result_t<std::decay_t<Function>>;
+
+			// packaged_task is move-only, std::function needs copyable callables.
+			std::shared_ptr<std::packaged_task<ResultType()>> task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(function));
+			std::future<ResultType>                           future = task->get_future();
+			Enqueue([task]() { (*task)(); });
+			return future;
+		}
+
+		// Runs function(index) for every index in [0, count) and blocks until all are done.
+		// The calling thread works through the range as well.
+		void     ParallelFor(size_t count, const std::function<void(size_t index)>& function);
+
+		// Blocks until the queue is empty and no worker is running a job.
+		void     WaitIdle();
+
+		uint32_t GetThreadCount() const noexcept {
+			return static_cast<uint32_t>(m_workers.size());
+		}
+
+	private:
+		void                              Enqueue(std::function<void()>&& job);
+		void                              WorkerLoop();
+
+		std::vector<std::thread>          m_workers;
+		std::deque<std::function<void()>> m_jobs;
+		std::mutex                        m_mutex;
+		std::condition_variable           m_jobAvailable;
+		std::condition_variable           m_idle;
+		uint32_t                          m_activeJobs = 0;
+		bool                              m_bStopping = false;
+	};
+
+} // namespace Pantomir
+
+#endif /* THREADPOOL_H_ */
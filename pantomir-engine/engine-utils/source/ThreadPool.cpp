@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace Pantomir {
+
+	ThreadPool::ThreadPool(uint32_t threadCount) {
+		if (threadCount == 0) {
+			const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			threadCount = std::max(1u, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+		}
+
+		m_workers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i) {
+			m_workers.emplace_back([this]() { WorkerLoop(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_bStopping = true;
+		}
+		m_jobAvailable.notify_all();
+
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	void ThreadPool::ParallelFor(const size_t count, const std::function<void(size_t index)>& function) {
+		if (count == 0) {
+			return;
+		}
+
+		// Workers and the caller pull indices from a shared counter, so uneven jobs balance themselves.
+		std::shared_ptr<std::atomic<size_t>> nextIndex = std::make_shared<std::atomic<size_t>>(0);
+		const auto                           drain = [nextIndex, count, &function]() {
+            for (size_t index = nextIndex->fetch_add(1); index < count; index = nextIndex->fetch_add(1)) {
+                function(index);
+            }
+		};
+
+		const size_t                   helperCount = std::min<size_t>(m_workers.size(), count - 1);
+		std::vector<std::future<void>> helpers;
+		helpers.reserve(helperCount);
+		for (size_t i = 0; i < helperCount; ++i) {
+			helpers.push_back(Submit(drain));
+		}
+
+		drain();
+
+		for (std::future<void>& helper : helpers) {
+			helper.get();
+		}
+	}
+
+	void ThreadPool::WaitIdle() {
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_jobs.empty() && m_activeJobs == 0; });
+	}
+
+	void ThreadPool::Enqueue(std::function<void()>&& job) {
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.push_back(std::move(job));
+		}
+		m_jobAvailable.notify_one();
+	}
+
+	void ThreadPool::WorkerLoop() {
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_jobAvailable.wait(lock, [this]() { return m_bStopping || !m_jobs.empty(); });
+				if (m_bStopping && m_jobs.empty()) {
+					return;
+				}
+
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+				++m_activeJobs;
+			}
+
+			job();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				--m_activeJobs;
+				if (m_jobs.empty() && m_activeJobs == 0) {
+					m_idle.notify_all();
+				}
+			}
+		}
+	}
+
+} // namespace Pantomir
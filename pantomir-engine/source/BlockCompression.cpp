@@ -0,0 +1,428 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+	// Endpoints are fitted along the principal axis of the block's colors, then refined once by least squares against the
+	// palette weights the first fit picked. Good enough for BC1 and BC7 mode 6, which both interpolate a single line.
+	template <size_t ChannelCount>
+	using Color = std::array<float, ChannelCount>;
+
+	template <size_t ChannelCount>
+	struct Endpoints {
+		Color<ChannelCount> first;
+		Color<ChannelCount> second;
+	};
+
+	template <size_t ChannelCount>
+	Color<ChannelCount> LoadTexel(const uint8_t* rgbaBlock, const size_t texel) {
+		Color<ChannelCount> color;
+		for (size_t channel = 0; channel < ChannelCount; ++channel) {
+			color[channel] = rgbaBlock[texel * 4 + channel];
+		}
+		return color;
+	}
+
+	template <size_t ChannelCount>
+	Endpoints<ChannelCount> FitPrincipalAxis(const uint8_t* rgbaBlock) {
+		Color<ChannelCount> mean {};
+		for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+			const Color<ChannelCount> color = LoadTexel<ChannelCount>(rgbaBlock, texel);
+			for (size_t channel = 0; channel < ChannelCount; ++channel) {
+				mean[channel] += color[channel] / BC_BLOCK_TEXEL_COUNT;
+			}
+		}
+
+		std::array<Color<ChannelCount>, ChannelCount> covariance {};
+		for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+			const Color<ChannelCount> color = LoadTexel<ChannelCount>(rgbaBlock, texel);
+			for (size_t row = 0; row < ChannelCount; ++row) {
+				for (size_t column = 0; column < ChannelCount; ++column) {
+					covariance[row][column] += (color[row] - mean[row]) * (color[column] - mean[column]);
+				}
+			}
+		}
+
+		// Power iteration, seeded with the channel of largest variance so flat channels cannot stall it
+		Color<ChannelCount> axis {};
+		size_t              dominantChannel = 0;
+		for (size_t channel = 1; channel < ChannelCount; ++channel) {
+			if (covariance[channel][channel] > covariance[dominantChannel][dominantChannel]) {
+				dominantChannel = channel;
+			}
+		}
+		axis[dominantChannel] = 1.0f;
+
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			Color<ChannelCount> next {};
+			float               lengthSquared = 0.0f;
+			for (size_t row = 0; row < ChannelCount; ++row) {
+				for (size_t column = 0; column < ChannelCount; ++column) {
+					next[row] += covariance[row][column] * axis[column];
+				}
+				lengthSquared += next[row] * next[row];
+			}
+
+			if (lengthSquared < 1e-12f) {
+				break; // Every texel is identical along this axis
+			}
+
+			const float inverseLength = 1.0f / std::sqrt(lengthSquared);
+			for (size_t channel = 0; channel < ChannelCount; ++channel) {
+				axis[channel] = next[channel] * inverseLength;
+			}
+		}
+
+		float minProjection = 0.0f;
+		float maxProjection = 0.0f;
+		for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+			const Color<ChannelCount> color = LoadTexel<ChannelCount>(rgbaBlock, texel);
+			float                     projection = 0.0f;
+			for (size_t channel = 0; channel < ChannelCount; ++channel) {
+				projection += (color[channel] - mean[channel]) * axis[channel];
+			}
+			minProjection = std::min(minProjection, projection);
+			maxProjection = std::max(maxProjection, projection);
+		}
+
+		Endpoints<ChannelCount> endpoints;
+		for (size_t channel = 0; channel < ChannelCount; ++channel) {
+			endpoints.first[channel] = std::clamp(mean[channel] + axis[channel] * maxProjection, 0.0f, 255.0f);
+			endpoints.second[channel] = std::clamp(mean[channel] + axis[channel] * minProjection, 0.0f, 255.0f);
+		}
+		return endpoints;
+	}
+
+	// Solves for the endpoints that minimize the squared error given each texel's interpolation weight towards the second endpoint.
+	template <size_t ChannelCount>
+	bool RefineEndpoints(const uint8_t* rgbaBlock, const std::array<float, BC_BLOCK_TEXEL_COUNT>& weights, Endpoints<ChannelCount>& inout_endpoints) {
+		float               alphaAlpha = 0.0f;
+		float               alphaBeta = 0.0f;
+		float               betaBeta = 0.0f;
+		Color<ChannelCount> alphaColor {};
+		Color<ChannelCount> betaColor {};
+		for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+			const float               beta = weights[texel];
+			const float               alpha = 1.0f - beta;
+			const Color<ChannelCount> color = LoadTexel<ChannelCount>(rgbaBlock, texel);
+
+			alphaAlpha += alpha * alpha;
+			alphaBeta += alpha * beta;
+			betaBeta += beta * beta;
+			for (size_t channel = 0; channel < ChannelCount; ++channel) {
+				alphaColor[channel] += alpha * color[channel];
+				betaColor[channel] += beta * color[channel];
+			}
+		}
+
+		const float determinant = alphaAlpha * betaBeta - alphaBeta * alphaBeta;
+		if (std::abs(determinant) < 1e-6f) {
+			return false; // All texels picked the same weight, nothing to solve
+		}
+
+		const float inverseDeterminant = 1.0f / determinant;
+		for (size_t channel = 0; channel < ChannelCount; ++channel) {
+			inout_endpoints.first[channel] = std::clamp((alphaColor[channel] * betaBeta - betaColor[channel] * alphaBeta) * inverseDeterminant, 0.0f, 255.0f);
+			inout_endpoints.second[channel] = std::clamp((betaColor[channel] * alphaAlpha - alphaColor[channel] * alphaBeta) * inverseDeterminant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	// Writes fields least significant bit first, the bit order every BCn format uses.
+	class BlockBitWriter {
+	public:
+		explicit BlockBitWriter(uint8_t* block)
+		    : m_block(block) {}
+
+		void Write(uint32_t value, const uint32_t bitCount) {
+			for (uint32_t bit = 0; bit < bitCount; ++bit, ++m_bitPosition, value >>= 1) {
+				m_block[m_bitPosition / 8] |= static_cast<uint8_t>((value & 1u) << (m_bitPosition % 8));
+			}
+		}
+
+	private:
+		uint8_t* m_block;
+		uint32_t m_bitPosition = 0;
+	};
+
+	// ---- BC1 ----
+
+	uint16_t PackRGB565(const Color<3>& color) {
+		const uint32_t red = static_cast<uint32_t>(std::lround(color[0] * 31.0f / 255.0f));
+		const uint32_t green = static_cast<uint32_t>(std::lround(color[1] * 63.0f / 255.0f));
+		const uint32_t blue = static_cast<uint32_t>(std::lround(color[2] * 31.0f / 255.0f));
+		return static_cast<uint16_t>((red << 11) | (green << 5) | blue);
+	}
+
+	Color<3> UnpackRGB565(const uint16_t packed) {
+		const uint32_t red = (packed >> 11) & 31u;
+		const uint32_t green = (packed >> 5) & 63u;
+		const uint32_t blue = packed & 31u;
+		return { static_cast<float>((red << 3) | (red >> 2)), static_cast<float>((green << 2) | (green >> 4)), static_cast<float>((blue << 3) | (blue >> 2)) };
+	}
+
+	// Returns the squared error of the block and fills the 2-bit indices for a 4-color block.
+	float SelectBC1Indices(const uint8_t* rgbaBlock, const uint16_t color0, const uint16_t color1, uint32_t& out_indices) {
+		const Color<3>                first = UnpackRGB565(color0);
+		const Color<3>                second = UnpackRGB565(color1);
+		const std::array<Color<3>, 4> palette {
+			first,
+			second,
+			Color<3> { (2 * first[0] + second[0]) / 3, (2 * first[1] + second[1]) / 3, (2 * first[2] + second[2]) / 3 },
+			Color<3> { (first[0] + 2 * second[0]) / 3, (first[1] + 2 * second[1]) / 3, (first[2] + 2 * second[2]) / 3 },
+		};
+
+		float totalError = 0.0f;
+		out_indices = 0;
+		for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+			const Color<3> color = LoadTexel<3>(rgbaBlock, texel);
+			uint32_t       bestIndex = 0;
+			float          bestError = std::numeric_limits<float>::max();
+			for (uint32_t index = 0; index < palette.size(); ++index) {
+				float error = 0.0f;
+				for (size_t channel = 0; channel < 3; ++channel) {
+					const float difference = palette[index][channel] - color[channel];
+					error += difference * difference;
+				}
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+			out_indices |= bestIndex << (texel * 2);
+			totalError += bestError;
+		}
+		return totalError;
+	}
+
+	struct BC1Candidate {
+		uint16_t color0 = 0;
+		uint16_t color1 = 0;
+		uint32_t indices = 0;
+		float    error = std::numeric_limits<float>::max();
+	};
+
+	BC1Candidate EvaluateBC1(const uint8_t* rgbaBlock, const Endpoints<3>& endpoints) {
+		BC1Candidate candidate;
+		candidate.color0 = PackRGB565(endpoints.first);
+		candidate.color1 = PackRGB565(endpoints.second);
+
+		// color0 > color1 selects the 4-color mode, equal endpoints fall back to a solid block
+		if (candidate.color0 < candidate.color1) {
+			std::swap(candidate.color0, candidate.color1);
+		}
+		if (candidate.color0 == candidate.color1) {
+			uint32_t unusedIndices = 0;
+			candidate.error = SelectBC1Indices(rgbaBlock, candidate.color0, candidate.color1, unusedIndices);
+			candidate.indices = 0;
+			return candidate;
+		}
+
+		candidate.error = SelectBC1Indices(rgbaBlock, candidate.color0, candidate.color1, candidate.indices);
+		return candidate;
+	}
+
+	// ---- BC4 ----
+
+	void EncodeSingleChannel(const uint8_t* rgbaBlock, const size_t channel, uint8_t* out_block) {
+		uint8_t minValue = 255;
+		uint8_t maxValue = 0;
+		for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+			minValue = std::min(minValue, rgbaBlock[texel * 4 + channel]);
+			maxValue = std::max(maxValue, rgbaBlock[texel * 4 + channel]);
+		}
+
+		memset(out_block, 0, 8);
+		out_block[0] = maxValue;
+		out_block[1] = minValue;
+		if (maxValue == minValue) {
+			return; // Index 0 everywhere is the first endpoint
+		}
+
+		// With endpoint0 > endpoint1 the palette is both endpoints plus 6 evenly spaced values. Index 0 is the maximum,
+		// index 1 the minimum, and index i in [2, 7] sits (8 - i) / 7 of the way from the minimum to the maximum.
+		BlockBitWriter writer(out_block + 2);
+		const float    range = static_cast<float>(maxValue - minValue);
+		for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+			const int32_t step = static_cast<int32_t>(std::lround((rgbaBlock[texel * 4 + channel] - minValue) * 7.0f / range));
+			const uint32_t index = step == 7 ? 0u : step == 0 ? 1u : static_cast<uint32_t>(8 - step);
+			writer.Write(index, 3);
+		}
+	}
+
+	// ---- BC7 mode 6 ----
+	// One subset, 7-bit RGBA endpoints with a unique P-bit each, 4-bit indices.
+
+	constexpr std::array<uint32_t, 16> BC7_WEIGHTS_4 = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct BC7Mode6Candidate {
+		std::array<std::array<uint8_t, 4>, 2> endpoints {}; // 7-bit values
+		std::array<uint8_t, 2>                pBits {};
+		std::array<uint8_t, 16>               indices {};
+		float                                 error = std::numeric_limits<float>::max();
+	};
+
+	// Picks the P-bit that lands closest to the unquantized endpoint, then returns the 7-bit channel values.
+	void QuantizeBC7Endpoint(const Color<4>& endpoint, std::array<uint8_t, 4>& out_values, uint8_t& out_pBit) {
+		float bestError = std::numeric_limits<float>::max();
+		for (uint8_t pBit = 0; pBit < 2; ++pBit) {
+			std::array<uint8_t, 4> values {};
+			float                  error = 0.0f;
+			for (size_t channel = 0; channel < 4; ++channel) {
+				values[channel] = static_cast<uint8_t>(std::clamp(std::lround((endpoint[channel] - pBit) / 2.0f), 0l, 127l));
+				const float difference = static_cast<float>((values[channel] << 1) | pBit) - endpoint[channel];
+				error += difference * difference;
+			}
+			if (error < bestError) {
+				bestError = error;
+				out_values = values;
+				out_pBit = pBit;
+			}
+		}
+	}
+
+	BC7Mode6Candidate EvaluateBC7Mode6(const uint8_t* rgbaBlock, const Endpoints<4>& endpoints) {
+		BC7Mode6Candidate candidate;
+		QuantizeBC7Endpoint(endpoints.first, candidate.endpoints[0], candidate.pBits[0]);
+		QuantizeBC7Endpoint(endpoints.second, candidate.endpoints[1], candidate.pBits[1]);
+
+		std::array<std::array<uint32_t, 4>, 16> palette {};
+		for (size_t channel = 0; channel < 4; ++channel) {
+			const uint32_t first = (candidate.endpoints[0][channel] << 1) | candidate.pBits[0];
+			const uint32_t second = (candidate.endpoints[1][channel] << 1) | candidate.pBits[1];
+			for (size_t index = 0; index < palette.size(); ++index) {
+				palette[index][channel] = ((64 - BC7_WEIGHTS_4[index]) * first + BC7_WEIGHTS_4[index] * second + 32) >> 6;
+			}
+		}
+
+		candidate.error = 0.0f;
+		for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+			uint8_t  bestIndex = 0;
+			uint32_t bestError = std::numeric_limits<uint32_t>::max();
+			for (uint8_t index = 0; index < palette.size(); ++index) {
+				uint32_t error = 0;
+				for (size_t channel = 0; channel < 4; ++channel) {
+					const int32_t difference = static_cast<int32_t>(palette[index][channel]) - rgbaBlock[texel * 4 + channel];
+					error += static_cast<uint32_t>(difference * difference);
+				}
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+			candidate.indices[texel] = bestIndex;
+			candidate.error += static_cast<float>(bestError);
+		}
+		return candidate;
+	}
+} // namespace
+
+size_t GetBlockByteSize(const TextureCompression compression) {
+	switch (compression) {
+		case TextureCompression::BC1:
+		case TextureCompression::BC4:
+			return 8;
+		case TextureCompression::BC5:
+		case TextureCompression::BC7:
+			return 16;
+		case TextureCompression::None:
+		default:
+			return 0;
+	}
+}
+
+void EncodeBC1Block(const uint8_t* rgbaBlock, uint8_t* out_block) {
+	Endpoints<3> endpoints = FitPrincipalAxis<3>(rgbaBlock);
+	BC1Candidate best = EvaluateBC1(rgbaBlock, endpoints);
+
+	// Weight of each texel towards color1, in the palette order color0, color1, 2/3 color0, 1/3 color0
+	constexpr std::array<float, 4>           paletteWeights = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+	std::array<float, BC_BLOCK_TEXEL_COUNT> weights {};
+	for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+		weights[texel] = paletteWeights[(best.indices >> (texel * 2)) & 3u];
+	}
+
+	endpoints = { UnpackRGB565(best.color0), UnpackRGB565(best.color1) };
+	if (RefineEndpoints<3>(rgbaBlock, weights, endpoints)) {
+		if (const BC1Candidate refined = EvaluateBC1(rgbaBlock, endpoints); refined.error < best.error) {
+			best = refined;
+		}
+	}
+
+	out_block[0] = static_cast<uint8_t>(best.color0 & 0xFF);
+	out_block[1] = static_cast<uint8_t>(best.color0 >> 8);
+	out_block[2] = static_cast<uint8_t>(best.color1 & 0xFF);
+	out_block[3] = static_cast<uint8_t>(best.color1 >> 8);
+	memcpy(out_block + 4, &best.indices, sizeof(best.indices)); // Little-endian, like the rest of the engine's targets
+}
+
+void EncodeBC4Block(const uint8_t* rgbaBlock, const size_t channel, uint8_t* out_block) {
+	EncodeSingleChannel(rgbaBlock, channel, out_block);
+}
+
+void EncodeBC5Block(const uint8_t* rgbaBlock, uint8_t* out_block) {
+	EncodeSingleChannel(rgbaBlock, 0, out_block);
+	EncodeSingleChannel(rgbaBlock, 1, out_block + 8);
+}
+
+void EncodeBC7Block(const uint8_t* rgbaBlock, uint8_t* out_block) {
+	Endpoints<4>      endpoints = FitPrincipalAxis<4>(rgbaBlock);
+	BC7Mode6Candidate best = EvaluateBC7Mode6(rgbaBlock, endpoints);
+
+	std::array<float, BC_BLOCK_TEXEL_COUNT> weights {};
+	for (size_t texel = 0; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+		weights[texel] = static_cast<float>(BC7_WEIGHTS_4[best.indices[texel]]) / 64.0f;
+	}
+	if (RefineEndpoints<4>(rgbaBlock, weights, endpoints)) {
+		if (const BC7Mode6Candidate refined = EvaluateBC7Mode6(rgbaBlock, endpoints); refined.error < best.error) {
+			best = refined;
+		}
+	}
+
+	// The anchor texel stores one bit less, so its index must have the top bit clear. Mirror the palette if it does not.
+	if (best.indices[0] & 8u) {
+		std::swap(best.endpoints[0], best.endpoints[1]);
+		std::swap(best.pBits[0], best.pBits[1]);
+		for (uint8_t& index : best.indices) {
+			index = static_cast<uint8_t>(15u - index);
+		}
+	}
+
+	memset(out_block, 0, 16);
+	BlockBitWriter writer(out_block);
+	writer.Write(1u << 6, 7); // Mode 6
+	for (size_t channel = 0; channel < 4; ++channel) {
+		writer.Write(best.endpoints[0][channel], 7);
+		writer.Write(best.endpoints[1][channel], 7);
+	}
+	writer.Write(best.pBits[0], 1);
+	writer.Write(best.pBits[1], 1);
+	writer.Write(best.indices[0], 3);
+	for (size_t texel = 1; texel < BC_BLOCK_TEXEL_COUNT; ++texel) {
+		writer.Write(best.indices[texel], 4);
+	}
+}
+
+void EncodeBlock(const TextureCompression compression, const uint8_t* rgbaBlock, uint8_t* out_block) {
+	switch (compression) {
+		case TextureCompression::BC1:
+			EncodeBC1Block(rgbaBlock, out_block);
+			break;
+		case TextureCompression::BC4:
+			EncodeBC4Block(rgbaBlock, 0, out_block);
+			break;
+		case TextureCompression::BC5:
+			EncodeBC5Block(rgbaBlock, out_block);
+			break;
+		case TextureCompression::BC7:
+			EncodeBC7Block(rgbaBlock, out_block);
+			break;
+		case TextureCompression::None:
+		default:
+			break;
+	}
+}
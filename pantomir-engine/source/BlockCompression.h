@@ -0,0 +1,31 @@
+#ifndef BLOCKCOMPRESSION_H_
+#define BLOCKCOMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// CPU encoders for the BCn formats the material textures use. Every encoder takes one 4x4 block of RGBA8 texels,
+// row-major, and writes the encoded block. They are cook-time encoders: quality over speed, but fast enough to run
+// on the loader's worker threads the first time a texture is seen.
+
+enum class TextureCompression : uint8_t {
+	None, // RGBA8
+	BC1,  // RGB, 4 bpp. Masks, emissive, metal-roughness
+	BC4,  // Red only, 4 bpp. Single-channel masks
+	BC5,  // Red and green, 8 bpp. Tangent-space normals, blue is dropped and must be rebuilt from red and green when sampled
+	BC7   // RGBA, 8 bpp. Base color
+};
+
+constexpr size_t BC_BLOCK_TEXEL_COUNT = 16;
+
+size_t           GetBlockByteSize(TextureCompression compression);
+
+void             EncodeBC1Block(const uint8_t* rgbaBlock, uint8_t* out_block);
+void             EncodeBC4Block(const uint8_t* rgbaBlock, size_t channel, uint8_t* out_block);
+void             EncodeBC5Block(const uint8_t* rgbaBlock, uint8_t* out_block);
+void             EncodeBC7Block(const uint8_t* rgbaBlock, uint8_t* out_block);
+
+// Dispatches to the encoder above matching compression, which must not be None.
+void             EncodeBlock(TextureCompression compression, const uint8_t* rgbaBlock, uint8_t* out_block);
+
+#endif /*! BLOCKCOMPRESSION_H_ */
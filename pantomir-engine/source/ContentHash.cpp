@@ -0,0 +1,23 @@
+#include "ContentHash.h"
+
+#include <xxhash.h>
+
+ContentHash ContentHash::FromBytes(const std::span<const std::byte> bytes) {
+	return FromBytes(bytes.data(), bytes.size());
+}
+
+ContentHash ContentHash::FromBytes(const void* data, const size_t size) {
+	const XXH128_hash_t digest = XXH3_128bits(data, size);
+	return ContentHash { digest.low64, digest.high64 };
+}
+
+std::string ContentHash::ToString() const {
+	constexpr char hexDigits[] = "0123456789abcdef";
+
+	std::string    result(32, '0');
+	for (int i = 0; i < 16; ++i) {
+		result[15 - i] = hexDigits[(high >> (i * 4)) & 0xF];
+		result[31 - i] = hexDigits[(low >> (i * 4)) & 0xF];
+	}
+	return result;
+}
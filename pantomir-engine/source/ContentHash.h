@@ -0,0 +1,30 @@
+#ifndef CONTENTHASH_H_
+#define CONTENTHASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// 128-bit XXH3 digest of a blob. Used to key deduplication and on-disk caches by content rather than by path or name.
+struct ContentHash {
+	uint64_t low = 0;
+	uint64_t high = 0;
+
+	static ContentHash FromBytes(std::span<const std::byte> bytes);
+	static ContentHash FromBytes(const void* data, size_t size);
+
+	// 32 lowercase hex characters, usable as a file name
+	std::string        ToString() const;
+
+	bool               operator==(const ContentHash&) const = default;
+};
+
+struct ContentHashHasher {
+	size_t operator()(const ContentHash& hash) const noexcept {
+		// Both halves are already uniformly distributed
+		return static_cast<size_t>(hash.low);
+	}
+};
+
+#endif /*! CONTENTHASH_H_ */
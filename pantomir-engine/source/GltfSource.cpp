@@ -0,0 +1,199 @@
+#include "GltfSource.h"
+
+#include "LoggerMacros.h"
+
+#include <cstring>
+#include <limits>
+
+namespace {
+	constexpr uint32_t                 GLB_MAGIC = 0x46546C67;        // "glTF"
+	constexpr uint32_t                 GLB_CHUNK_JSON = 0x4E4F534A;   // "JSON"
+	constexpr uint32_t                 GLB_CHUNK_BINARY = 0x004E4942; // "BIN\0"
+	constexpr size_t                   GLB_HEADER_SIZE = 12;
+	constexpr size_t                   GLB_CHUNK_HEADER_SIZE = 8;
+
+	// Id the buffer callback hands out for the binary chunk, data URIs are numbered from 0
+	constexpr fastgltf::CustomBufferId GLB_BINARY_CHUNK_ID = std::numeric_limits<fastgltf::CustomBufferId>::max();
+
+	uint32_t ReadUint32(const std::byte* bytes) {
+		uint32_t value = 0;
+		std::memcpy(&value, bytes, sizeof(value));
+		return value;
+	}
+
+	// Where the BIN chunk of a GLB sits in the file, empty for .gltf files and GLBs without one
+	std::span<const std::byte> FindGlbBinaryChunk(const std::span<const std::byte> file) {
+		if (file.size() < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE || ReadUint32(file.data()) != GLB_MAGIC) {
+			return {};
+		}
+
+		const size_t jsonLength = ReadUint32(file.data() + GLB_HEADER_SIZE);
+		if (ReadUint32(file.data() + GLB_HEADER_SIZE + 4) != GLB_CHUNK_JSON) {
+			return {};
+		}
+
+		const size_t binaryHeader = GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + jsonLength;
+		if (file.size() < binaryHeader + GLB_CHUNK_HEADER_SIZE || ReadUint32(file.data() + binaryHeader + 4) != GLB_CHUNK_BINARY) {
+			return {};
+		}
+
+		const size_t binaryLength = ReadUint32(file.data() + binaryHeader);
+		if (file.size() < binaryHeader + GLB_CHUNK_HEADER_SIZE + binaryLength) {
+			return {};
+		}
+		return file.subspan(binaryHeader + GLB_CHUNK_HEADER_SIZE, binaryLength);
+	}
+
+	// Feeds fastgltf from a mapping. fastgltf copies the GLB binary chunk into whatever the buffer callback hands it,
+	// which for us is the chunk's own place in the mapping, so that copy is skipped. The mapping is read-only, anything
+	// else writing there would fault.
+	class MappedGltfDataGetter final : public fastgltf::GltfDataGetter {
+	public:
+		explicit MappedGltfDataGetter(const std::span<const std::byte> bytes)
+		    : _bytes(bytes) {}
+
+		void read(void* ptr, const std::size_t count) override {
+			const std::byte* source = _bytes.data() + _position;
+			if (ptr != source) {
+				std::memcpy(ptr, source, count);
+			}
+			_position += count;
+		}
+
+		fastgltf::span<std::byte> read(const std::size_t count, const std::size_t padding) override {
+			// simdjson reads up to padding bytes past the JSON, which the mapping may not have
+			_paddedCopy.assign(count + padding, std::byte { 0 });
+			read(_paddedCopy.data(), count);
+			return { _paddedCopy.data(), count };
+		}
+
+		void reset() override {
+			_position = 0;
+		}
+
+		std::size_t bytesRead() override {
+			return _position;
+		}
+
+		std::size_t totalSize() override {
+			return _bytes.size();
+		}
+
+	private:
+		std::span<const std::byte> _bytes;
+		size_t                     _position = 0;
+		std::vector<std::byte>     _paddedCopy;
+	};
+
+	struct BufferCallbackState {
+		GltfSource*                source;
+		std::span<const std::byte> binaryChunk;
+		bool                       bBinaryChunkClaimed;
+	};
+
+	// The GLB binary chunk is requested first, before any data URI is decoded
+	fastgltf::BufferInfo MapGltfBuffer(const uint64_t bufferSize, void* userPointer) {
+		BufferCallbackState& state = *static_cast<BufferCallbackState*>(userPointer);
+		if (!state.bBinaryChunkClaimed && !state.binaryChunk.empty() && bufferSize == state.binaryChunk.size()) {
+			state.bBinaryChunkClaimed = true;
+			return { const_cast<std::byte*>(state.binaryChunk.data()), GLB_BINARY_CHUNK_ID };
+		}
+
+		std::vector<std::byte>& decodedBuffer = state.source->decodedBuffers.emplace_back(bufferSize);
+		return { decodedBuffer.data(), state.source->decodedBuffers.size() - 1 };
+	}
+
+	// Maps a local URI relative to the glTF's directory. Returns an empty span if the file can't be mapped.
+	std::span<const std::byte> MapUri(GltfSource& source, const std::filesystem::path& directory, const fastgltf::sources::URI& uriSource) {
+		if (!uriSource.uri.isLocalPath()) {
+			return {};
+		}
+
+		const std::filesystem::path filePath = directory / std::string(uriSource.uri.path().begin(), uriSource.uri.path().end());
+		Pantomir::MappedFile        mappedFile;
+		if (!mappedFile.Open(filePath) || uriSource.fileByteOffset >= mappedFile.Size()) {
+			return {};
+		}
+
+		const std::span<const std::byte> bytes = mappedFile.Bytes().subspan(uriSource.fileByteOffset);
+		source.externalFiles.push_back(std::move(mappedFile));
+		return bytes;
+	}
+
+	fastgltf::sources::ByteView MakeByteView(const std::span<const std::byte> bytes, const fastgltf::MimeType mimeType) {
+		return fastgltf::sources::ByteView { .bytes = { bytes.data(), bytes.size() }, .mimeType = mimeType };
+	}
+} // namespace
+
+std::optional<std::shared_ptr<GltfSource>> LoadGltfSource(fastgltf::Parser& parser, const std::filesystem::path& path, const fastgltf::Options options) {
+	std::shared_ptr<GltfSource> source = std::make_shared<GltfSource>();
+	if (!source->file.Open(path)) {
+		LOG(Engine, Error, "Failed to map GLTF file '{}'", path.string());
+		return std::nullopt;
+	}
+
+	BufferCallbackState callbackState { .source = source.get(), .binaryChunk = FindGlbBinaryChunk(source->file.Bytes()), .bBinaryChunkClaimed = false };
+	parser.setUserPointer(&callbackState);
+	parser.setBufferAllocationCallback(MapGltfBuffer);
+
+	MappedGltfDataGetter                dataGetter(source->file.Bytes());
+	const std::filesystem::path         directory = path.parent_path();
+	fastgltf::Expected<fastgltf::Asset> assetResult = parser.loadGltf(dataGetter, directory, options);
+	parser.setBufferAllocationCallback(nullptr);
+	parser.setUserPointer(nullptr);
+	if (!assetResult) {
+		LOG(Engine, Error, "Failed to load GLTF: {}", getErrorMessage(assetResult.error()));
+		return std::nullopt;
+	}
+	source->asset = std::move(assetResult.get());
+
+	// Decoded data URIs are done allocating, their addresses are stable from here on
+	const auto ResolveCustomBuffer = [&](const fastgltf::sources::CustomBuffer& customBuffer) -> std::span<const std::byte> {
+		if (customBuffer.id == GLB_BINARY_CHUNK_ID) {
+			return callbackState.binaryChunk;
+		}
+		return source->decodedBuffers[customBuffer.id];
+	};
+
+	for (fastgltf::Buffer& buffer : source->asset.buffers) {
+		bool bResolved = true;
+		std::visit(fastgltf::visitor {
+		               [&](const fastgltf::sources::CustomBuffer& customBuffer) {
+			               buffer.data = MakeByteView(ResolveCustomBuffer(customBuffer), customBuffer.mimeType);
+		               },
+		               [&](const fastgltf::sources::URI& uriSource) {
+			               const std::span<const std::byte> bytes = MapUri(*source, directory, uriSource);
+			               if (bytes.size() < buffer.byteLength) {
+				               LOG(Engine, Error, "Failed to map GLTF buffer '{}'", uriSource.uri.string());
+				               bResolved = false;
+				               return;
+			               }
+			               buffer.data = MakeByteView(bytes.first(buffer.byteLength), uriSource.mimeType);
+		               },
+		               [&](const auto&) {},
+		           },
+		           buffer.data);
+		if (!bResolved) {
+			return std::nullopt;
+		}
+	}
+
+	for (fastgltf::Image& image : source->asset.images) {
+		std::visit(fastgltf::visitor {
+		               [&](const fastgltf::sources::CustomBuffer& customBuffer) {
+			               image.data = MakeByteView(ResolveCustomBuffer(customBuffer), customBuffer.mimeType);
+		               },
+		               [&](const fastgltf::sources::URI& uriSource) {
+			               if (const std::span<const std::byte> bytes = MapUri(*source, directory, uriSource); !bytes.empty()) {
+				               image.data = MakeByteView(bytes, uriSource.mimeType);
+			               } else {
+				               LOG(Engine, Warning, "Failed to map image '{}'", uriSource.uri.string());
+			               }
+		               },
+		               [&](const auto&) {},
+		           },
+		           image.data);
+	}
+
+	return source;
+}
@@ -0,0 +1,27 @@
+#ifndef GLTFSOURCE_H_
+#define GLTFSOURCE_H_
+
+#include "MappedFile.h"
+
+#include <fastgltf/core.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+
+// A parsed glTF whose buffers and external images are views into memory mapped files. The GLB binary chunk, external
+// .bin files and image files are never read into the heap, accessor and image decoding fault their pages in on first
+// touch. Only the JSON and base64 data URIs are copied.
+struct GltfSource {
+	Pantomir::MappedFile                file;           // The .gltf or .glb itself
+	std::vector<Pantomir::MappedFile>   externalFiles;  // Buffers and images referenced by URI
+	std::vector<std::vector<std::byte>> decodedBuffers; // Base64 data URIs, decoded by fastgltf
+	fastgltf::Asset                     asset;          // Views into everything above, so it goes first on destruction
+};
+
+// Every buffer of the returned asset is a sources::ByteView, images are a ByteView or a BufferView. Images that can't be
+// mapped keep their URI source. Leave Options::LoadExternalBuffers out, external buffers are mapped here instead of
+// being read. Returns nullopt when the file or one of its buffers can't be mapped or parsed.
+std::optional<std::shared_ptr<GltfSource>> LoadGltfSource(fastgltf::Parser& parser, const std::filesystem::path& path, fastgltf::Options options);
+
+#endif /*! GLTFSOURCE_H_ */
@@ -0,0 +1,333 @@
+#include "ImageContainers.h"
+
+#include "LoggerMacros.h"
+#include "PantomirFunctionLibrary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+	// ---- DDS ----
+
+	constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+	constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+	constexpr uint32_t DDPF_FOURCC = 0x4;
+	constexpr uint32_t DDPF_RGB = 0x40;
+	constexpr uint32_t DDSCAPS2_CUBEMAP = 0x200;
+	constexpr uint32_t DDSCAPS2_VOLUME = 0x200000;
+	constexpr uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+	struct DdsPixelFormat {
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t redBitMask;
+		uint32_t greenBitMask;
+		uint32_t blueBitMask;
+		uint32_t alphaBitMask;
+	};
+
+	struct DdsHeader {
+		uint32_t       size;
+		uint32_t       flags;
+		uint32_t       height;
+		uint32_t       width;
+		uint32_t       pitchOrLinearSize;
+		uint32_t       depth;
+		uint32_t       mipMapCount;
+		uint32_t       reserved1[11];
+		DdsPixelFormat pixelFormat;
+		uint32_t       caps;
+		uint32_t       caps2;
+		uint32_t       caps3;
+		uint32_t       caps4;
+		uint32_t       reserved2;
+	};
+
+	struct DdsHeaderDx10 {
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+
+	static_assert(sizeof(DdsHeader) == 124);
+	static_assert(sizeof(DdsHeaderDx10) == 20);
+
+	constexpr uint32_t MakeFourCC(const char a, const char b, const char c, const char d) {
+		return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+	}
+
+	// ---- KTX2 ----
+
+	constexpr std::array<uint8_t, 12> KTX2_IDENTIFIER = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	struct Ktx2Header {
+		std::array<uint8_t, 12> identifier;
+		uint32_t                vkFormat;
+		uint32_t                typeSize;
+		uint32_t                pixelWidth;
+		uint32_t                pixelHeight;
+		uint32_t                pixelDepth;
+		uint32_t                layerCount;
+		uint32_t                faceCount;
+		uint32_t                levelCount;
+		uint32_t                supercompressionScheme;
+		uint32_t                dfdByteOffset;
+		uint32_t                dfdByteLength;
+		uint32_t                kvdByteOffset;
+		uint32_t                kvdByteLength;
+		uint64_t                sgdByteOffset;
+		uint64_t                sgdByteLength;
+	};
+
+	struct Ktx2LevelIndex {
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+	static_assert(sizeof(Ktx2Header) == 80);
+
+	// Every other texture is sampled as UNORM, sRGB variants are viewed the same way so both paths shade identically.
+	VkFormat ToSampledFormat(const VkFormat format) {
+		switch (format) {
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_R8G8B8A8_SRGB:
+				return VK_FORMAT_R8G8B8A8_UNORM;
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+				return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+			case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+				return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+				return VK_FORMAT_BC4_UNORM_BLOCK;
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+				return VK_FORMAT_BC5_UNORM_BLOCK;
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+			case VK_FORMAT_BC7_SRGB_BLOCK:
+				return VK_FORMAT_BC7_UNORM_BLOCK;
+			default:
+				return VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	VkFormat FromDxgiFormat(const uint32_t dxgiFormat) {
+		switch (dxgiFormat) {
+			case 28: // DXGI_FORMAT_R8G8B8A8_UNORM
+			case 29: // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+				return VK_FORMAT_R8G8B8A8_UNORM;
+			case 71: // DXGI_FORMAT_BC1_UNORM
+			case 72: // DXGI_FORMAT_BC1_UNORM_SRGB
+				return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+			case 80: // DXGI_FORMAT_BC4_UNORM
+				return VK_FORMAT_BC4_UNORM_BLOCK;
+			case 83: // DXGI_FORMAT_BC5_UNORM
+				return VK_FORMAT_BC5_UNORM_BLOCK;
+			case 98: // DXGI_FORMAT_BC7_UNORM
+			case 99: // DXGI_FORMAT_BC7_UNORM_SRGB
+				return VK_FORMAT_BC7_UNORM_BLOCK;
+			default:
+				return VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	VkFormat FromDdsPixelFormat(const DdsPixelFormat& pixelFormat) {
+		if (pixelFormat.flags & DDPF_FOURCC) {
+			switch (pixelFormat.fourCC) {
+				case MakeFourCC('D', 'X', 'T', '1'):
+					return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+				case MakeFourCC('A', 'T', 'I', '1'):
+				case MakeFourCC('B', 'C', '4', 'U'):
+					return VK_FORMAT_BC4_UNORM_BLOCK;
+				case MakeFourCC('A', 'T', 'I', '2'):
+				case MakeFourCC('B', 'C', '5', 'U'):
+					return VK_FORMAT_BC5_UNORM_BLOCK;
+				default:
+					return VK_FORMAT_UNDEFINED;
+			}
+		}
+
+		// Legacy uncompressed layout, only the byte order that matches RGBA8 can be copied as-is
+		if ((pixelFormat.flags & DDPF_RGB) && pixelFormat.rgbBitCount == 32 && pixelFormat.redBitMask == 0x000000FF && pixelFormat.greenBitMask == 0x0000FF00 && pixelFormat.blueBitMask == 0x00FF0000) {
+			return VK_FORMAT_R8G8B8A8_UNORM;
+		}
+
+		return VK_FORMAT_UNDEFINED;
+	}
+
+	struct ContainerLevel {
+		uint64_t offset; // Relative to the start of the file
+		uint64_t size;
+	};
+
+	// Builds the copy regions for levels stored anywhere in the file. The pixel span covers all of them and the region
+	// offsets are rebased onto its start.
+	std::optional<MipmappedTexture> ViewLevels(const std::span<const std::byte> bytes, const VkFormat format, const VkExtent3D extent, const std::span<const ContainerLevel> levels) {
+		uint64_t dataBegin = std::numeric_limits<uint64_t>::max();
+		uint64_t dataEnd = 0;
+		for (uint32_t level = 0; level < levels.size(); ++level) {
+			const VkExtent3D levelExtent { std::max(1u, extent.width >> level), std::max(1u, extent.height >> level), 1 };
+			// Offsets and sizes come straight from the file, compared one at a time so a crafted value can't wrap the sum
+			const ContainerLevel& containerLevel = levels[level];
+			if (containerLevel.size != PantomirFunctionLibrary::ImageSizeFromFormat(format, levelExtent) || containerLevel.offset > bytes.size() || containerLevel.size > bytes.size() - containerLevel.offset) {
+				return std::nullopt;
+			}
+
+			dataBegin = std::min(dataBegin, containerLevel.offset);
+			dataEnd = std::max(dataEnd, containerLevel.offset + containerLevel.size);
+		}
+
+		MipmappedTexture texture {};
+		texture.extent = extent;
+		texture.format = format;
+		for (uint32_t level = 0; level < levels.size(); ++level) {
+			VkBufferImageCopy region {};
+			region.bufferOffset = levels[level].offset - dataBegin;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = VkExtent3D { std::max(1u, extent.width >> level), std::max(1u, extent.height >> level), 1 };
+			texture.mipRegions.push_back(region);
+		}
+
+		texture.pixels = bytes.subspan(dataBegin, dataEnd - dataBegin);
+		return texture;
+	}
+
+	uint32_t GetFullMipCount(const VkExtent3D extent) {
+		return static_cast<uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
+	}
+
+	// Also keeps the level size math far away from wrapping, device limits are a few ten thousand texels at most
+	bool IsExtentSupported(const VkExtent3D extent, const uint32_t maxImageDimension) {
+		if (extent.width > maxImageDimension || extent.height > maxImageDimension) {
+			LOG(Engine, Warning, "Image container extent {}x{} exceeds the device limit of {}", extent.width, extent.height, maxImageDimension);
+			return false;
+		}
+		return true;
+	}
+
+	std::optional<MipmappedTexture> ParseDds(const std::span<const std::byte> bytes, const uint32_t maxImageDimension) {
+		if (bytes.size() < sizeof(uint32_t) + sizeof(DdsHeader)) {
+			return std::nullopt;
+		}
+
+		DdsHeader header;
+		memcpy(&header, bytes.data() + sizeof(uint32_t), sizeof(header));
+		if (header.size != sizeof(DdsHeader) || header.pixelFormat.size != sizeof(DdsPixelFormat) || (header.caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME))) {
+			LOG(Engine, Warning, "Unsupported DDS layout, only single 2D images are loaded");
+			return std::nullopt;
+		}
+
+		uint64_t dataOffset = sizeof(uint32_t) + sizeof(DdsHeader);
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		if ((header.pixelFormat.flags & DDPF_FOURCC) && header.pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0')) {
+			if (bytes.size() < dataOffset + sizeof(DdsHeaderDx10)) {
+				return std::nullopt;
+			}
+
+			DdsHeaderDx10 headerDx10;
+			memcpy(&headerDx10, bytes.data() + dataOffset, sizeof(headerDx10));
+			dataOffset += sizeof(DdsHeaderDx10);
+			if (headerDx10.resourceDimension != DDS_DIMENSION_TEXTURE2D || headerDx10.arraySize > 1) {
+				LOG(Engine, Warning, "Unsupported DDS layout, only single 2D images are loaded");
+				return std::nullopt;
+			}
+			format = FromDxgiFormat(headerDx10.dxgiFormat);
+		} else {
+			format = FromDdsPixelFormat(header.pixelFormat);
+		}
+
+		if (format == VK_FORMAT_UNDEFINED || header.width == 0 || header.height == 0) {
+			LOG(Engine, Warning, "Unsupported DDS pixel format");
+			return std::nullopt;
+		}
+
+		const VkExtent3D extent { header.width, header.height, 1 };
+		if (!IsExtentSupported(extent, maxImageDimension)) {
+			return std::nullopt;
+		}
+
+		const uint32_t levelCount = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? std::min(header.mipMapCount, GetFullMipCount(extent)) : 1;
+
+		// DDS packs the levels back to back, largest first
+		std::vector<ContainerLevel> levels;
+		for (uint32_t level = 0; level < levelCount; ++level) {
+			const VkExtent3D levelExtent { std::max(1u, extent.width >> level), std::max(1u, extent.height >> level), 1 };
+			const uint64_t   levelSize = PantomirFunctionLibrary::ImageSizeFromFormat(format, levelExtent);
+			levels.push_back(ContainerLevel { dataOffset, levelSize });
+			dataOffset += levelSize;
+		}
+
+		return ViewLevels(bytes, format, extent, levels);
+	}
+
+	std::optional<MipmappedTexture> ParseKtx2(const std::span<const std::byte> bytes, const uint32_t maxImageDimension) {
+		if (bytes.size() < sizeof(Ktx2Header)) {
+			return std::nullopt;
+		}
+
+		Ktx2Header header;
+		memcpy(&header, bytes.data(), sizeof(header));
+		if (header.supercompressionScheme != 0) {
+			LOG(Engine, Warning, "Supercompressed KTX2 (scheme {}) is not supported", header.supercompressionScheme);
+			return std::nullopt;
+		}
+		if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.pixelWidth == 0 || header.pixelHeight == 0) {
+			LOG(Engine, Warning, "Unsupported KTX2 layout, only single 2D images are loaded");
+			return std::nullopt;
+		}
+
+		const VkFormat format = ToSampledFormat(static_cast<VkFormat>(header.vkFormat));
+		if (format == VK_FORMAT_UNDEFINED) {
+			LOG(Engine, Warning, "Unsupported KTX2 format {}", header.vkFormat);
+			return std::nullopt;
+		}
+
+		// A level count of 0 asks the loader to generate mips, only the base level is stored
+		const VkExtent3D extent { header.pixelWidth, header.pixelHeight, 1 };
+		if (!IsExtentSupported(extent, maxImageDimension)) {
+			return std::nullopt;
+		}
+
+		const uint32_t levelCount = std::max(1u, header.levelCount);
+		if (levelCount > GetFullMipCount(extent) || bytes.size() < sizeof(Ktx2Header) + levelCount * sizeof(Ktx2LevelIndex)) {
+			return std::nullopt;
+		}
+
+		std::vector<ContainerLevel> levels(levelCount);
+		for (uint32_t level = 0; level < levelCount; ++level) {
+			Ktx2LevelIndex levelIndex;
+			memcpy(&levelIndex, bytes.data() + sizeof(Ktx2Header) + level * sizeof(Ktx2LevelIndex), sizeof(levelIndex));
+			levels[level] = ContainerLevel { levelIndex.byteOffset, levelIndex.byteLength };
+		}
+
+		return ViewLevels(bytes, format, extent, levels);
+	}
+} // namespace
+
+bool IsImageContainer(const std::span<const std::byte> bytes) {
+	if (bytes.size() >= KTX2_IDENTIFIER.size() && memcmp(bytes.data(), KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) == 0) {
+		return true;
+	}
+
+	uint32_t magic = 0;
+	if (bytes.size() >= sizeof(magic)) {
+		memcpy(&magic, bytes.data(), sizeof(magic));
+	}
+	return magic == DDS_MAGIC;
+}
+
+std::optional<MipmappedTexture> ParseImageContainer(const std::span<const std::byte> bytes, const uint32_t maxImageDimension) {
+	if (bytes.size() >= KTX2_IDENTIFIER.size() && memcmp(bytes.data(), KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) == 0) {
+		return ParseKtx2(bytes, maxImageDimension);
+	}
+
+	return ParseDds(bytes, maxImageDimension);
+}
@@ -0,0 +1,15 @@
+#ifndef IMAGECONTAINERS_H_
+#define IMAGECONTAINERS_H_
+
+#include "TextureCache.h"
+
+// DDS and KTX2 files already hold GPU-ready mip chains. Recognizing them lets the loader skip decoding and the texture
+// cache, and copy the levels straight from the file bytes into staging.
+
+bool                            IsImageContainer(std::span<const std::byte> bytes);
+
+// The result views bytes in place, bytes must outlive it. Fails for anything other than a single 2D image in a format
+// the renderer samples (RGBA8, BC1, BC4, BC5, BC7), for supercompressed KTX2, and for extents above maxImageDimension.
+std::optional<MipmappedTexture> ParseImageContainer(std::span<const std::byte> bytes, uint32_t maxImageDimension);
+
+#endif /*! IMAGECONTAINERS_H_ */
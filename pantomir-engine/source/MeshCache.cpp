@@ -0,0 +1,614 @@
+#include "MeshCache.h"
+
+#include "LoggerMacros.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+#include "VertexPacking.h"
+
+#include <glm/gtx/quaternion.hpp>
+
+#include <fastgltf/core.hpp>
+#include <fastgltf/glm_element_traits.hpp>
+#include <fastgltf/tools.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace {
+	constexpr uint32_t MESH_CACHE_MAGIC = 0x48534D50; // "PMSH"
+	constexpr uint32_t MESH_CACHE_VERSION = 6;        // Bump whenever a cooked struct or Vertex changes layout
+	constexpr uint64_t MESH_CACHE_SECTION_ALIGNMENT = 16;
+
+	constexpr float    MESH_LOD_MAX_ERROR = 0.02f;     // Relative to the surface's extent, coarser levels are not generated
+	constexpr size_t   MESH_LOD_MIN_TRIANGLES = 64;    // Below this a level saves less than its draw costs
+	constexpr float    MESH_LOD_MIN_REDUCTION = 0.85f; // A level keeping more of the previous one's indices means the simplifier is stuck
+	constexpr size_t   MAX_INDEX16_VERTICES = 65536;   // Every mesh-relative index still fits uint16_t
+
+	enum MeshCacheSectionType : uint32_t {
+		Meshes,
+		Surfaces,
+		Nodes,
+		ChildIndices,
+		Materials,
+		Strings,
+		Vertices,
+		Indices16,
+		Indices32,
+		Meshlets,
+		LODs,
+		SectionCount
+	};
+
+	struct MeshCacheSection {
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	struct MeshCacheHeader {
+		uint32_t                                   magic;
+		uint32_t                                   version;
+		ContentHash                                sourceHash;
+		uint32_t                                   vertexStride;
+		uint32_t                                   bOptimized; // Cooked through OptimizeMesh, a cache cooked with the other setting is stale
+		uint32_t                                   sectionCount;
+		std::array<MeshCacheSection, SectionCount> sections;
+	};
+
+	constexpr uint64_t AlignUp(const uint64_t value, const uint64_t alignment) {
+		return ((value + alignment - 1) / alignment) * alignment;
+	}
+
+	// Returns false when the section doesn't fit the file or doesn't hold a whole number of elements.
+	template <typename T>
+	bool ViewSection(const Pantomir::MappedFile& file, const MeshCacheSection& section, std::span<const T>& out_elements) {
+		if (section.offset % MESH_CACHE_SECTION_ALIGNMENT != 0 || section.size % sizeof(T) != 0 ||
+		    section.offset > file.Size() || section.size > file.Size() - section.offset) {
+			return false;
+		}
+
+		out_elements = std::span<const T>(reinterpret_cast<const T*>(file.Data() + section.offset), section.size / sizeof(T));
+		return true;
+	}
+
+	bool IsNameValid(const CookedSceneView& scene, const CookedName& name) {
+		return static_cast<uint64_t>(name.offset) + name.length <= scene.strings.size();
+	}
+
+	// Compared as first and count so values read from the file can't wrap the end of the range
+	bool IsRangeValid(const uint64_t first, const uint64_t count, const uint64_t size) {
+		return first <= size && count <= size - first;
+	}
+
+	bool IsMaterialPassValid(const MaterialPass passType) {
+		switch (passType) {
+			case MaterialPass::Opaque:
+			case MaterialPass::AlphaMask:
+			case MaterialPass::AlphaBlend:
+			case MaterialPass::Other:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	template <typename IndexType>
+	bool AreIndicesInRange(const std::span<const IndexType> indices, const uint64_t vertexCount) {
+		return std::ranges::all_of(indices, [vertexCount](const IndexType index) { return index < vertexCount; });
+	}
+
+	// Pass over the tables and index blobs so a truncated or hand-edited cache can't index out of bounds later, neither
+	// here nor in the draws. Vertex data is never indexed by the CPU, any bit pattern in it is a valid vertex.
+	bool IsSceneConsistent(const CookedSceneView& scene, const size_t textureCount) {
+		for (const CookedMesh& mesh : scene.meshes) {
+			if (mesh.indexType != VK_INDEX_TYPE_UINT16 && mesh.indexType != VK_INDEX_TYPE_UINT32) {
+				return false;
+			}
+			const size_t indexCount = mesh.indexType == VK_INDEX_TYPE_UINT16 ? scene.indices16.size() : scene.indices32.size();
+			if (!IsRangeValid(mesh.firstVertex, mesh.vertexCount, scene.vertices.size()) || !IsRangeValid(mesh.firstIndex, mesh.indexCount, indexCount) ||
+			    static_cast<uint64_t>(mesh.firstSurface) + mesh.surfaceCount > scene.surfaces.size() || !IsNameValid(scene, mesh.name)) {
+				return false;
+			}
+		}
+		for (const CookedSurface& surface : scene.surfaces) {
+			if (surface.materialIndex >= scene.materials.size() || static_cast<uint64_t>(surface.firstMeshlet) + surface.meshletCount > scene.meshlets.size() ||
+			    static_cast<uint64_t>(surface.firstLOD) + surface.lodCount > scene.lods.size()) {
+				return false;
+			}
+		}
+		for (const CookedMesh& mesh : scene.meshes) {
+			const bool bIndicesInRange = mesh.indexType == VK_INDEX_TYPE_UINT16 ? AreIndicesInRange(scene.indices16.subspan(mesh.firstIndex, mesh.indexCount), mesh.vertexCount)
+			                                                                    : AreIndicesInRange(scene.indices32.subspan(mesh.firstIndex, mesh.indexCount), mesh.vertexCount);
+			if (!bIndicesInRange) {
+				return false;
+			}
+
+			for (const CookedSurface& surface : scene.surfaces.subspan(mesh.firstSurface, mesh.surfaceCount)) {
+				if (static_cast<uint64_t>(surface.startIndex) + surface.count > mesh.indexCount) {
+					return false;
+				}
+				for (const Meshlet& meshlet : scene.meshlets.subspan(surface.firstMeshlet, surface.meshletCount)) {
+					if (static_cast<uint64_t>(meshlet.firstIndex) + meshlet.indexCount > mesh.indexCount) {
+						return false;
+					}
+				}
+				for (const SurfaceLOD& lod : scene.lods.subspan(surface.firstLOD, surface.lodCount)) {
+					if (static_cast<uint64_t>(lod.startIndex) + lod.count > mesh.indexCount) {
+						return false;
+					}
+				}
+			}
+		}
+		for (const CookedNode& node : scene.nodes) {
+			if ((node.meshIndex >= 0 && static_cast<size_t>(node.meshIndex) >= scene.meshes.size()) ||
+			    static_cast<uint64_t>(node.firstChild) + node.childCount > scene.childIndices.size() || !IsNameValid(scene, node.name)) {
+				return false;
+			}
+		}
+		for (const uint32_t childIndex : scene.childIndices) {
+			if (childIndex >= scene.nodes.size()) {
+				return false;
+			}
+		}
+		for (const CookedMaterial& material : scene.materials) {
+			if (!IsNameValid(scene, material.name) || !IsMaterialPassValid(material.passType)) {
+				return false;
+			}
+			for (const int32_t textureIndex : material.textureIndices) {
+				if (textureIndex >= 0 && static_cast<size_t>(textureIndex) >= textureCount) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	CookedMaterial CookMaterial(const fastgltf::Material& material) {
+		CookedMaterial                             cookedMaterial {};
+		GLTFMetallic_Roughness::MaterialConstants& constants = cookedMaterial.constants;
+		constants.colorFactors.x = material.pbrData.baseColorFactor[0];
+		constants.colorFactors.y = material.pbrData.baseColorFactor[1];
+		constants.colorFactors.z = material.pbrData.baseColorFactor[2];
+		constants.colorFactors.w = material.pbrData.baseColorFactor[3];
+
+		constants.metalRoughFactors.x = material.pbrData.metallicFactor;
+		constants.metalRoughFactors.y = material.pbrData.roughnessFactor;
+
+		constants.emissiveFactors.x = material.emissiveFactor[0];
+		constants.emissiveFactors.y = material.emissiveFactor[1];
+		constants.emissiveFactors.z = material.emissiveFactor[2];
+
+		// Extensions
+		constants.emissiveStrength = material.emissiveStrength;
+		if (material.specular) {
+			constants.specularFactor = material.specular->specularFactor;
+		} else {
+			constants.specularFactor = 1.0f;
+		}
+
+		if (material.alphaMode == fastgltf::AlphaMode::Blend) {
+			constants.alphaMode = 2;
+		} else if (material.alphaMode == fastgltf::AlphaMode::Mask) {
+			constants.alphaMode = 1;
+			constants.alphaCutoff = material.alphaCutoff;
+		} else {
+			constants.alphaMode = 0;
+		}
+
+		cookedMaterial.passType = MaterialPass::Opaque;
+		if (material.alphaMode == fastgltf::AlphaMode::Blend) {
+			cookedMaterial.passType = MaterialPass::AlphaBlend;
+		}
+		if (material.alphaMode == fastgltf::AlphaMode::Mask) {
+			cookedMaterial.passType = MaterialPass::AlphaMask;
+		}
+		cookedMaterial.bDoubleSided = material.doubleSided;
+
+		cookedMaterial.textureIndices.fill(-1);
+		const auto SetTexture = [&](const MaterialTextureSlot slot, const size_t textureIndex) {
+			cookedMaterial.textureIndices[static_cast<size_t>(slot)] = static_cast<int32_t>(textureIndex);
+		};
+
+		if (material.pbrData.baseColorTexture.has_value()) {
+			SetTexture(MaterialTextureSlot::Color, material.pbrData.baseColorTexture->textureIndex);
+		}
+		if (material.pbrData.metallicRoughnessTexture.has_value()) {
+			SetTexture(MaterialTextureSlot::MetalRough, material.pbrData.metallicRoughnessTexture->textureIndex);
+		}
+		if (material.emissiveTexture.has_value()) {
+			SetTexture(MaterialTextureSlot::Emissive, material.emissiveTexture->textureIndex);
+		}
+		if (material.normalTexture.has_value()) {
+			SetTexture(MaterialTextureSlot::Normal, material.normalTexture->textureIndex);
+		}
+		if (material.specular && material.specular->specularTexture.has_value()) {
+			SetTexture(MaterialTextureSlot::Specular, material.specular->specularTexture->textureIndex);
+		}
+
+		return cookedMaterial;
+	}
+
+	// Decodes every primitive of a glTF mesh into its own surface, CookMesh takes it from there
+	std::vector<SourceSurface> DecodeGltfMesh(const fastgltf::Asset& asset, const fastgltf::Mesh& mesh) {
+		std::vector<SourceSurface> surfaces(mesh.primitives.size());
+		for (size_t primitiveIndex = 0; primitiveIndex < mesh.primitives.size(); ++primitiveIndex) {
+			const fastgltf::Primitive& primitive = mesh.primitives[primitiveIndex];
+			SourceSurface&             surface = surfaces[primitiveIndex];
+			std::vector<Vertex>&       primitiveVertices = surface.vertices;
+			std::vector<uint32_t>&     primitiveIndices = surface.indices;
+			surface.materialIndex = static_cast<uint32_t>(primitive.materialIndex.value_or(0));
+			surface.bTriangles = primitive.type == fastgltf::PrimitiveType::Triangles;
+
+			// Load indexes
+			{
+				const fastgltf::Accessor& indexAccessor = asset.accessors[primitive.indicesAccessor.value()];
+				primitiveIndices.reserve(indexAccessor.count);
+				fastgltf::iterateAccessor<std::uint32_t>(asset, indexAccessor, [&](std::uint32_t index) {
+					primitiveIndices.push_back(index);
+				});
+			}
+
+			// Load vertex positions
+			{
+				const fastgltf::Accessor& posAccessor = asset.accessors[primitive.findAttribute("POSITION")->accessorIndex];
+				primitiveVertices.resize(posAccessor.count);
+
+				fastgltf::iterateAccessorWithIndex<glm::vec3>(asset, posAccessor, [&](glm::vec3 vertex, size_t index) {
+					Vertex newVertex {};
+					newVertex.position = vertex;
+					newVertex.normal = { 1, 0, 0 };
+					newVertex.color = glm::vec4 { 1.f };
+					newVertex.uv_x = 0;
+					newVertex.uv_y = 0;
+					primitiveVertices[index] = newVertex;
+				});
+			}
+
+			// Load vertex normals
+			if (const fastgltf::Attribute* normals = primitive.findAttribute("NORMAL"); normals != primitive.attributes.end()) {
+				fastgltf::iterateAccessorWithIndex<glm::vec3>(asset, asset.accessors[normals->accessorIndex], [&](glm::vec3 vertex, size_t index) {
+					primitiveVertices[index].normal = vertex;
+				});
+			}
+
+			// Load vertex tangents
+			if (const fastgltf::Attribute* tangents = primitive.findAttribute("TANGENT"); tangents != primitive.attributes.end()) {
+				fastgltf::iterateAccessorWithIndex<glm::vec4>(asset, asset.accessors[tangents->accessorIndex], [&](glm::vec4 tangent, size_t index) {
+					primitiveVertices[index].tangent = tangent;
+				});
+			}
+
+			// Load UVs
+			if (const fastgltf::Attribute* uv = primitive.findAttribute("TEXCOORD_0"); uv != primitive.attributes.end()) {
+				fastgltf::iterateAccessorWithIndex<glm::vec2>(asset, asset.accessors[uv->accessorIndex], [&](glm::vec2 vertex, size_t index) {
+					primitiveVertices[index].uv_x = vertex.x;
+					primitiveVertices[index].uv_y = vertex.y;
+				});
+			}
+
+			// Load vertex colors
+			if (const fastgltf::Attribute* colors = primitive.findAttribute("COLOR_0"); colors != primitive.attributes.end()) {
+				fastgltf::iterateAccessorWithIndex<glm::vec4>(asset, asset.accessors[colors->accessorIndex], [&](glm::vec4 vertex, size_t index) {
+					primitiveVertices[index].color = vertex;
+				});
+			}
+		}
+		return surfaces;
+	}
+
+	glm::mat4 GetLocalTransform(const fastgltf::Node& node) {
+		glm::mat4 localTransform { 1.F };
+		std::visit(fastgltf::visitor {
+		               [&](const fastgltf::math::fmat4x4& matrix) {
+			               memcpy(&localTransform, matrix.data(), sizeof(matrix));
+		               },
+		               // Handle TRS (Translation-Rotation-Scale) transform
+		               [&](const fastgltf::TRS& transform) {
+			               const glm::vec3 translation(transform.translation[0], transform.translation[1], transform.translation[2]);
+			               const glm::quat rotation(transform.rotation[3], transform.rotation[0], transform.rotation[1], transform.rotation[2]); // Note: glTF uses (x, y, z, w)
+			               const glm::vec3 scale(transform.scale[0], transform.scale[1], transform.scale[2]);
+
+			               const glm::mat4 Translation = glm::translate(glm::mat4(1.0F), translation);
+			               const glm::mat4 Rotation = glm::toMat4(rotation);
+			               const glm::mat4 Scale = glm::scale(glm::mat4(1.0F), scale);
+
+			               localTransform = Translation * Rotation * Scale;
+		               },
+		           },
+		           node.transform);
+		return localTransform;
+	}
+} // namespace
+
+CookedName CookedScene::AddName(const std::string_view name) {
+	const CookedName cookedName { static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(name.size()) };
+	strings.insert(strings.end(), name.begin(), name.end());
+	return cookedName;
+}
+
+CookedSceneView CookedScene::View() const {
+	return CookedSceneView { meshes, surfaces, nodes, childIndices, materials, strings, vertices, indices16, indices32, meshlets, lods };
+}
+
+void CookMesh(const std::string_view name, const std::span<SourceSurface> surfaces, const bool bOptimizeMeshes, CookedScene& scene) {
+	CookedMesh cookedMesh {};
+	cookedMesh.firstVertex = scene.vertices.size();
+	cookedMesh.firstSurface = static_cast<uint32_t>(scene.surfaces.size());
+	cookedMesh.name = scene.AddName(name);
+
+	// Full precision while cooking, packed into the scene blobs once the whole mesh is known
+	std::vector<Vertex>   vertices;
+	std::vector<uint32_t> indices;
+	MeshOptimizationStats optimizationStats {};
+
+	// Each surface is optimized on its own, so the optimizer can reorder it without crossing surface boundaries
+	for (SourceSurface& sourceSurface : surfaces) {
+		std::vector<Vertex>&   surfaceVertices = sourceSurface.vertices;
+		std::vector<uint32_t>& surfaceIndices = sourceSurface.indices;
+		if (surfaceVertices.empty()) {
+			continue;
+		}
+
+		CookedSurface newSurface {};
+		newSurface.startIndex = static_cast<uint32_t>(indices.size());
+
+		if (bOptimizeMeshes && sourceSurface.bTriangles) {
+			optimizationStats.Accumulate(OptimizeMesh(surfaceVertices, surfaceIndices));
+		}
+
+		newSurface.count = static_cast<uint32_t>(surfaceIndices.size());
+		newSurface.materialIndex = sourceSurface.materialIndex;
+
+		// Loop the vertices of this surface, find min/max bounds
+		glm::vec3 minPosition = surfaceVertices[0].position;
+		glm::vec3 maxPosition = surfaceVertices[0].position;
+		for (const Vertex& vertex : surfaceVertices) {
+			minPosition = glm::min(minPosition, vertex.position);
+			maxPosition = glm::max(maxPosition, vertex.position);
+		}
+
+		// Calculate origin and extents from the min/max, use extent length for radius
+		newSurface.bounds.originPoint = (maxPosition + minPosition) / 2.f;
+		newSurface.bounds.extents = (maxPosition - minPosition) / 2.f;
+		newSurface.bounds.sphereRadius = glm::length(newSurface.bounds.extents);
+
+		// Meshlets index relative to the mesh, like the surface itself
+		newSurface.firstMeshlet = static_cast<uint32_t>(scene.meshlets.size());
+		if (sourceSurface.bTriangles) {
+			newSurface.meshletCount = BuildMeshlets(surfaceIndices, surfaceVertices, newSurface.startIndex, scene.meshlets);
+		}
+
+		// Indices stay relative to the mesh
+		const uint32_t initialVertex = static_cast<uint32_t>(vertices.size());
+		for (const uint32_t index : surfaceIndices) {
+			indices.push_back(index + initialVertex);
+		}
+
+		// Each level simplifies the one before it to half its triangles and lands after the surface's own indices
+		newSurface.firstLOD = static_cast<uint32_t>(scene.lods.size());
+		if (sourceSurface.bTriangles) {
+			std::vector<uint32_t> previousIndices = surfaceIndices;
+			std::vector<uint32_t> lodIndices;
+			float                 lodError = 0.0f;
+			for (uint32_t level = 1; level <= MAX_SURFACE_LODS; ++level) {
+				const size_t targetIndexCount = previousIndices.size() / 6 * 3;
+				if (targetIndexCount < MESH_LOD_MIN_TRIANGLES * 3 || lodError >= MESH_LOD_MAX_ERROR) {
+					break;
+				}
+
+				lodError += SimplifyMesh(previousIndices, surfaceVertices, targetIndexCount, MESH_LOD_MAX_ERROR - lodError, lodIndices);
+				if (lodIndices.size() > static_cast<size_t>(static_cast<float>(previousIndices.size()) * MESH_LOD_MIN_REDUCTION)) {
+					break;
+				}
+				OptimizeVertexCache(lodIndices, surfaceVertices.size());
+
+				scene.lods.push_back(SurfaceLOD {
+				    .startIndex = static_cast<uint32_t>(indices.size()),
+				    .count = static_cast<uint32_t>(lodIndices.size()),
+				    .error = lodError });
+				for (const uint32_t index : lodIndices) {
+					indices.push_back(index + initialVertex);
+				}
+				++newSurface.lodCount;
+				previousIndices.swap(lodIndices);
+			}
+		}
+
+		scene.surfaces.push_back(newSurface);
+		vertices.insert(vertices.end(), surfaceVertices.begin(), surfaceVertices.end());
+	}
+
+	if (optimizationStats.triangleCount > 0) {
+		LOG(Engine, Info, "Optimized mesh '{}': {} -> {} vertices, ACMR {:.3f} -> {:.3f} over {} triangles",
+		    name, optimizationStats.sourceVertexCount, optimizationStats.optimizedVertexCount,
+		    optimizationStats.GetACMRBefore(), optimizationStats.GetACMRAfter(), optimizationStats.triangleCount);
+	}
+
+	cookedMesh.quantization = ComputePositionQuantization(vertices);
+	PackVertices(vertices, cookedMesh.quantization, scene.vertices);
+
+	// Mesh-relative indices of a mesh with at most 65,536 vertices fit 16 bits, which halves its index memory and fetch
+	cookedMesh.vertexCount = vertices.size();
+	cookedMesh.indexCount = indices.size();
+	if (vertices.size() <= MAX_INDEX16_VERTICES) {
+		cookedMesh.indexType = VK_INDEX_TYPE_UINT16;
+		cookedMesh.firstIndex = scene.indices16.size();
+		scene.indices16.insert(scene.indices16.end(), indices.begin(), indices.end());
+	} else {
+		cookedMesh.indexType = VK_INDEX_TYPE_UINT32;
+		cookedMesh.firstIndex = scene.indices32.size();
+		scene.indices32.insert(scene.indices32.end(), indices.begin(), indices.end());
+	}
+	cookedMesh.surfaceCount = static_cast<uint32_t>(scene.surfaces.size()) - cookedMesh.firstSurface;
+	scene.meshes.push_back(cookedMesh);
+}
+
+CookedScene CookScene(const fastgltf::Asset& asset, const bool bOptimizeMeshes) {
+	CookedScene scene {};
+
+	scene.materials.reserve(asset.materials.size());
+	for (const fastgltf::Material& material : asset.materials) {
+		CookedMaterial cookedMaterial = CookMaterial(material);
+		cookedMaterial.name = scene.AddName(material.name);
+		scene.materials.push_back(cookedMaterial);
+	}
+
+	scene.meshes.reserve(asset.meshes.size());
+	for (const fastgltf::Mesh& mesh : asset.meshes) {
+		std::vector<SourceSurface> surfaces = DecodeGltfMesh(asset, mesh);
+		CookMesh(mesh.name, surfaces, bOptimizeMeshes, scene);
+	}
+
+	scene.nodes.reserve(asset.nodes.size());
+	for (const fastgltf::Node& node : asset.nodes) {
+		CookedNode cookedNode {};
+		cookedNode.localTransform = GetLocalTransform(node);
+		cookedNode.meshIndex = node.meshIndex.has_value() ? static_cast<int32_t>(*node.meshIndex) : -1;
+		cookedNode.firstChild = static_cast<uint32_t>(scene.childIndices.size());
+		cookedNode.childCount = static_cast<uint32_t>(node.children.size());
+		cookedNode.name = scene.AddName(node.name);
+		for (const size_t child : node.children) {
+			scene.childIndices.push_back(static_cast<uint32_t>(child));
+		}
+		scene.nodes.push_back(cookedNode);
+	}
+
+	return scene;
+}
+
+ContentHash HashGltfSource(const Pantomir::MappedFile& sourceFile, const std::filesystem::path& sourcePath, const fastgltf::Asset& asset) {
+	const ContentHash fileHash = ContentHash::FromBytes(sourceFile.Bytes());
+	if (sourcePath.extension() == ".glb") {
+		return fileHash;
+	}
+
+	// Separate .bin files can change without touching the .gltf, so their content is part of the key
+	std::vector<ContentHash> hashes { fileHash };
+	for (const fastgltf::Buffer& buffer : asset.buffers) {
+		std::visit(fastgltf::visitor {
+		               [&](const fastgltf::sources::Array& arraySource) {
+			               hashes.push_back(ContentHash::FromBytes(arraySource.bytes.data(), arraySource.bytes.size()));
+		               },
+		               [&](const fastgltf::sources::Vector& vectorSource) {
+			               hashes.push_back(ContentHash::FromBytes(vectorSource.bytes.data(), vectorSource.bytes.size()));
+		               },
+		               [&](const fastgltf::sources::ByteView& byteViewSource) {
+			               hashes.push_back(ContentHash::FromBytes(byteViewSource.bytes.data(), byteViewSource.bytes.size()));
+		               },
+		               [&](const auto&) {
+			               hashes.push_back(ContentHash {});
+		               },
+		           },
+		           buffer.data);
+	}
+	return ContentHash::FromBytes(hashes.data(), hashes.size() * sizeof(ContentHash));
+}
+
+std::filesystem::path GetMeshCachePath(const std::filesystem::path& sourcePath) {
+	std::filesystem::path cachePath = sourcePath;
+	cachePath += ".pmesh"; // Appended, so foo.obj and foo.glb next to each other don't share a cache
+	return cachePath;
+}
+
+bool WriteMeshCache(const std::filesystem::path& cachePath, const ContentHash& sourceHash, const bool bOptimized, const CookedSceneView& scene) {
+	const std::array<std::span<const std::byte>, SectionCount> sectionBytes {
+		std::as_bytes(scene.meshes),
+		std::as_bytes(scene.surfaces),
+		std::as_bytes(scene.nodes),
+		std::as_bytes(scene.childIndices),
+		std::as_bytes(scene.materials),
+		std::as_bytes(scene.strings),
+		std::as_bytes(scene.vertices),
+		std::as_bytes(scene.indices16),
+		std::as_bytes(scene.indices32),
+		std::as_bytes(scene.meshlets),
+		std::as_bytes(scene.lods),
+	};
+
+	MeshCacheHeader header {};
+	header.magic = MESH_CACHE_MAGIC;
+	header.version = MESH_CACHE_VERSION;
+	header.sourceHash = sourceHash;
+	header.vertexStride = sizeof(PackedVertex);
+	header.bOptimized = bOptimized ? 1 : 0;
+	header.sectionCount = SectionCount;
+
+	uint64_t offset = AlignUp(sizeof(MeshCacheHeader), MESH_CACHE_SECTION_ALIGNMENT);
+	for (uint32_t i = 0; i < SectionCount; ++i) {
+		header.sections[i] = MeshCacheSection { offset, sectionBytes[i].size() };
+		offset = AlignUp(offset + sectionBytes[i].size(), MESH_CACHE_SECTION_ALIGNMENT);
+	}
+
+	// Write next to the final path and rename, so a crash mid-write never leaves a cache that looks valid
+	std::filesystem::path temporaryPath = cachePath;
+	temporaryPath += ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			LOG(Engine, Warning, "Failed to create mesh cache '{}'", temporaryPath.string());
+			return false;
+		}
+
+		constexpr std::array<char, MESH_CACHE_SECTION_ALIGNMENT> padding {};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		uint64_t written = sizeof(header);
+		for (uint32_t i = 0; i < SectionCount; ++i) {
+			file.write(padding.data(), static_cast<std::streamsize>(header.sections[i].offset - written));
+			file.write(reinterpret_cast<const char*>(sectionBytes[i].data()), static_cast<std::streamsize>(sectionBytes[i].size()));
+			written = header.sections[i].offset + sectionBytes[i].size();
+		}
+
+		if (!file.good()) {
+			LOG(Engine, Warning, "Failed to write mesh cache '{}'", temporaryPath.string());
+			file.close();
+			std::filesystem::remove(temporaryPath);
+			return false;
+		}
+	}
+
+	std::error_code renameError;
+	std::filesystem::rename(temporaryPath, cachePath, renameError);
+	if (renameError) {
+		LOG(Engine, Warning, "Failed to move mesh cache into place '{}': {}", cachePath.string(), renameError.message());
+		std::filesystem::remove(temporaryPath, renameError);
+		return false;
+	}
+
+	return true;
+}
+
+std::optional<CookedSceneView> ReadMeshCache(const Pantomir::MappedFile& cacheFile, const ContentHash& sourceHash, const bool bOptimized, const size_t textureCount) {
+	if (!cacheFile.IsOpen() || cacheFile.Size() < sizeof(MeshCacheHeader)) {
+		return std::nullopt;
+	}
+
+	MeshCacheHeader header;
+	memcpy(&header, cacheFile.Data(), sizeof(header));
+	if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION || header.vertexStride != sizeof(PackedVertex) || header.sectionCount != SectionCount) {
+		return std::nullopt;
+	}
+	if (header.sourceHash != sourceHash || header.bOptimized != (bOptimized ? 1u : 0u)) {
+		return std::nullopt;
+	}
+
+	CookedSceneView scene {};
+	const bool      bSectionsValid =
+	    ViewSection(cacheFile, header.sections[Meshes], scene.meshes) &&
+	    ViewSection(cacheFile, header.sections[Surfaces], scene.surfaces) &&
+	    ViewSection(cacheFile, header.sections[Nodes], scene.nodes) &&
+	    ViewSection(cacheFile, header.sections[ChildIndices], scene.childIndices) &&
+	    ViewSection(cacheFile, header.sections[Materials], scene.materials) &&
+	    ViewSection(cacheFile, header.sections[Strings], scene.strings) &&
+	    ViewSection(cacheFile, header.sections[Vertices], scene.vertices) &&
+	    ViewSection(cacheFile, header.sections[Indices16], scene.indices16) &&
+	    ViewSection(cacheFile, header.sections[Indices32], scene.indices32) &&
+	    ViewSection(cacheFile, header.sections[Meshlets], scene.meshlets) &&
+	    ViewSection(cacheFile, header.sections[LODs], scene.lods);
+	if (!bSectionsValid || !IsSceneConsistent(scene, textureCount)) {
+		LOG(Engine, Warning, "Mesh cache is malformed, it will be rebuilt");
+		return std::nullopt;
+	}
+
+	return scene;
+}
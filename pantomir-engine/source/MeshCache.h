@@ -0,0 +1,140 @@
+#ifndef MESHCACHE_H_
+#define MESHCACHE_H_
+
+#include "ContentHash.h"
+#include "PantomirEngine.h"
+#include "VertexPacking.h"
+#include "VkLoader.h"
+
+#include <filesystem>
+
+namespace Pantomir {
+	class MappedFile;
+} // namespace Pantomir
+
+namespace fastgltf {
+	class Asset;
+} // namespace fastgltf
+
+// Everything LoadGltf needs besides images and samplers, flattened into plain arrays so it can be written to disk
+// as-is and read back through a memory mapping. Names live in one string blob, referenced by offset and length.
+
+enum class MaterialTextureSlot : uint32_t {
+	Color,
+	MetalRough,
+	Emissive,
+	Normal,
+	Specular,
+	Count
+};
+
+constexpr size_t MATERIAL_TEXTURE_SLOT_COUNT = static_cast<size_t>(MaterialTextureSlot::Count);
+
+struct CookedName {
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct CookedMesh {
+	uint64_t             firstVertex; // Into the scene-level vertex blob
+	uint64_t             vertexCount;
+	uint64_t             firstIndex;  // Into the scene-level index blob of indexType, indices are relative to firstVertex
+	uint64_t             indexCount;
+	uint32_t             firstSurface;
+	uint32_t             surfaceCount;
+	PositionQuantization quantization; // Decodes the mesh's packed positions
+	VkIndexType          indexType;    // VK_INDEX_TYPE_UINT16 whenever vertexCount allows it
+	CookedName           name;
+};
+
+struct CookedSurface {
+	uint32_t startIndex; // Relative to the owning mesh, like GeoSurface
+	uint32_t count;
+	Bounds   bounds;
+	uint32_t materialIndex;
+	uint32_t firstMeshlet; // Into the scene-level meshlet array
+	uint32_t meshletCount;
+	uint32_t firstLOD;     // Into the scene-level LOD array
+	uint32_t lodCount;
+};
+
+struct CookedNode {
+	glm::mat4  localTransform;
+	int32_t    meshIndex;  // -1 for nodes without a mesh
+	uint32_t   firstChild; // Into the child index array
+	uint32_t   childCount;
+	CookedName name;
+};
+
+struct CookedMaterial {
+	GLTFMetallic_Roughness::MaterialConstants        constants;
+	MaterialPass                                     passType;
+	bool                                             bDoubleSided;
+	std::array<int32_t, MATERIAL_TEXTURE_SLOT_COUNT> textureIndices; // glTF texture index, -1 keeps the default texture
+	CookedName                                       name;
+};
+
+// Non-owning view, either into a CookedScene or into a mapped .pmesh file.
+struct CookedSceneView {
+	std::span<const CookedMesh>     meshes;
+	std::span<const CookedSurface>  surfaces;
+	std::span<const CookedNode>     nodes;
+	std::span<const uint32_t>       childIndices;
+	std::span<const CookedMaterial> materials;
+	std::span<const char>           strings;
+	std::span<const PackedVertex>   vertices;
+	std::span<const uint16_t>       indices16;
+	std::span<const uint32_t>       indices32;
+	std::span<const Meshlet>        meshlets;
+	std::span<const SurfaceLOD>     lods;
+
+	std::string_view                GetName(const CookedName& name) const {
+		return { strings.data() + name.offset, name.length };
+	}
+};
+
+struct CookedScene {
+	std::vector<CookedMesh>     meshes;
+	std::vector<CookedSurface>  surfaces;
+	std::vector<CookedNode>     nodes;
+	std::vector<uint32_t>       childIndices;
+	std::vector<CookedMaterial> materials;
+	std::vector<char>           strings;
+	std::vector<PackedVertex>   vertices;
+	std::vector<uint16_t>       indices16;
+	std::vector<uint32_t>       indices32;
+	std::vector<Meshlet>        meshlets;
+	std::vector<SurfaceLOD>     lods;
+
+	CookedName                  AddName(std::string_view name);
+	CookedSceneView             View() const;
+};
+
+// Full-precision geometry of one surface before cooking. indices index into vertices.
+struct SourceSurface {
+	std::vector<Vertex>   vertices;
+	std::vector<uint32_t> indices;
+	uint32_t              materialIndex = 0;
+	bool                  bTriangles = true; // Only triangle lists are optimized, cut into meshlets and simplified
+};
+
+// Appends one mesh made of surfaces to scene, the same way CookScene cooks a glTF mesh. surfaces are optimized in
+// place, empty ones are skipped. Shared by every source format.
+void                           CookMesh(std::string_view name, std::span<SourceSurface> surfaces, bool bOptimizeMeshes, CookedScene& scene);
+
+// Builds the cooked representation from a parsed asset. This is the slow path the cache exists to skip.
+// bOptimizeMeshes runs every triangle surface through OptimizeMesh and logs the ACMR gained per mesh.
+// Triangle surfaces also get up to MAX_SURFACE_LODS simplified index ranges, appended after the mesh's own indices.
+CookedScene                    CookScene(const fastgltf::Asset& asset, bool bOptimizeMeshes);
+
+// Identifies the source content. A .glb is self-contained, a .gltf also folds in every buffer it loaded.
+ContentHash                    HashGltfSource(const Pantomir::MappedFile& sourceFile, const std::filesystem::path& sourcePath, const fastgltf::Asset& asset);
+
+std::filesystem::path          GetMeshCachePath(const std::filesystem::path& sourcePath);
+bool                           WriteMeshCache(const std::filesystem::path& cachePath, const ContentHash& sourceHash, bool bOptimized, const CookedSceneView& scene);
+
+// Returns a view into the mapping, valid while cacheFile stays open. Fails on a missing, stale or malformed cache, and
+// on materials referencing textures past textureCount, the source asset's texture count.
+std::optional<CookedSceneView> ReadMeshCache(const Pantomir::MappedFile& cacheFile, const ContentHash& sourceHash, bool bOptimized, size_t textureCount);
+
+#endif /*! MESHCACHE_H_ */
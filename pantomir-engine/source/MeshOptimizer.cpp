@@ -0,0 +1,417 @@
+#include "MeshOptimizer.h"
+
+#include "ContentHash.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+	constexpr uint32_t INVALID_INDEX = ~0u;
+
+	// Forsyth's published constants
+	constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+	constexpr float    FORSYTH_CACHE_DECAY_POWER = 1.5f;
+	constexpr float    FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+	constexpr float    FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+	constexpr float    FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+	constexpr uint32_t FORSYTH_MAX_VALENCE = 32; // Scores flatten out long before this, so higher valences share the last entry
+
+	struct VertexBytesHasher {
+		size_t operator()(const Vertex& vertex) const noexcept {
+			return static_cast<size_t>(ContentHash::FromBytes(&vertex, sizeof(Vertex)).low);
+		}
+	};
+
+	struct VertexBytesEqual {
+		bool operator()(const Vertex& a, const Vertex& b) const noexcept {
+			return memcmp(&a, &b, sizeof(Vertex)) == 0;
+		}
+	};
+
+	struct ForsythScoreTables {
+		std::array<float, FORSYTH_CACHE_SIZE>      cache {};
+		std::array<float, FORSYTH_MAX_VALENCE + 1> valence {};
+
+		ForsythScoreTables() {
+			for (uint32_t position = 0; position < FORSYTH_CACHE_SIZE; ++position) {
+				if (position < 3) {
+					// The triangle just emitted. Its vertices get a fixed score so the next pick doesn't simply repeat an edge
+					cache[position] = FORSYTH_LAST_TRIANGLE_SCORE;
+				} else {
+					const float scaler = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+					cache[position] = std::pow(1.0f - static_cast<float>(position - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+				}
+			}
+
+			// Vertices with few triangles left are finished off first, so they don't linger as one-off misses
+			for (uint32_t remaining = 1; remaining <= FORSYTH_MAX_VALENCE; ++remaining) {
+				valence[remaining] = FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining), -FORSYTH_VALENCE_BOOST_POWER);
+			}
+		}
+
+		float VertexScore(const int32_t cachePosition, const uint32_t remainingTriangles) const {
+			if (remainingTriangles == 0) {
+				return -1.0f;
+			}
+
+			const float cacheScore = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+			return cacheScore + valence[std::min(remainingTriangles, FORSYTH_MAX_VALENCE)];
+		}
+	};
+
+	const ForsythScoreTables& GetForsythScoreTables() {
+		static const ForsythScoreTables tables;
+		return tables;
+	}
+
+	// Per-vertex list of the triangles using it, as one flat array. counts shrink as triangles are emitted.
+	struct VertexAdjacency {
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> counts;
+		std::vector<uint32_t> triangles;
+
+		VertexAdjacency(const std::span<const uint32_t> indices, const size_t vertexCount) {
+			offsets.assign(vertexCount, 0);
+			counts.assign(vertexCount, 0);
+			triangles.resize(indices.size());
+
+			for (const uint32_t index : indices) {
+				++counts[index];
+			}
+
+			uint32_t offset = 0;
+			for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+				offsets[vertex] = offset;
+				offset += counts[vertex];
+				counts[vertex] = 0;
+			}
+
+			for (size_t corner = 0; corner < indices.size(); ++corner) {
+				const uint32_t vertex = indices[corner];
+				triangles[offsets[vertex] + counts[vertex]++] = static_cast<uint32_t>(corner / 3);
+			}
+		}
+
+		std::span<uint32_t> Get(const uint32_t vertex) {
+			return { triangles.data() + offsets[vertex], counts[vertex] };
+		}
+
+		void Remove(const uint32_t vertex, const uint32_t triangle) {
+			std::span<uint32_t> vertexTriangles = Get(vertex);
+			for (uint32_t& entry : vertexTriangles) {
+				if (entry == triangle) {
+					entry = vertexTriangles.back();
+					--counts[vertex];
+					return;
+				}
+			}
+		}
+	};
+
+	// Misses per triangle against a FIFO cache, which is how post-transform caches on current hardware behave.
+	// Timestamps avoid storing the cache itself, a vertex is resident while fewer than cacheSize misses happened since it was loaded.
+	struct FifoCacheSimulator {
+		std::vector<uint32_t> timestamps;
+		uint32_t              time;
+		uint32_t              cacheSize;
+
+		FifoCacheSimulator(const size_t vertexCount, const uint32_t size)
+		    : timestamps(vertexCount, 0), time(size + 1), cacheSize(size) {}
+
+		uint32_t Triangle(const uint32_t* triangle) {
+			uint32_t misses = 0;
+			for (int corner = 0; corner < 3; ++corner) {
+				const uint32_t vertex = triangle[corner];
+				if (time - timestamps[vertex] > cacheSize) {
+					timestamps[vertex] = time++;
+					++misses;
+				}
+			}
+			return misses;
+		}
+
+		void Flush() {
+			time += cacheSize + 1;
+		}
+	};
+} // namespace
+
+float MeshOptimizationStats::GetACMRBefore() const {
+	return triangleCount > 0 ? static_cast<float>(cacheMissesBefore) / static_cast<float>(triangleCount) : 0.0f;
+}
+
+float MeshOptimizationStats::GetACMRAfter() const {
+	return triangleCount > 0 ? static_cast<float>(cacheMissesAfter) / static_cast<float>(triangleCount) : 0.0f;
+}
+
+void MeshOptimizationStats::Accumulate(const MeshOptimizationStats& other) {
+	sourceVertexCount += other.sourceVertexCount;
+	optimizedVertexCount += other.optimizedVertexCount;
+	triangleCount += other.triangleCount;
+	cacheMissesBefore += other.cacheMissesBefore;
+	cacheMissesAfter += other.cacheMissesAfter;
+}
+
+size_t WeldVertices(std::vector<Vertex>& vertices, const std::span<uint32_t> indices) {
+	std::unordered_map<Vertex, uint32_t, VertexBytesHasher, VertexBytesEqual> uniqueVertices;
+	uniqueVertices.reserve(vertices.size());
+
+	std::vector<uint32_t> remap(vertices.size());
+	uint32_t              weldedCount = 0;
+	for (size_t vertex = 0; vertex < vertices.size(); ++vertex) {
+		const auto [it, bInserted] = uniqueVertices.try_emplace(vertices[vertex], weldedCount);
+		if (bInserted) {
+			vertices[weldedCount++] = vertices[vertex];
+		}
+		remap[vertex] = it->second;
+	}
+
+	for (uint32_t& index : indices) {
+		index = remap[index];
+	}
+
+	vertices.resize(weldedCount);
+	return weldedCount;
+}
+
+void OptimizeVertexCache(const std::span<uint32_t> indices, const size_t vertexCount) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	const ForsythScoreTables& scoreTables = GetForsythScoreTables();
+	VertexAdjacency           adjacency(indices, vertexCount);
+
+	std::vector<int32_t>      cachePositions(vertexCount, -1);
+	std::vector<float>        vertexScores(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+		vertexScores[vertex] = scoreTables.VertexScore(-1, adjacency.counts[vertex]);
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	uint32_t          bestTriangle = 0;
+	float             bestScore = -1.0f;
+	for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+		const uint32_t* corners = &indices[triangle * 3];
+		const float     score = vertexScores[corners[0]] + vertexScores[corners[1]] + vertexScores[corners[2]];
+		if (score > bestScore) {
+			bestScore = score;
+			bestTriangle = static_cast<uint32_t>(triangle);
+		}
+	}
+
+	std::vector<uint32_t>                         output(indices.size());
+	std::array<uint32_t, FORSYTH_CACHE_SIZE + 3> cache {};
+	std::array<uint32_t, FORSYTH_CACHE_SIZE + 3> nextCache {};
+	size_t                                        cacheCount = 0;
+	size_t                                        inputCursor = 0; // Fallback when nothing in the cache has triangles left
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+		if (bestTriangle == INVALID_INDEX) {
+			while (emitted[inputCursor]) {
+				++inputCursor;
+			}
+			bestTriangle = static_cast<uint32_t>(inputCursor);
+		}
+
+		const uint32_t* corners = &indices[static_cast<size_t>(bestTriangle) * 3];
+		std::copy_n(corners, 3, &output[emittedCount * 3]);
+		emitted[bestTriangle] = true;
+
+		// The emitted triangle moves to the front of the LRU, everything else shifts back and may fall off
+		size_t nextCount = 0;
+		for (int corner = 0; corner < 3; ++corner) {
+			adjacency.Remove(corners[corner], bestTriangle);
+			nextCache[nextCount++] = corners[corner];
+		}
+		for (size_t entry = 0; entry < cacheCount; ++entry) {
+			const uint32_t vertex = cache[entry];
+			if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+				nextCache[nextCount++] = vertex;
+			}
+		}
+
+		for (size_t entry = 0; entry < nextCount; ++entry) {
+			const uint32_t vertex = nextCache[entry];
+			cachePositions[vertex] = entry < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(entry) : -1;
+			vertexScores[vertex] = scoreTables.VertexScore(cachePositions[vertex], adjacency.counts[vertex]);
+		}
+
+		// Only triangles touching a vertex whose score changed can have changed, the best of them is the next pick
+		bestTriangle = INVALID_INDEX;
+		bestScore = -1.0f;
+		for (size_t entry = 0; entry < nextCount; ++entry) {
+			for (const uint32_t triangle : adjacency.Get(nextCache[entry])) {
+				const uint32_t* triangleCorners = &indices[static_cast<size_t>(triangle) * 3];
+				const float     score = vertexScores[triangleCorners[0]] + vertexScores[triangleCorners[1]] + vertexScores[triangleCorners[2]];
+				if (score > bestScore) {
+					bestScore = score;
+					bestTriangle = triangle;
+				}
+			}
+		}
+
+		cacheCount = std::min<size_t>(nextCount, FORSYTH_CACHE_SIZE);
+		std::copy_n(nextCache.begin(), cacheCount, cache.begin());
+	}
+
+	std::ranges::copy(output, indices.begin());
+}
+
+void OptimizeOverdraw(const std::span<uint32_t> indices, const std::span<const Vertex> vertices, const float threshold) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// Hard boundaries: triangles where all three vertices miss, the cache is cold there anyway so splitting costs nothing
+	std::vector<uint32_t> clusterStarts;
+	{
+		FifoCacheSimulator cacheSimulator(vertices.size(), MESH_OPTIMIZER_ACMR_CACHE_SIZE);
+		for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+			if (cacheSimulator.Triangle(&indices[triangle * 3]) == 3) {
+				clusterStarts.push_back(static_cast<uint32_t>(triangle));
+			}
+		}
+	}
+	if (clusterStarts.empty() || clusterStarts.front() != 0) {
+		clusterStarts.insert(clusterStarts.begin(), 0);
+	}
+
+	// Soft boundaries: split a hard cluster further wherever the ACMR since the last split, with a cold cache, is already
+	// within threshold of the whole cluster's. Smaller clusters sort better at the price of a few extra misses.
+	std::vector<uint32_t> softClusterStarts;
+	for (size_t cluster = 0; cluster < clusterStarts.size(); ++cluster) {
+		const uint32_t start = clusterStarts[cluster];
+		const uint32_t end = cluster + 1 < clusterStarts.size() ? clusterStarts[cluster + 1] : static_cast<uint32_t>(triangleCount);
+
+		FifoCacheSimulator cacheSimulator(vertices.size(), MESH_OPTIMIZER_ACMR_CACHE_SIZE);
+		size_t             clusterMisses = 0;
+		for (uint32_t triangle = start; triangle < end; ++triangle) {
+			clusterMisses += cacheSimulator.Triangle(&indices[static_cast<size_t>(triangle) * 3]);
+		}
+		const float clusterACMR = static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+		cacheSimulator.Flush();
+		softClusterStarts.push_back(start);
+		size_t   runningMisses = 0;
+		uint32_t runningStart = start;
+		for (uint32_t triangle = start; triangle < end; ++triangle) {
+			runningMisses += cacheSimulator.Triangle(&indices[static_cast<size_t>(triangle) * 3]);
+			const uint32_t runningCount = triangle - runningStart + 1;
+			if (triangle + 1 < end && static_cast<float>(runningMisses) / static_cast<float>(runningCount) <= clusterACMR * threshold) {
+				softClusterStarts.push_back(triangle + 1);
+				runningStart = triangle + 1;
+				runningMisses = 0;
+				cacheSimulator.Flush();
+			}
+		}
+	}
+
+	// Occlusion potential: how far the cluster sits out along its own facing direction, measured from the mesh centroid
+	glm::vec3 meshCentroid { 0.0f };
+	for (const uint32_t index : indices) {
+		meshCentroid += vertices[index].position;
+	}
+	meshCentroid /= static_cast<float>(indices.size());
+
+	const size_t       clusterCount = softClusterStarts.size();
+	std::vector<float> sortKeys(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; ++cluster) {
+		const uint32_t start = softClusterStarts[cluster];
+		const uint32_t end = cluster + 1 < clusterCount ? softClusterStarts[cluster + 1] : static_cast<uint32_t>(triangleCount);
+
+		glm::vec3      areaWeightedNormal { 0.0f };
+		glm::vec3      areaWeightedCentroid { 0.0f };
+		float          totalArea = 0.0f;
+		for (uint32_t triangle = start; triangle < end; ++triangle) {
+			const glm::vec3& a = vertices[indices[static_cast<size_t>(triangle) * 3 + 0]].position;
+			const glm::vec3& b = vertices[indices[static_cast<size_t>(triangle) * 3 + 1]].position;
+			const glm::vec3& c = vertices[indices[static_cast<size_t>(triangle) * 3 + 2]].position;
+
+			const glm::vec3  normal = glm::cross(b - a, c - a); // Length is twice the area
+			const float      area = glm::length(normal);
+			areaWeightedNormal += normal;
+			areaWeightedCentroid += (a + b + c) * (area / 3.0f);
+			totalArea += area;
+		}
+
+		if (totalArea > 0.0f) {
+			areaWeightedCentroid /= totalArea;
+		}
+		const float normalLength = glm::length(areaWeightedNormal);
+		if (normalLength > 0.0f) {
+			areaWeightedNormal /= normalLength;
+		}
+		sortKeys[cluster] = glm::dot(areaWeightedCentroid - meshCentroid, areaWeightedNormal);
+	}
+
+	std::vector<uint32_t> clusterOrder(clusterCount);
+	std::iota(clusterOrder.begin(), clusterOrder.end(), 0u);
+	std::ranges::stable_sort(clusterOrder, [&](const uint32_t a, const uint32_t b) {
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+	for (const uint32_t cluster : clusterOrder) {
+		const size_t start = softClusterStarts[cluster];
+		const size_t end = cluster + 1 < clusterCount ? softClusterStarts[cluster + 1] : triangleCount;
+		output.insert(output.end(), indices.begin() + start * 3, indices.begin() + end * 3);
+	}
+
+	std::ranges::copy(output, indices.begin());
+}
+
+size_t OptimizeVertexFetch(std::vector<Vertex>& vertices, const std::span<uint32_t> indices) {
+	std::vector<uint32_t> remap(vertices.size(), INVALID_INDEX);
+	std::vector<Vertex>   reordered;
+	reordered.reserve(vertices.size());
+
+	for (uint32_t& index : indices) {
+		if (remap[index] == INVALID_INDEX) {
+			remap[index] = static_cast<uint32_t>(reordered.size());
+			reordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	vertices = std::move(reordered);
+	return vertices.size();
+}
+
+size_t CountCacheMisses(const std::span<const uint32_t> indices, const size_t vertexCount, const uint32_t cacheSize) {
+	FifoCacheSimulator cacheSimulator(vertexCount, cacheSize);
+	size_t             misses = 0;
+	for (size_t corner = 0; corner + 3 <= indices.size(); corner += 3) {
+		misses += cacheSimulator.Triangle(&indices[corner]);
+	}
+	return misses;
+}
+
+MeshOptimizationStats OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+	MeshOptimizationStats stats {};
+	stats.sourceVertexCount = vertices.size();
+	stats.optimizedVertexCount = vertices.size();
+	stats.triangleCount = indices.size() / 3;
+	stats.cacheMissesBefore = CountCacheMisses(indices, vertices.size());
+	stats.cacheMissesAfter = stats.cacheMissesBefore;
+
+	if (indices.empty() || indices.size() % 3 != 0) {
+		return stats;
+	}
+
+	WeldVertices(vertices, indices);
+	OptimizeVertexCache(indices, vertices.size());
+	OptimizeOverdraw(indices, vertices);
+	stats.optimizedVertexCount = OptimizeVertexFetch(vertices, indices);
+	stats.cacheMissesAfter = CountCacheMisses(indices, vertices.size());
+	return stats;
+}
@@ -0,0 +1,46 @@
+#ifndef MESHOPTIMIZER_H_
+#define MESHOPTIMIZER_H_
+
+#include "VkTypes.h"
+
+// Cook-time reordering of one indexed triangle list. Exporters, CAD ones in particular, emit triangles and vertices in
+// whatever order their own data structures held them, which thrashes the post-transform cache and the vertex fetch.
+// Every stage keeps the list rendering the same triangles, only their order and the vertex numbering change.
+
+constexpr uint32_t MESH_OPTIMIZER_ACMR_CACHE_SIZE = 16; // FIFO size used for reporting, typical of current GPUs
+
+struct MeshOptimizationStats {
+	size_t sourceVertexCount = 0;
+	size_t optimizedVertexCount = 0;
+	size_t triangleCount = 0;
+	size_t cacheMissesBefore = 0;
+	size_t cacheMissesAfter = 0;
+
+	// Average cache miss ratio: transformed vertices per triangle, 0.5 is the ideal for a regular grid and 3 the worst
+	float  GetACMRBefore() const;
+	float  GetACMRAfter() const;
+
+	void   Accumulate(const MeshOptimizationStats& other);
+};
+
+// Merges vertices whose attributes are bit-identical and rewrites indices to the survivors. Returns the vertex count.
+size_t                WeldVertices(std::vector<Vertex>& vertices, std::span<uint32_t> indices);
+
+// Tom Forsyth's linear-speed vertex cache optimization: greedily emits the triangle whose vertices score best against
+// a simulated LRU cache, so consecutive triangles reuse recently transformed vertices.
+void                  OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount);
+
+// Sander et al.: splits a cache-optimized list into clusters at points where the cache starts cold, then draws clusters
+// that face away from the mesh center first, since those tend to occlude the rest. threshold bounds the ACMR each
+// cluster may lose to the extra splits, 1.05 allows 5%.
+void                  OptimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float threshold = 1.05f);
+
+// Renumbers vertices in the order the index list first references them and drops unreferenced ones. Returns the vertex count.
+size_t                OptimizeVertexFetch(std::vector<Vertex>& vertices, std::span<uint32_t> indices);
+
+size_t                CountCacheMisses(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = MESH_OPTIMIZER_ACMR_CACHE_SIZE);
+
+// Runs every stage above in order. A list that isn't a whole number of triangles is left untouched.
+MeshOptimizationStats OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+#endif /*! MESHOPTIMIZER_H_ */
@@ -0,0 +1,273 @@
+#include "MeshSimplifier.h"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
+
+namespace {
+	constexpr uint32_t INVALID_INDEX = ~0u;
+
+	// A collapse may tilt the triangles it reshapes, but not past this cosine, and never turn them over
+	constexpr float    SIMPLIFY_MIN_NORMAL_COSINE = 0.25f;
+
+	// Symmetric 4x4 matrix summing the squared distance to every plane it absorbed, weighted by triangle area
+	struct Quadric {
+		float a00 = 0.0f;
+		float a11 = 0.0f;
+		float a22 = 0.0f;
+		float a10 = 0.0f;
+		float a20 = 0.0f;
+		float a21 = 0.0f;
+		float b0 = 0.0f;
+		float b1 = 0.0f;
+		float b2 = 0.0f;
+		float c = 0.0f;
+		float weight = 0.0f;
+
+		void AddPlane(const glm::vec3& normal, const float distance, const float planeWeight) {
+			a00 += normal.x * normal.x * planeWeight;
+			a11 += normal.y * normal.y * planeWeight;
+			a22 += normal.z * normal.z * planeWeight;
+			a10 += normal.y * normal.x * planeWeight;
+			a20 += normal.z * normal.x * planeWeight;
+			a21 += normal.z * normal.y * planeWeight;
+			b0 += normal.x * distance * planeWeight;
+			b1 += normal.y * distance * planeWeight;
+			b2 += normal.z * distance * planeWeight;
+			c += distance * distance * planeWeight;
+			weight += planeWeight;
+		}
+
+		void Add(const Quadric& other) {
+			a00 += other.a00;
+			a11 += other.a11;
+			a22 += other.a22;
+			a10 += other.a10;
+			a20 += other.a20;
+			a21 += other.a21;
+			b0 += other.b0;
+			b1 += other.b1;
+			b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		float Evaluate(const glm::vec3& position) const {
+			const float rx = a00 * position.x + a10 * position.y + a20 * position.z;
+			const float ry = a10 * position.x + a11 * position.y + a21 * position.z;
+			const float rz = a20 * position.x + a21 * position.y + a22 * position.z;
+			const float error = rx * position.x + ry * position.y + rz * position.z + 2.0f * (b0 * position.x + b1 * position.y + b2 * position.z) + c;
+			return std::abs(error);
+		}
+	};
+
+	struct Collapse {
+		uint32_t from;
+		uint32_t to;
+		float    error; // Squared, averaged over the area both vertices absorbed
+	};
+
+	float CollapseError(const Quadric& from, const Quadric& to, const glm::vec3& position) {
+		Quadric merged = from;
+		merged.Add(to);
+		return merged.weight > 0.0f ? merged.Evaluate(position) / merged.weight : 0.0f;
+	}
+
+	uint64_t EdgeKey(const uint32_t a, const uint32_t b) {
+		return (static_cast<uint64_t>(a) << 32) | b;
+	}
+} // namespace
+
+float SimplifyMesh(const std::span<const uint32_t> indices, const std::span<const Vertex> vertices, const size_t targetIndexCount, const float targetError, std::vector<uint32_t>& out_indices) {
+	out_indices.assign(indices.begin(), indices.end());
+	if (indices.size() % 3 != 0 || out_indices.size() <= targetIndexCount) {
+		return 0.0f;
+	}
+
+	const size_t vertexCount = vertices.size();
+
+	// Normalized to the unit cube, so errors don't depend on the mesh's units
+	glm::vec3    minPosition { std::numeric_limits<float>::max() };
+	glm::vec3    maxPosition { std::numeric_limits<float>::lowest() };
+	for (const uint32_t index : indices) {
+		minPosition = glm::min(minPosition, vertices[index].position);
+		maxPosition = glm::max(maxPosition, vertices[index].position);
+	}
+	const glm::vec3        size = maxPosition - minPosition;
+	const float            extent = std::max(std::max(size.x, size.y), size.z);
+	const float            scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+	std::vector<glm::vec3> positions(vertexCount);
+	for (size_t vertex = 0; vertex < vertexCount; ++vertex) {
+		positions[vertex] = (vertices[vertex].position - minPosition) * scale;
+	}
+
+	// An edge walked in only one direction has no triangle on its other side
+	std::unordered_set<uint64_t> edges;
+	edges.reserve(indices.size());
+	for (size_t triangle = 0; triangle < indices.size(); triangle += 3) {
+		for (size_t corner = 0; corner < 3; ++corner) {
+			edges.insert(EdgeKey(indices[triangle + corner], indices[triangle + (corner + 1) % 3]));
+		}
+	}
+
+	std::vector<uint8_t> lockedVertices(vertexCount, 0);
+	for (size_t triangle = 0; triangle < indices.size(); triangle += 3) {
+		for (size_t corner = 0; corner < 3; ++corner) {
+			const uint32_t a = indices[triangle + corner];
+			const uint32_t b = indices[triangle + (corner + 1) % 3];
+			if (!edges.contains(EdgeKey(b, a))) {
+				lockedVertices[a] = 1;
+				lockedVertices[b] = 1;
+			}
+		}
+	}
+
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t triangle = 0; triangle < indices.size(); triangle += 3) {
+		const glm::vec3& p0 = positions[indices[triangle + 0]];
+		const glm::vec3& p1 = positions[indices[triangle + 1]];
+		const glm::vec3& p2 = positions[indices[triangle + 2]];
+
+		const glm::vec3  normal = glm::cross(p1 - p0, p2 - p0);
+		const float      length = glm::length(normal);
+		if (length == 0.0f) {
+			continue;
+		}
+
+		const glm::vec3 unitNormal = normal / length;
+		const float     distance = -glm::dot(unitNormal, p0);
+		for (size_t corner = 0; corner < 3; ++corner) {
+			quadrics[indices[triangle + corner]].AddPlane(unitNormal, distance, length * 0.5f);
+		}
+	}
+
+	const float           maxError = targetError * targetError;
+	float                 reachedError = 0.0f;
+
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+	std::vector<uint32_t> triangleCursors(vertexCount);
+	std::vector<uint32_t> vertexTriangles;
+	std::vector<Collapse> collapses;
+	std::vector<uint8_t>  touchedVertices(vertexCount);
+
+	auto                  adjacentTriangles = [&](const uint32_t vertex) {
+		return std::span(vertexTriangles).subspan(triangleOffsets[vertex], triangleOffsets[vertex + 1] - triangleOffsets[vertex]);
+	};
+
+	// Rejects collapses that would turn a surviving triangle over, or tilt it too far
+	auto flipsTriangle = [&](const uint32_t from, const uint32_t to) {
+		for (const uint32_t triangle : adjacentTriangles(from)) {
+			const uint32_t* corners = &out_indices[triangle * 3];
+			if (corners[0] == to || corners[1] == to || corners[2] == to) {
+				continue; // Collapses away
+			}
+
+			const size_t     corner = corners[0] == from ? 0 : (corners[1] == from ? 1 : 2);
+			const glm::vec3& a = positions[corners[(corner + 1) % 3]];
+			const glm::vec3& b = positions[corners[(corner + 2) % 3]];
+			const glm::vec3  before = glm::cross(a - positions[from], b - positions[from]);
+			const glm::vec3  after = glm::cross(a - positions[to], b - positions[to]);
+			if (glm::dot(before, after) <= SIMPLIFY_MIN_NORMAL_COSINE * glm::length(before) * glm::length(after)) {
+				return true;
+			}
+		}
+		return false;
+	};
+
+	// Each pass collapses the cheapest edges whose neighborhoods don't overlap, then drops the triangles they flattened
+	while (out_indices.size() > targetIndexCount) {
+		std::ranges::fill(triangleOffsets, 0);
+		for (const uint32_t index : out_indices) {
+			++triangleOffsets[index + 1];
+		}
+		std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+		std::copy(triangleOffsets.begin(), triangleOffsets.end() - 1, triangleCursors.begin());
+		vertexTriangles.resize(out_indices.size());
+		for (size_t corner = 0; corner < out_indices.size(); ++corner) {
+			vertexTriangles[triangleCursors[out_indices[corner]]++] = static_cast<uint32_t>(corner / 3);
+		}
+
+		collapses.clear();
+		for (uint32_t vertex = 0; vertex < vertexCount; ++vertex) {
+			if (lockedVertices[vertex] != 0) {
+				continue;
+			}
+
+			Collapse best { vertex, INVALID_INDEX, std::numeric_limits<float>::max() };
+			for (const uint32_t triangle : adjacentTriangles(vertex)) {
+				for (size_t corner = 0; corner < 3; ++corner) {
+					const uint32_t neighbor = out_indices[triangle * 3 + corner];
+					if (neighbor == vertex) {
+						continue;
+					}
+
+					const float error = CollapseError(quadrics[vertex], quadrics[neighbor], positions[neighbor]);
+					if (error < best.error) {
+						best = { vertex, neighbor, error };
+					}
+				}
+			}
+
+			if (best.to != INVALID_INDEX && best.error <= maxError) {
+				collapses.push_back(best);
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+
+		std::ranges::sort(collapses, {}, &Collapse::error);
+
+		std::ranges::fill(touchedVertices, 0);
+		const size_t excessTriangles = (out_indices.size() - targetIndexCount + 2) / 3;
+		size_t       removedTriangles = 0;
+		for (const Collapse& collapse : collapses) {
+			if (removedTriangles >= excessTriangles) {
+				break;
+			}
+			if (touchedVertices[collapse.from] != 0 || touchedVertices[collapse.to] != 0 || flipsTriangle(collapse.from, collapse.to)) {
+				continue;
+			}
+
+			for (const uint32_t triangle : adjacentTriangles(collapse.from)) {
+				uint32_t* corners = &out_indices[triangle * 3];
+				if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to) {
+					++removedTriangles;
+				}
+				for (size_t corner = 0; corner < 3; ++corner) {
+					touchedVertices[corners[corner]] = 1;
+					if (corners[corner] == collapse.from) {
+						corners[corner] = collapse.to;
+					}
+				}
+			}
+
+			quadrics[collapse.to].Add(quadrics[collapse.from]);
+			reachedError = std::max(reachedError, collapse.error);
+		}
+		if (removedTriangles == 0) {
+			break;
+		}
+
+		size_t writeIndex = 0;
+		for (size_t triangle = 0; triangle < out_indices.size(); triangle += 3) {
+			const uint32_t a = out_indices[triangle + 0];
+			const uint32_t b = out_indices[triangle + 1];
+			const uint32_t c = out_indices[triangle + 2];
+			if (a != b && b != c && a != c) {
+				out_indices[writeIndex++] = a;
+				out_indices[writeIndex++] = b;
+				out_indices[writeIndex++] = c;
+			}
+		}
+		out_indices.resize(writeIndex);
+	}
+
+	return std::sqrt(reachedError);
+}
@@ -0,0 +1,15 @@
+#ifndef MESHSIMPLIFIER_H_
+#define MESHSIMPLIFIER_H_
+
+#include "VkTypes.h"
+
+// Cook-time level of detail. Simplification only rewrites the index list, every LOD keeps drawing from the full-detail
+// vertices, so a surface's LODs are extra index ranges into the same vertex buffer.
+
+// Garland and Heckbert's quadric error metric, restricted to collapsing a vertex onto one of its neighbors. Vertices on
+// open edges stay put, which also pins UV and normal seams since those are open edges between split vertices.
+// Stops at targetIndexCount or once the next collapse would move the surface further than targetError, measured
+// relative to the largest extent of the mesh. Returns the largest error reached, in the same units.
+float SimplifyMesh(std::span<const uint32_t> indices, std::span<const Vertex> vertices, size_t targetIndexCount, float targetError, std::vector<uint32_t>& out_indices);
+
+#endif /*! MESHSIMPLIFIER_H_ */
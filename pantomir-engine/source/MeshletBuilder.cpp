@@ -0,0 +1,149 @@
+#include "MeshletBuilder.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+	// Triangles whose normals spread further than this from the axis make the cone useless, it could never cull
+	constexpr float MESHLET_CONE_MIN_DOT = 0.1f;
+
+	// Ritter's bounding sphere: start from the most separated pair of axis extremes, then grow to cover stragglers.
+	// Within a few percent of the minimal sphere, which is plenty for culling.
+	void ComputeBoundingSphere(const std::span<const uint32_t> indices, const std::span<const Vertex> vertices, glm::vec3& out_center, float& out_radius) {
+		std::array<uint32_t, 3> minIndices { indices[0], indices[0], indices[0] };
+		std::array<uint32_t, 3> maxIndices { indices[0], indices[0], indices[0] };
+		for (const uint32_t index : indices) {
+			const glm::vec3& position = vertices[index].position;
+			for (int axis = 0; axis < 3; ++axis) {
+				if (position[axis] < vertices[minIndices[axis]].position[axis]) {
+					minIndices[axis] = index;
+				}
+				if (position[axis] > vertices[maxIndices[axis]].position[axis]) {
+					maxIndices[axis] = index;
+				}
+			}
+		}
+
+		int   widestAxis = 0;
+		float widestDistance = -1.0f;
+		for (int axis = 0; axis < 3; ++axis) {
+			const glm::vec3 span = vertices[maxIndices[axis]].position - vertices[minIndices[axis]].position;
+			const float     distance = glm::dot(span, span);
+			if (distance > widestDistance) {
+				widestDistance = distance;
+				widestAxis = axis;
+			}
+		}
+
+		glm::vec3 center = (vertices[minIndices[widestAxis]].position + vertices[maxIndices[widestAxis]].position) * 0.5f;
+		float     radius = std::sqrt(widestDistance) * 0.5f;
+		for (const uint32_t index : indices) {
+			const glm::vec3& position = vertices[index].position;
+			const float      distance = glm::length(position - center);
+			if (distance > radius) {
+				const float grownRadius = (radius + distance) * 0.5f;
+				center += (position - center) * ((grownRadius - radius) / distance);
+				radius = grownRadius;
+			}
+		}
+
+		out_center = center;
+		out_radius = radius;
+	}
+} // namespace
+
+void ComputeMeshletBounds(const std::span<const uint32_t> indices, const std::span<const Vertex> vertices, Meshlet& out_meshlet) {
+	ComputeBoundingSphere(indices, vertices, out_meshlet.center, out_meshlet.radius);
+
+	// Axis is the average facing direction, degenerate triangles contribute nothing
+	std::array<glm::vec3, MESHLET_MAX_TRIANGLES> normals {};
+	size_t                                       normalCount = 0;
+	glm::vec3                                    axis { 0.0f };
+	for (size_t corner = 0; corner + 3 <= indices.size() && normalCount < normals.size(); corner += 3) {
+		const glm::vec3& a = vertices[indices[corner + 0]].position;
+		const glm::vec3& b = vertices[indices[corner + 1]].position;
+		const glm::vec3& c = vertices[indices[corner + 2]].position;
+
+		const glm::vec3  normal = glm::cross(b - a, c - a);
+		const float      length = glm::length(normal);
+		if (length > 0.0f) {
+			normals[normalCount] = normal / length;
+			axis += normals[normalCount];
+			++normalCount;
+		}
+	}
+
+	const float axisLength = glm::length(axis);
+	out_meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3 { 0.0f, 0.0f, 1.0f };
+	out_meshlet.coneCutoff = 1.0f;
+	if (normalCount == 0 || axisLength == 0.0f) {
+		return;
+	}
+
+	float minDot = 1.0f;
+	for (size_t normal = 0; normal < normalCount; ++normal) {
+		minDot = std::min(minDot, glm::dot(normals[normal], out_meshlet.coneAxis));
+	}
+
+	// A triangle faces away from the camera when the view direction is within 90 degrees of its normal. For every
+	// normal within acos(minDot) of the axis, that holds once the view direction is within asin(minDot) of the axis.
+	if (minDot > MESHLET_CONE_MIN_DOT) {
+		out_meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+}
+
+uint32_t BuildMeshlets(const std::span<const uint32_t> indices, const std::span<const Vertex> vertices, const uint32_t indexOffset, std::vector<Meshlet>& out_meshlets) {
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) {
+		return 0;
+	}
+
+	// Stamped with the meshlet number instead of cleared per meshlet
+	std::vector<uint32_t> vertexStamps(vertices.size(), 0);
+	uint32_t              stamp = 1;
+	uint32_t              meshletVertexCount = 0;
+	size_t                meshletStart = 0;
+	const size_t          firstMeshlet = out_meshlets.size();
+
+	auto closeMeshlet = [&](const size_t triangleEnd) {
+		const std::span<const uint32_t> meshletIndices = indices.subspan(meshletStart * 3, (triangleEnd - meshletStart) * 3);
+
+		Meshlet                         meshlet {};
+		meshlet.firstIndex = indexOffset + static_cast<uint32_t>(meshletStart * 3);
+		meshlet.indexCount = static_cast<uint32_t>(meshletIndices.size());
+		ComputeMeshletBounds(meshletIndices, vertices, meshlet);
+		out_meshlets.push_back(meshlet);
+
+		meshletStart = triangleEnd;
+		meshletVertexCount = 0;
+		++stamp;
+	};
+
+	// Degenerate triangles may repeat a vertex, it still only takes one slot
+	auto countNewVertices = [&](const uint32_t* corners) {
+		return static_cast<uint32_t>(vertexStamps[corners[0]] != stamp) +
+		       static_cast<uint32_t>(vertexStamps[corners[1]] != stamp && corners[1] != corners[0]) +
+		       static_cast<uint32_t>(vertexStamps[corners[2]] != stamp && corners[2] != corners[0] && corners[2] != corners[1]);
+	};
+
+	for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+		const uint32_t* corners = &indices[triangle * 3];
+
+		uint32_t        newVertices = countNewVertices(corners);
+		if (meshletVertexCount + newVertices > MESHLET_MAX_VERTICES || triangle - meshletStart == MESHLET_MAX_TRIANGLES) {
+			closeMeshlet(triangle);
+			newVertices = countNewVertices(corners);
+		}
+
+		for (int corner = 0; corner < 3; ++corner) {
+			vertexStamps[corners[corner]] = stamp;
+		}
+		meshletVertexCount += newVertices;
+	}
+	closeMeshlet(triangleCount);
+
+	return static_cast<uint32_t>(out_meshlets.size() - firstMeshlet);
+}
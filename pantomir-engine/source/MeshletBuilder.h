@@ -0,0 +1,19 @@
+#ifndef MESHLETBUILDER_H_
+#define MESHLETBUILDER_H_
+
+#include "VkTypes.h"
+
+// Meshlets are cut from the surface's triangle order as-is, so they stay contiguous ranges of the index buffer and
+// draw with plain indexed draws. Run OptimizeMesh first, its vertex cache order already keeps neighbors together.
+
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// indices index into vertices. indexOffset is added to every meshlet's firstIndex, pass where indices[0] lives.
+// Appends to out_meshlets and returns how many meshlets this surface produced.
+uint32_t BuildMeshlets(std::span<const uint32_t> indices, std::span<const Vertex> vertices, uint32_t indexOffset, std::vector<Meshlet>& out_meshlets);
+
+// Fills center, radius, coneAxis and coneCutoff from the triangles in indices.
+void     ComputeMeshletBounds(std::span<const uint32_t> indices, std::span<const Vertex> vertices, Meshlet& out_meshlet);
+
+#endif /*! MESHLETBUILDER_H_ */
@@ -0,0 +1,451 @@
+#include "ObjImporter.h"
+
+#include "LoggerMacros.h"
+#include "ThreadPool.h"
+
+#include <glm/geometric.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+	constexpr size_t  OBJ_MIN_CHUNK_SIZE = 1024 * 1024; // Smaller chunks cost more in scheduling than they save
+	constexpr size_t  OBJ_CHUNKS_PER_THREAD = 4;        // Some slack so a chunk full of faces doesn't hold up the rest
+	constexpr int32_t OBJ_MISSING_INDEX = -1;
+
+	enum class ObjLineType : uint8_t {
+		Position,
+		UV,
+		Normal,
+		Face,
+		Other
+	};
+
+	// One face corner, resolved to 0-based indices into the file-wide attribute arrays
+	struct ObjCorner {
+		int32_t position;
+		int32_t uv;
+		int32_t normal;
+
+		bool    operator==(const ObjCorner&) const = default;
+	};
+
+	struct ObjCornerHasher {
+		size_t operator()(const ObjCorner& corner) const noexcept {
+			uint64_t hash = static_cast<uint32_t>(corner.position);
+			hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(corner.uv);
+			hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(corner.normal);
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
+	};
+
+	struct ObjChunk {
+		const char*            begin = nullptr;
+		const char*            end = nullptr;
+
+		// Counted in the first pass, their prefix sums place each chunk's attributes in the file-wide arrays
+		size_t                 positionCount = 0;
+		size_t                 uvCount = 0;
+		size_t                 normalCount = 0;
+		size_t                 firstPosition = 0;
+		size_t                 firstUV = 0;
+		size_t                 firstNormal = 0;
+
+		std::vector<ObjCorner> triangleCorners; // Three per triangle, in file order
+		size_t                 skippedFaces = 0;
+
+		// Deduplicated within the chunk first, the file-wide pass then only hashes each chunk's distinct corners
+		std::vector<ObjCorner> uniqueCorners;  // In order of first use
+		std::vector<uint32_t>  localIndices;   // Into uniqueCorners, one per triangle corner
+		std::vector<uint32_t>  vertexByUnique; // Into the file-wide vertices, one per unique corner
+		size_t                 firstIndex = 0; // Where localIndices land in the file-wide index list
+	};
+
+	struct ObjAttributes {
+		std::vector<glm::vec3> positions;
+		std::vector<glm::vec3> colors; // The common "v x y z r g b" extension, white when absent
+		std::vector<glm::vec2> uvs;
+		std::vector<glm::vec3> normals;
+	};
+
+	const char* SkipSpaces(const char* cursor, const char* end) {
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+			++cursor;
+		}
+		return cursor;
+	}
+
+	// Moves cursor past the keyword and the whitespace after it
+	ObjLineType ClassifyLine(const char*& cursor, const char* end) {
+		cursor = SkipSpaces(cursor, end);
+		if (end - cursor < 2) {
+			return ObjLineType::Other;
+		}
+
+		const auto IsSpace = [](const char character) {
+			return character == ' ' || character == '\t';
+		};
+
+		ObjLineType type = ObjLineType::Other;
+		size_t      keywordLength = 1;
+		if (cursor[0] == 'v' && IsSpace(cursor[1])) {
+			type = ObjLineType::Position;
+		} else if (cursor[0] == 'f' && IsSpace(cursor[1])) {
+			type = ObjLineType::Face;
+		} else if (cursor[0] == 'v' && end - cursor >= 3 && IsSpace(cursor[2])) {
+			keywordLength = 2;
+			if (cursor[1] == 't') {
+				type = ObjLineType::UV;
+			} else if (cursor[1] == 'n') {
+				type = ObjLineType::Normal;
+			}
+		}
+
+		if (type != ObjLineType::Other) {
+			cursor = SkipSpaces(cursor + keywordLength, end);
+		}
+		return type;
+	}
+
+	// Calls function(lineBegin, lineEnd) for every line in [begin, end), line endings excluded
+	template <typename Function>
+	void ForEachLine(const char* begin, const char* end, Function&& function) {
+		while (begin < end) {
+			const char* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+			const char* lineEnd = newline != nullptr ? newline : end;
+			function(begin, lineEnd > begin && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd);
+			if (newline == nullptr) {
+				break;
+			}
+			begin = newline + 1;
+		}
+	}
+
+	// from_chars doesn't accept a leading '+', which some exporters write
+	bool ParseFloat(const char*& cursor, const char* end, float& out_value) {
+		cursor = SkipSpaces(cursor, end);
+		if (cursor < end && *cursor == '+') {
+			++cursor;
+		}
+		const std::from_chars_result result = std::from_chars(cursor, end, out_value);
+		if (result.ec != std::errc {}) {
+			return false;
+		}
+		cursor = result.ptr;
+		return true;
+	}
+
+	template <size_t Count>
+	size_t ParseFloats(const char* cursor, const char* end, std::array<float, Count>& out_values) {
+		size_t parsed = 0;
+		while (parsed < Count && ParseFloat(cursor, end, out_values[parsed])) {
+			++parsed;
+		}
+		return parsed;
+	}
+
+	// OBJ indices are 1-based, negative ones count back from the last element defined before the face.
+	// definedCount is how many elements precede the face in the file, totalCount how many the whole file has.
+	bool ResolveIndex(const int64_t index, const size_t definedCount, const size_t totalCount, int32_t& out_index) {
+		const int64_t resolved = index > 0 ? index - 1 : static_cast<int64_t>(definedCount) + index;
+		if (index == 0 || resolved < 0 || resolved >= static_cast<int64_t>(totalCount)) {
+			return false;
+		}
+		out_index = static_cast<int32_t>(resolved);
+		return true;
+	}
+
+	// Parses "p", "p/t", "p//n" or "p/t/n". Missing UV and normal indices stay OBJ_MISSING_INDEX.
+	bool ParseCorner(const char*& cursor, const char* end, const std::array<size_t, 3>& definedCounts, const std::array<size_t, 3>& totalCounts, ObjCorner& out_corner) {
+		std::array<int32_t, 3> indices { OBJ_MISSING_INDEX, OBJ_MISSING_INDEX, OBJ_MISSING_INDEX };
+		for (size_t attribute = 0; attribute < indices.size(); ++attribute) {
+			if (attribute > 0) {
+				if (cursor == end || *cursor != '/') {
+					break;
+				}
+				++cursor;
+				if (cursor < end && *cursor == '/') {
+					continue;
+				}
+			}
+
+			int64_t                      index = 0;
+			const std::from_chars_result result = std::from_chars(cursor, end, index);
+			if (result.ec != std::errc {}) {
+				// Only the position is mandatory, "p/" and "p//" are valid
+				if (attribute == 0) {
+					return false;
+				}
+				continue;
+			}
+			cursor = result.ptr;
+
+			if (!ResolveIndex(index, definedCounts[attribute], totalCounts[attribute], indices[attribute])) {
+				return false;
+			}
+		}
+
+		out_corner = ObjCorner { indices[0], indices[1], indices[2] };
+		return true;
+	}
+
+	void CountAttributes(ObjChunk& chunk) {
+		ForEachLine(chunk.begin, chunk.end, [&](const char* cursor, const char* lineEnd) {
+			switch (ClassifyLine(cursor, lineEnd)) {
+				case ObjLineType::Position:
+					++chunk.positionCount;
+					break;
+				case ObjLineType::UV:
+					++chunk.uvCount;
+					break;
+				case ObjLineType::Normal:
+					++chunk.normalCount;
+					break;
+				default:
+					break;
+			}
+		});
+	}
+
+	// Writes the chunk's attributes to its slots in attributes and triangulates its faces into chunk.triangleCorners
+	void ParseChunk(ObjChunk& chunk, ObjAttributes& attributes) {
+		const std::array<size_t, 3> totalCounts { attributes.positions.size(), attributes.uvs.size(), attributes.normals.size() };
+		std::array<size_t, 3>       definedCounts { chunk.firstPosition, chunk.firstUV, chunk.firstNormal };
+		std::vector<ObjCorner>      faceCorners;
+
+		ForEachLine(chunk.begin, chunk.end, [&](const char* cursor, const char* lineEnd) {
+			switch (ClassifyLine(cursor, lineEnd)) {
+				case ObjLineType::Position: {
+					// Four values are x y z w, six carry a color
+					std::array<float, 6> values { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+					const bool           bHasColor = ParseFloats(cursor, lineEnd, values) == values.size();
+					attributes.positions[definedCounts[0]] = glm::vec3 { values[0], values[1], values[2] };
+					attributes.colors[definedCounts[0]] = bHasColor ? glm::vec3 { values[3], values[4], values[5] } : glm::vec3 { 1.0f };
+					++definedCounts[0];
+					break;
+				}
+				case ObjLineType::UV: {
+					std::array<float, 2> values { 0.0f, 0.0f };
+					ParseFloats(cursor, lineEnd, values);
+					attributes.uvs[definedCounts[1]] = glm::vec2 { values[0], values[1] };
+					++definedCounts[1];
+					break;
+				}
+				case ObjLineType::Normal: {
+					std::array<float, 3> values { 0.0f, 0.0f, 1.0f };
+					ParseFloats(cursor, lineEnd, values);
+					attributes.normals[definedCounts[2]] = glm::vec3 { values[0], values[1], values[2] };
+					++definedCounts[2];
+					break;
+				}
+				case ObjLineType::Face: {
+					faceCorners.clear();
+					ObjCorner corner {};
+					while (cursor < lineEnd && ParseCorner(cursor, lineEnd, definedCounts, totalCounts, corner)) {
+						faceCorners.push_back(corner);
+						cursor = SkipSpaces(cursor, lineEnd);
+					}
+
+					// A corner that didn't parse leaves the cursor short of the line end, the face is dropped as a whole
+					if (cursor < lineEnd || faceCorners.size() < 3) {
+						++chunk.skippedFaces;
+						break;
+					}
+
+					// Fan triangulation, exact for the convex polygons OBJ exporters write
+					for (size_t fanCorner = 2; fanCorner < faceCorners.size(); ++fanCorner) {
+						chunk.triangleCorners.push_back(faceCorners[0]);
+						chunk.triangleCorners.push_back(faceCorners[fanCorner - 1]);
+						chunk.triangleCorners.push_back(faceCorners[fanCorner]);
+					}
+					break;
+				}
+				default:
+					break;
+			}
+		});
+	}
+
+	void DeduplicateChunk(ObjChunk& chunk) {
+		std::unordered_map<ObjCorner, uint32_t, ObjCornerHasher> localVertexByCorner;
+		localVertexByCorner.reserve(chunk.triangleCorners.size() / 4);
+		chunk.localIndices.reserve(chunk.triangleCorners.size());
+		for (const ObjCorner& corner : chunk.triangleCorners) {
+			auto [it, bInserted] = localVertexByCorner.try_emplace(corner, static_cast<uint32_t>(chunk.uniqueCorners.size()));
+			if (bInserted) {
+				chunk.uniqueCorners.push_back(corner);
+			}
+			chunk.localIndices.push_back(it->second);
+		}
+		chunk.triangleCorners = {};
+	}
+
+	// Line-aligned slices of the text, every chunk but the first starts right after a newline
+	std::vector<ObjChunk> SplitIntoChunks(const std::span<const std::byte> bytes, const size_t chunkCount) {
+		const char*           text = reinterpret_cast<const char*>(bytes.data());
+		const char*           textEnd = text + bytes.size();
+		std::vector<ObjChunk> chunks;
+		chunks.reserve(chunkCount);
+
+		const char* chunkBegin = text;
+		for (size_t chunkIndex = 1; chunkIndex <= chunkCount && chunkBegin < textEnd; ++chunkIndex) {
+			const char* chunkEnd = textEnd;
+			if (chunkIndex < chunkCount) {
+				chunkEnd = std::max(text + bytes.size() / chunkCount * chunkIndex, chunkBegin);
+				const char* newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', static_cast<size_t>(textEnd - chunkEnd)));
+				chunkEnd = newline != nullptr ? newline + 1 : textEnd;
+			}
+			ObjChunk& chunk = chunks.emplace_back();
+			chunk.begin = chunkBegin;
+			chunk.end = chunkEnd;
+			chunkBegin = chunkEnd;
+		}
+		return chunks;
+	}
+
+	// Area-weighted normals for the vertices whose corners named none
+	void GenerateMissingNormals(SourceSurface& surface, const std::vector<uint8_t>& bNeedsNormal) {
+		for (size_t corner = 0; corner + 3 <= surface.indices.size(); corner += 3) {
+			const glm::vec3& a = surface.vertices[surface.indices[corner + 0]].position;
+			const glm::vec3& b = surface.vertices[surface.indices[corner + 1]].position;
+			const glm::vec3& c = surface.vertices[surface.indices[corner + 2]].position;
+			const glm::vec3  faceNormal = glm::cross(b - a, c - a);
+			for (const uint32_t index : { surface.indices[corner + 0], surface.indices[corner + 1], surface.indices[corner + 2] }) {
+				if (bNeedsNormal[index]) {
+					surface.vertices[index].normal += faceNormal;
+				}
+			}
+		}
+
+		for (size_t index = 0; index < surface.vertices.size(); ++index) {
+			if (!bNeedsNormal[index]) {
+				continue;
+			}
+			const float length = glm::length(surface.vertices[index].normal);
+			surface.vertices[index].normal = length > 0.0f ? surface.vertices[index].normal / length : glm::vec3 { 0.0f, 0.0f, 1.0f };
+		}
+	}
+
+	CookedMaterial MakeDefaultMaterial() {
+		CookedMaterial material {};
+		material.constants.colorFactors = glm::vec4 { 1.0f };
+		material.constants.metalRoughFactors = glm::vec4 { 0.0f, 1.0f, 0.0f, 0.0f };
+		material.constants.emissiveFactors = glm::vec3 { 0.0f };
+		material.constants.emissiveStrength = 1.0f;
+		material.constants.specularFactor = 1.0f;
+		material.constants.alphaMode = 0;
+		material.passType = MaterialPass::Opaque;
+		material.bDoubleSided = false;
+		material.textureIndices.fill(-1);
+		return material;
+	}
+} // namespace
+
+std::optional<CookedScene> CookObj(const std::span<const std::byte> bytes, const std::string_view name, Pantomir::ThreadPool& threadPool, const bool bOptimizeMeshes) {
+	const size_t          maxChunkCount = static_cast<size_t>(threadPool.GetThreadCount() + 1) * OBJ_CHUNKS_PER_THREAD;
+	std::vector<ObjChunk> chunks = SplitIntoChunks(bytes, std::clamp<size_t>(bytes.size() / OBJ_MIN_CHUNK_SIZE, 1, maxChunkCount));
+
+	// First pass only counts, so the second can write every attribute straight to its final slot and resolve negative
+	// indices without waiting on the chunks before it
+	threadPool.ParallelFor(chunks.size(), [&](const size_t chunkIndex) {
+		CountAttributes(chunks[chunkIndex]);
+	});
+
+	size_t positionCount = 0;
+	size_t uvCount = 0;
+	size_t normalCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.firstPosition = positionCount;
+		chunk.firstUV = uvCount;
+		chunk.firstNormal = normalCount;
+		positionCount += chunk.positionCount;
+		uvCount += chunk.uvCount;
+		normalCount += chunk.normalCount;
+	}
+
+	ObjAttributes attributes;
+	attributes.positions.resize(positionCount);
+	attributes.colors.resize(positionCount);
+	attributes.uvs.resize(uvCount);
+	attributes.normals.resize(normalCount);
+	threadPool.ParallelFor(chunks.size(), [&](const size_t chunkIndex) {
+		ParseChunk(chunks[chunkIndex], attributes);
+		DeduplicateChunk(chunks[chunkIndex]);
+	});
+
+	size_t cornerCount = 0;
+	size_t skippedFaces = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.firstIndex = cornerCount;
+		cornerCount += chunk.localIndices.size();
+		skippedFaces += chunk.skippedFaces;
+	}
+	if (skippedFaces > 0) {
+		LOG(Engine, Warning, "Skipped {} malformed faces in OBJ '{}'", skippedFaces, name);
+	}
+	if (cornerCount == 0) {
+		LOG(Engine, Error, "OBJ '{}' has no faces", name);
+		return std::nullopt;
+	}
+
+	// Every distinct corner becomes one vertex. Chunks merge in file order, so vertices come out in order of first use
+	// no matter how the text was chunked.
+	SourceSurface                                            surface {};
+	std::unordered_map<ObjCorner, uint32_t, ObjCornerHasher> vertexByCorner;
+	std::vector<uint8_t>                                     bNeedsNormal;
+	vertexByCorner.reserve(positionCount);
+	surface.vertices.reserve(positionCount);
+	for (ObjChunk& chunk : chunks) {
+		chunk.vertexByUnique.reserve(chunk.uniqueCorners.size());
+		for (const ObjCorner& corner : chunk.uniqueCorners) {
+			auto [it, bInserted] = vertexByCorner.try_emplace(corner, static_cast<uint32_t>(surface.vertices.size()));
+			if (bInserted) {
+				Vertex newVertex {};
+				newVertex.position = attributes.positions[corner.position];
+				newVertex.color = glm::vec4 { attributes.colors[corner.position], 1.0f };
+				newVertex.normal = corner.normal != OBJ_MISSING_INDEX ? attributes.normals[corner.normal] : glm::vec3 { 0.0f };
+				if (corner.uv != OBJ_MISSING_INDEX) {
+					// OBJ puts the UV origin at the bottom left, glTF and Vulkan at the top left
+					newVertex.uv_x = attributes.uvs[corner.uv].x;
+					newVertex.uv_y = 1.0f - attributes.uvs[corner.uv].y;
+				}
+				surface.vertices.push_back(newVertex);
+				bNeedsNormal.push_back(corner.normal == OBJ_MISSING_INDEX ? 1 : 0);
+			}
+			chunk.vertexByUnique.push_back(it->second);
+		}
+	}
+
+	surface.indices.resize(cornerCount);
+	threadPool.ParallelFor(chunks.size(), [&](const size_t chunkIndex) {
+		const ObjChunk& chunk = chunks[chunkIndex];
+		for (size_t corner = 0; corner < chunk.localIndices.size(); ++corner) {
+			surface.indices[chunk.firstIndex + corner] = chunk.vertexByUnique[chunk.localIndices[corner]];
+		}
+	});
+
+	if (std::ranges::find(bNeedsNormal, 1) != bNeedsNormal.end()) {
+		GenerateMissingNormals(surface, bNeedsNormal);
+	}
+
+	LOG(Engine, Info, "Parsed OBJ '{}': {} positions, {} triangles, {} unique vertices across {} chunks",
+	    name, positionCount, cornerCount / 3, surface.vertices.size(), chunks.size());
+
+	CookedScene    scene {};
+	CookedMaterial material = MakeDefaultMaterial();
+	material.name = scene.AddName(name);
+	scene.materials.push_back(material);
+
+	CookMesh(name, std::span(&surface, 1), bOptimizeMeshes, scene);
+
+	CookedNode node {};
+	node.localTransform = glm::mat4 { 1.0f };
+	node.meshIndex = 0;
+	node.name = scene.AddName(name);
+	scene.nodes.push_back(node);
+
+	return scene;
+}
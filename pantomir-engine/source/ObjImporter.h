@@ -0,0 +1,20 @@
+#ifndef OBJIMPORTER_H_
+#define OBJIMPORTER_H_
+
+#include "MeshCache.h"
+
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace Pantomir {
+	class ThreadPool;
+} // namespace Pantomir
+
+// Wavefront OBJ text straight to the cooked representation, so OBJ files load through the same mesh cache and upload
+// path as glTF. The text is cut into line-aligned chunks that are parsed across the pool. Faces are fan-triangulated
+// and every distinct position/UV/normal triple becomes one vertex. Groups, objects and .mtl materials are ignored, the
+// whole file becomes one mesh with one surface and a default material. Returns nullopt when the file has no faces.
+std::optional<CookedScene> CookObj(std::span<const std::byte> bytes, std::string_view name, Pantomir::ThreadPool& threadPool, bool bOptimizeMeshes);
+
+#endif /*! OBJIMPORTER_H_ */
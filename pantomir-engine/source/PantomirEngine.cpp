@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <cstddef>
+#include <ranges>
 #include <thread>
 
 #include <VkBootstrap.h>
@@ -17,7 +18,9 @@
 #include "VkDescriptors.h"
 #include "VkImages.h"
 #include "VkInitializers.h"
+#include "PipelineCache.h"
 #include "VkPipelines.h"
+#include "TextureCache.h"
 
 #include "VkLoader.h"
 #include "imgui.h"
@@ -32,6 +35,56 @@
 #include "PantomirFunctionLibrary.h"
 #include "VkPushConstants.h"
 
+void GLTFMetallic_Roughness::InitMaterialTable(PantomirEngine* engine) {
+	const VkDevice          device = engine->_logicalGPU;
+	_enginePtr = engine;
+
+	// Textures are written while frames that bind the set are still in flight, each to a slot none of them samples
+	DescriptorLayoutBuilder descriptorLayoutBuilder;
+	descriptorLayoutBuilder.AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	descriptorLayoutBuilder.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_BINDLESS_TEXTURES);
+
+	const VkDescriptorBindingFlags              bindingFlags[] = { 0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT };
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = { .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+	bindingFlagsInfo.bindingCount = static_cast<uint32_t>(std::size(bindingFlags));
+	bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+	_materialDescriptorSetLayout = descriptorLayoutBuilder.Build(device, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, &bindingFlagsInfo, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT);
+
+	const VkDescriptorPoolSize poolSizes[] = {
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_BINDLESS_TEXTURES }
+	};
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = { .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+	poolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolCreateInfo.maxSets = 1;
+	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(std::size(poolSizes));
+	poolCreateInfo.pPoolSizes = poolSizes;
+	VK_CHECK(vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &_bindlessDescriptorPool));
+
+	VkDescriptorSetAllocateInfo allocateInfo = { .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+	allocateInfo.descriptorPool = _bindlessDescriptorPool;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts = &_materialDescriptorSetLayout;
+	VK_CHECK(vkAllocateDescriptorSets(device, &allocateInfo, &_bindlessDescriptorSet));
+
+	// Written in place as materials load and as their textures stream in
+	_materialBuffer = engine->CreateBuffer(sizeof(GPUMaterial) * MAX_MATERIALS, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+	_gpuMaterials = static_cast<GPUMaterial*>(_materialBuffer.info.pMappedData);
+	_materials.reserve(MAX_MATERIALS);
+
+	_writer.Clear();
+	_writer.WriteBuffer(0, _materialBuffer.buffer, sizeof(GPUMaterial) * MAX_MATERIALS, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	_writer.UpdateSet(device, _bindlessDescriptorSet);
+}
+
+void GLTFMetallic_Roughness::ClearMaterialTable(PantomirEngine* engine) {
+	vkDestroyDescriptorPool(engine->_logicalGPU, _bindlessDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(engine->_logicalGPU, _materialDescriptorSetLayout, nullptr);
+	engine->DestroyBuffer(_materialBuffer);
+}
+
 void GLTFMetallic_Roughness::BuildPipelines(PantomirEngine* engine) {
 	VkShaderModule meshVertexShader;
 	if (!vkutil::LoadShaderModule("Assets/Shaders/mesh.vert.spv", engine->_logicalGPU, &meshVertexShader)) {
@@ -43,21 +96,16 @@ void GLTFMetallic_Roughness::BuildPipelines(PantomirEngine* engine) {
 		LOG(Engine, Error, "Error when building the triangle fragment shader module");
 	}
 
+	VkShaderModule meshIndirectVertexShader;
+	if (!vkutil::LoadShaderModule("Assets/Shaders/mesh_indirect.vert.spv", engine->_logicalGPU, &meshIndirectVertexShader)) {
+		LOG(Engine, Error, "Error when building the indirect triangle vertex shader module");
+	}
+
 	VkPushConstantRange matrixRange {};
 	matrixRange.offset = 0;
 	matrixRange.size = sizeof(GPUDrawPushConstants);
 	matrixRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 
-	DescriptorLayoutBuilder descriptorLayoutBuilder;
-	descriptorLayoutBuilder.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-	descriptorLayoutBuilder.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-	descriptorLayoutBuilder.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-	descriptorLayoutBuilder.AddBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-	descriptorLayoutBuilder.AddBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-	descriptorLayoutBuilder.AddBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-
-	_materialDescriptorSetLayout = descriptorLayoutBuilder.Build(engine->_logicalGPU, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT); // Every binding will be used in the vertex and frag shader.
-
 	VkDescriptorSetLayout layouts[] = {
 		engine->_gpuSceneDataDescriptorSetLayout,
 		_materialDescriptorSetLayout
@@ -80,7 +128,9 @@ void GLTFMetallic_Roughness::BuildPipelines(PantomirEngine* engine) {
 	pipelineBuilder.SetInputTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
 	pipelineBuilder.SetPolygonMode(VK_POLYGON_MODE_FILL);
 	// If the determinant is a positive value, the winding order triangle faces is counterclockwise; in the opposite case, the winding order is clockwise. https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html
+	// The cull mode is only a default, each material sets its own while drawing.
 	pipelineBuilder.SetCullMode(VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE);
+	pipelineBuilder.AddDynamicState(VK_DYNAMIC_STATE_CULL_MODE);
 	pipelineBuilder.SetMultisamplingNone();
 	pipelineBuilder.DisableBlending();
 	pipelineBuilder.EnableDepthtest(true, VK_COMPARE_OP_GREATER_OR_EQUAL);
@@ -90,89 +140,144 @@ void GLTFMetallic_Roughness::BuildPipelines(PantomirEngine* engine) {
 	_opaquePipeline.layout = _pipelineLayout;
 	_transparentPipeline.layout = _pipelineLayout;
 	_maskedPipeline.layout = _pipelineLayout;
-	_opaqueDoubleSidedPipeline.layout = _pipelineLayout;
-	_transparentDoubleSidedPipeline.layout = _pipelineLayout;
-	_maskedDoubleSidedPipeline.layout = _pipelineLayout;
 
 	// Building Pipelines
-	_opaquePipeline.pipeline = pipelineBuilder.BuildPipeline(engine->_logicalGPU);
-
-	pipelineBuilder.SetCullMode(VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE);
-	_opaqueDoubleSidedPipeline.pipeline = pipelineBuilder.BuildPipeline(engine->_logicalGPU);
+	_pipelineBuilds.Build(engine->_threadPool, engine->_logicalGPU, engine->_pipelineCache, pipelineBuilder, &_opaquePipeline.pipeline);
 
-	pipelineBuilder.SetCullMode(VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE);
 	pipelineBuilder.EnableBlendingAlphablend();
 	pipelineBuilder.EnableDepthtest(false, VK_COMPARE_OP_GREATER_OR_EQUAL);
-	_transparentPipeline.pipeline = pipelineBuilder.BuildPipeline(engine->_logicalGPU);
+	_pipelineBuilds.Build(engine->_threadPool, engine->_logicalGPU, engine->_pipelineCache, pipelineBuilder, &_transparentPipeline.pipeline);
 
-	pipelineBuilder.SetCullMode(VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE);
-	_transparentDoubleSidedPipeline.pipeline = pipelineBuilder.BuildPipeline(engine->_logicalGPU);
-
-	pipelineBuilder.SetCullMode(VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE);
 	pipelineBuilder.DisableBlending();
 	pipelineBuilder.EnableDepthtest(true, VK_COMPARE_OP_GREATER_OR_EQUAL);
-	_maskedPipeline.pipeline = pipelineBuilder.BuildPipeline(engine->_logicalGPU);
-
-	pipelineBuilder.SetCullMode(VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE);
-	_maskedDoubleSidedPipeline.pipeline = pipelineBuilder.BuildPipeline(engine->_logicalGPU);
-
-	vkDestroyShaderModule(engine->_logicalGPU, meshFragShader, nullptr);
-	vkDestroyShaderModule(engine->_logicalGPU, meshVertexShader, nullptr);
+	_pipelineBuilds.Build(engine->_threadPool, engine->_logicalGPU, engine->_pipelineCache, pipelineBuilder, &_maskedPipeline.pipeline);
+
+	// Indirect twins of the opaque and masked pipelines, for draws batched into indirect commands. Transparent surfaces
+	// are sorted back to front and always draw one by one.
+	pipelineBuilder.SetShaders(meshIndirectVertexShader, meshFragShader);
+	_pipelineBuilds.Build(engine->_threadPool, engine->_logicalGPU, engine->_pipelineCache, pipelineBuilder, &_opaquePipeline.indirectPipeline);
+	_pipelineBuilds.Build(engine->_threadPool, engine->_logicalGPU, engine->_pipelineCache, pipelineBuilder, &_maskedPipeline.indirectPipeline);
+	_transparentPipeline.indirectPipeline = VK_NULL_HANDLE;
+
+	_pipelineBuilds.AddShaderModule(meshFragShader);
+	_pipelineBuilds.AddShaderModule(meshVertexShader);
+	_pipelineBuilds.AddShaderModule(meshIndirectVertexShader);
 }
 
-void GLTFMetallic_Roughness::ClearResources(const VkDevice device) const {
+void GLTFMetallic_Roughness::ClearResources(const VkDevice device) {
+	_pipelineBuilds.Wait(device);
+
+	vkDestroyPipeline(device, _maskedPipeline.indirectPipeline, nullptr);
+	vkDestroyPipeline(device, _opaquePipeline.indirectPipeline, nullptr);
 	vkDestroyPipeline(device, _maskedPipeline.pipeline, nullptr);
 	vkDestroyPipeline(device, _transparentPipeline.pipeline, nullptr);
 	vkDestroyPipeline(device, _opaquePipeline.pipeline, nullptr);
-	vkDestroyPipeline(device, _maskedDoubleSidedPipeline.pipeline, nullptr);
-	vkDestroyPipeline(device, _transparentDoubleSidedPipeline.pipeline, nullptr);
-	vkDestroyPipeline(device, _opaqueDoubleSidedPipeline.pipeline, nullptr);
 
 	vkDestroyPipelineLayout(device, _pipelineLayout, nullptr);
-	vkDestroyDescriptorSetLayout(device, _materialDescriptorSetLayout, nullptr);
 }
 
-MaterialInstance GLTFMetallic_Roughness::WriteMaterial(const VkDevice device, const MaterialPass passType, VkCullModeFlagBits cullMode, const GLTFMetallic_Roughness::MaterialResources& resources, DescriptorPoolManager& descriptorPoolManager) {
+uint32_t GLTFMetallic_Roughness::AllocateMaterial() {
+	if (!_freeMaterialIndices.empty()) {
+		const uint32_t materialIndex = _freeMaterialIndices.back();
+		_freeMaterialIndices.pop_back();
+		return materialIndex;
+	}
+
+	if (_materials.size() == MAX_MATERIALS) {
+		LOG(Engine, Error, "Out of material slots, raise MAX_MATERIALS above {}", MAX_MATERIALS);
+		abort();
+	}
+
+	// Texture indices stay invalid until WriteMaterial, so there is nothing to release yet
+	GPUMaterial& material = _materials.emplace_back();
+	material.colorTexture = material.metalRoughTexture = material.emissiveTexture = material.normalTexture = material.specularTexture = UINT32_MAX;
+	return static_cast<uint32_t>(_materials.size() - 1);
+}
+
+void GLTFMetallic_Roughness::FreeMaterial(const uint32_t materialIndex) {
+	GPUMaterial& material = _materials[materialIndex];
+	for (uint32_t* textureIndex : { &material.colorTexture, &material.metalRoughTexture, &material.emissiveTexture, &material.normalTexture, &material.specularTexture }) {
+		ReleaseTexture(*textureIndex);
+		*textureIndex = UINT32_MAX;
+	}
+	_freeMaterialIndices.push_back(materialIndex);
+}
+
+uint32_t GLTFMetallic_Roughness::AcquireTexture(const VkDevice device, const VkImageView imageView, const VkSampler sampler) {
+	if (const auto textureIt = _textureIndexByView.find({ imageView, sampler }); textureIt != _textureIndexByView.end()) {
+		++_textures[textureIt->second].refCount;
+		return textureIt->second;
+	}
+
+	uint32_t textureIndex;
+	if (!_freeTextureIndices.empty()) {
+		textureIndex = _freeTextureIndices.back();
+		_freeTextureIndices.pop_back();
+	} else if (_textures.size() < MAX_BINDLESS_TEXTURES) {
+		textureIndex = static_cast<uint32_t>(_textures.size());
+		_textures.emplace_back();
+	} else {
+		LOG(Engine, Error, "Out of bindless texture slots, raise MAX_BINDLESS_TEXTURES above {}", MAX_BINDLESS_TEXTURES);
+		abort();
+	}
+
+	_textures[textureIndex] = BindlessTexture { .imageView = imageView, .sampler = sampler, .refCount = 1 };
+	_textureIndexByView.emplace(std::pair { imageView, sampler }, textureIndex);
+
+	_writer.Clear();
+	_writer.WriteImage(1, imageView, sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureIndex);
+	_writer.UpdateSet(device, _bindlessDescriptorSet);
+	return textureIndex;
+}
+
+void GLTFMetallic_Roughness::ReleaseTexture(const uint32_t textureIndex) {
+	if (textureIndex == UINT32_MAX) {
+		return;
+	}
+
+	BindlessTexture& texture = _textures[textureIndex];
+	if (--texture.refCount > 0) {
+		return;
+	}
+
+	// The stale descriptor stays in the array, partially bound descriptors are fine as long as nothing samples them.
+	// Frames in flight may still sample it though, so the slot is only rewritten once this frame comes around again.
+	_textureIndexByView.erase({ texture.imageView, texture.sampler });
+	_enginePtr->GetCurrentFrame().deletionQueue.PushFunction([this, textureIndex]() {
+		_freeTextureIndices.push_back(textureIndex);
+	});
+}
+
+MaterialInstance GLTFMetallic_Roughness::WriteMaterial(const VkDevice device, const MaterialPass passType, const VkCullModeFlagBits cullMode, const GLTFMetallic_Roughness::MaterialResources& resources, const uint32_t materialIndex) {
 	MaterialInstance materialInstance {};
 
 	materialInstance.passType = passType;
 	materialInstance.cullMode = cullMode;
+	materialInstance.materialIndex = materialIndex;
 
-	// Per material, we choose a pipeline based on its properties.
+	// Per material, we choose a pipeline based on its pass. The cull mode is applied while drawing.
 	if (passType == MaterialPass::AlphaBlend) {
-		if (cullMode == VK_CULL_MODE_NONE) {
-			materialInstance.pipeline = &_transparentDoubleSidedPipeline;
-		} else {
-			materialInstance.pipeline = &_transparentPipeline;
-		}
+		materialInstance.pipeline = &_transparentPipeline;
 	} else if (passType == MaterialPass::AlphaMask) {
-		if (cullMode == VK_CULL_MODE_NONE) {
-			materialInstance.pipeline = &_maskedDoubleSidedPipeline;
-		} else {
-			materialInstance.pipeline = &_maskedPipeline;
-		}
-	} else if (passType == MaterialPass::Opaque) {
-		if (cullMode == VK_CULL_MODE_NONE) {
-			materialInstance.pipeline = &_opaqueDoubleSidedPipeline;
-		} else {
-			materialInstance.pipeline = &_opaquePipeline;
-		}
+		materialInstance.pipeline = &_maskedPipeline;
 	} else {
 		materialInstance.pipeline = &_opaquePipeline;
 	}
 
-	materialInstance.descriptorSet = descriptorPoolManager.Allocate(device, _materialDescriptorSetLayout);
-
-	_writer.Clear();
-	_writer.WriteBuffer(0, resources.dataBuffer, sizeof(MaterialConstants), resources.dataBufferOffset, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
-	_writer.WriteImage(1, resources.colorImage.imageView, resources.colorSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-	_writer.WriteImage(2, resources.metalRoughImage.imageView, resources.metalRoughSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-	_writer.WriteImage(3, resources.emissiveImage.imageView, resources.emissiveSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-	_writer.WriteImage(4, resources.normalImage.imageView, resources.normalSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-	_writer.WriteImage(5, resources.specularImage.imageView, resources.specularSampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-
-	_writer.UpdateSet(device, materialInstance.descriptorSet);
+	// Acquire the new textures before releasing the old ones, so a texture the material keeps never drops to zero
+	const GPUMaterial previous = _materials[materialIndex];
+	GPUMaterial&      material = _materials[materialIndex];
+	material.constants = resources.constants;
+	material.colorTexture = AcquireTexture(device, resources.colorImage.imageView, resources.colorSampler);
+	material.metalRoughTexture = AcquireTexture(device, resources.metalRoughImage.imageView, resources.metalRoughSampler);
+	material.emissiveTexture = AcquireTexture(device, resources.emissiveImage.imageView, resources.emissiveSampler);
+	material.normalTexture = AcquireTexture(device, resources.normalImage.imageView, resources.normalSampler);
+	material.specularTexture = AcquireTexture(device, resources.specularImage.imageView, resources.specularSampler);
+	for (const uint32_t textureIndex : { previous.colorTexture, previous.metalRoughTexture, previous.emissiveTexture, previous.normalTexture, previous.specularTexture }) {
+		ReleaseTexture(textureIndex);
+	}
 
+	_gpuMaterials[materialIndex] = material;
 	return materialInstance;
 }
 
@@ -183,11 +288,20 @@ void MeshNode::FillDrawContext(const glm::mat4& topMatrix, DrawContext& drawCont
 		RenderObject renderObject {};
 		renderObject.indexCount = geoSurface.count;
 		renderObject.firstIndex = geoSurface.startIndex;
+		renderObject.vertexOffset = geoSurface.vertexOffset;
 		renderObject.indexBuffer = _mesh->meshBuffers.indexBuffer.buffer;
+		renderObject.indexBufferOffset = _mesh->indexType == VK_INDEX_TYPE_UINT16 ? 0 : _mesh->meshBuffers.index32Offset;
+		renderObject.indexType = _mesh->indexType;
 		renderObject.material = &geoSurface.material->data;
 		renderObject.bounds = geoSurface.bounds;
 		renderObject.transform = nodeMatrix;
 		renderObject.vertexBufferAddress = _mesh->meshBuffers.vertexBufferAddress;
+		renderObject.positionOffset = _mesh->positionOffset;
+		renderObject.positionScale = _mesh->positionScale;
+		renderObject.meshlets = _mesh->meshlets.subspan(geoSurface.firstMeshlet, geoSurface.meshletCount);
+		renderObject.firstMeshlet = geoSurface.firstMeshlet;
+		renderObject.meshletBufferAddress = _mesh->meshletBufferAddress;
+		renderObject.lods = std::span(_mesh->lods).subspan(geoSurface.firstLOD, geoSurface.lodCount);
 
 		if (geoSurface.material->data.passType == MaterialPass::AlphaBlend) {
 			drawContext.transparentSurfaces.push_back(renderObject);
@@ -238,11 +352,20 @@ void PantomirEngine::Draw_HUD_HDRI(std::unordered_map<std::string, std::shared_p
 	if (ImGui::Begin("HDRI Selector")) {
 		static std::string currentName;
 		if (ImGui::BeginCombo("HDRI", currentName.c_str())) {
-			for (auto& [name, hdri] : loadedHDRIs) {
+			for (const auto& [name, path] : _hdriPaths) {
 				bool isSelected = (currentName == name);
 				if (ImGui::Selectable(name.c_str(), isSelected)) {
-					currentName = name;
-					currentHDRI = hdri;
+					// Environment maps are large, only the ones actually picked are loaded
+					auto hdriIt = loadedHDRIs.find(name);
+					if (hdriIt == loadedHDRIs.end()) {
+						if (std::optional<std::shared_ptr<LoadedHDRI>> hdriFile = LoadHDRI(this, path); hdriFile.has_value()) {
+							hdriIt = loadedHDRIs.emplace(name, *hdriFile).first;
+						}
+					}
+					if (hdriIt != loadedHDRIs.end()) {
+						currentName = name;
+						currentHDRI = hdriIt->second;
+					}
 				}
 				if (isSelected)
 					ImGui::SetItemDefaultFocus();
@@ -258,8 +381,30 @@ void PantomirEngine::Draw_HUD_Stats(EngineStats& stats) {
 	ImGui::Text("frametime %f ms", stats.frameTime);
 	ImGui::Text("draw time %f ms", stats.meshDrawTime);
 	ImGui::Text("update time %f ms", stats.sceneUpdateTime);
-	ImGui::Text("triangles %i", stats.triangleCount);
+	if (stats.bGPUDriven) {
+		ImGui::Text("triangles %i (transparent only, the GPU culls the rest)", stats.triangleCount);
+	} else {
+		ImGui::Text("triangles %i", stats.triangleCount);
+	}
 	ImGui::Text("draws %i", stats.drawcallCount);
+	ImGui::Text("texture decode %f ms wall / %f ms cpu", stats.textureDecodeWallTime, stats.textureDecodeCpuTime);
+	ImGui::Text("time to first frame %f ms", stats.timeToFirstFrame);
+	if (stats.bGPUDriven) {
+		ImGui::Text("LOD draws unavailable, picked on the GPU");
+	} else {
+		for (size_t level = 0; level < stats.lodDrawCounts.size(); ++level) {
+			ImGui::Text("LOD %zu draws %i", level, stats.lodDrawCounts[level]);
+		}
+	}
+	ImGui::SliderFloat("LOD screen size", &_lodScreenSizeThreshold, 0.01f, 1.f, "%.2f", ImGuiSliderFlags_AlwaysClamp);
+	ImGui::Checkbox("Cluster culling", &_bClusterCulling);
+	ImGui::BeginDisabled(!_bMultiDrawIndirect);
+	ImGui::Checkbox("Batch draws", &_bBatchDraws);
+	ImGui::EndDisabled();
+	ImGui::BeginDisabled(!_bDrawIndirectCount);
+	ImGui::Checkbox("GPU cluster culling", &_bGPUClusterCulling);
+	ImGui::Checkbox("GPU-driven rendering", &_bGPUDrivenRendering);
+	ImGui::EndDisabled();
 	ImGui::End();
 }
 
@@ -352,9 +497,11 @@ void PantomirEngine::ImmediateSubmit(std::function<void(VkCommandBuffer commandB
 	VK_CHECK(vkWaitForFences(_logicalGPU, 1, &_immediateFence, true, 9999999999));
 }
 
-GPUMeshBuffers PantomirEngine::UploadMesh(const std::span<uint32_t> indices, const std::span<Vertex> vertices) const {
-	const size_t   vertexBufferSize = vertices.size() * sizeof(Vertex);
-	const size_t   indexBufferSize = indices.size() * sizeof(uint32_t);
+GPUMeshBuffers PantomirEngine::UploadMesh(const std::span<const uint16_t> indices16, const std::span<const uint32_t> indices32, const std::span<const PackedVertex> vertices) {
+	const size_t   vertexBufferSize = vertices.size() * sizeof(PackedVertex);
+	const size_t   index16Size = indices16.size() * sizeof(uint16_t);
+	const size_t   index32Offset = (index16Size + sizeof(uint32_t) - 1) / sizeof(uint32_t) * sizeof(uint32_t); // Bind offsets must be aligned to the index size
+	const size_t   indexBufferSize = index32Offset + indices32.size() * sizeof(uint32_t);
 
 	GPUMeshBuffers newSurface {};
 
@@ -362,36 +509,20 @@ GPUMeshBuffers PantomirEngine::UploadMesh(const std::span<uint32_t> indices, con
 	newSurface.vertexBuffer = CreateBuffer(vertexBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
 
 	// Find the address of the vertex buffer on the GPU
-	const VkBufferDeviceAddressInfo deviceAddressInfo { .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO, .buffer = newSurface.vertexBuffer.buffer };
-	newSurface.vertexBufferAddress = vkGetBufferDeviceAddress(_logicalGPU, &deviceAddressInfo);
+	newSurface.vertexBufferAddress = GetBufferDeviceAddress(newSurface.vertexBuffer);
 
 	// Create index buffer
 	newSurface.indexBuffer = CreateBuffer(indexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+	newSurface.index32Offset = index32Offset;
 
-	const AllocatedBuffer stagingBuffer = CreateBuffer(vertexBufferSize + indexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
-	void*                 data = stagingBuffer.allocation->GetMappedData();
-
-	// Copy vertex buffer
-	memcpy(data, vertices.data(), vertexBufferSize);
-	// Copy index buffer
-	memcpy(static_cast<char*>(data) + vertexBufferSize, indices.data(), indexBufferSize);
-
-	ImmediateSubmit([&](VkCommandBuffer commandBuffer) {
-		VkBufferCopy vertexCopy { 0 };
-		vertexCopy.dstOffset = 0;
-		vertexCopy.srcOffset = 0;
-		vertexCopy.size = vertexBufferSize;
-
-		vkCmdCopyBuffer(commandBuffer, stagingBuffer.buffer, newSurface.vertexBuffer.buffer, 1, &vertexCopy);
-
-		VkBufferCopy indexCopy { 0 };
-		indexCopy.dstOffset = 0;
-		indexCopy.srcOffset = vertexBufferSize;
-		indexCopy.size = indexBufferSize;
-
-		vkCmdCopyBuffer(commandBuffer, stagingBuffer.buffer, newSurface.indexBuffer.buffer, 1, &indexCopy); });
-
-	DestroyBuffer(stagingBuffer);
+	// The copies are only recorded here, the buffers are usable once the batch they landed in is submitted and completes.
+	_uploadBatcher.EnqueueBufferUpload(newSurface.vertexBuffer.buffer, vertices.data(), vertexBufferSize);
+	if (!indices16.empty()) {
+		_uploadBatcher.EnqueueBufferUpload(newSurface.indexBuffer.buffer, indices16.data(), index16Size);
+	}
+	if (!indices32.empty()) {
+		_uploadBatcher.EnqueueBufferUpload(newSurface.indexBuffer.buffer, indices32.data(), indices32.size() * sizeof(uint32_t), index32Offset);
+	}
 
 	return newSurface;
 }
@@ -404,19 +535,16 @@ glm::mat4 PantomirEngine::GetProjectionMatrix() const {
 	return projection;
 }
 
-AllocatedImage PantomirEngine::CreateImage(void* dataSource, const VkExtent3D size, const VkFormat format, const VkImageUsageFlags usage, const bool mipmapped) const {
-	const size_t          dataSize = static_cast<size_t>(size.width * size.height * size.depth) * PantomirFunctionLibrary::BytesPerPixelFromFormat(format);
-	const AllocatedBuffer stagingBuffer = CreateBuffer(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU); // Transfer src bit means it's usable by GPU for copying.
-	memcpy(stagingBuffer.info.pMappedData, dataSource, dataSize);
-
-	// Vulkan doesn't allow us to send pixel data straight to an image, it has to be sent to a buffer first.
+AllocatedImage PantomirEngine::AllocateImage(const VkExtent3D size, const VkFormat format, const VkImageUsageFlags usage, const uint32_t mipLevels, const bool bCubemap) const {
 	AllocatedImage newImage {};
 	newImage.imageFormat = format;
 	newImage.imageExtent = size;
 
 	VkImageCreateInfo imageCreateInfo = vkinit::ImageCreateInfo(format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, size);
-	if (mipmapped) {
-		imageCreateInfo.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(size.width, size.height)))) + 1;
+	imageCreateInfo.mipLevels = mipLevels;
+	if (bCubemap) {
+		imageCreateInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+		imageCreateInfo.arrayLayers = CUBEMAP_FACE_COUNT;
 	}
 
 	VmaAllocationCreateInfo vmaAllocationCreateInfo {};
@@ -432,27 +560,32 @@ AllocatedImage PantomirEngine::CreateImage(void* dataSource, const VkExtent3D si
 
 	VkImageViewCreateInfo viewInfo = vkinit::ImageViewCreateInfo(format, newImage.image, aspectFlag);
 	viewInfo.subresourceRange.levelCount = imageCreateInfo.mipLevels;
+	if (bCubemap) {
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_CUBE;
+		viewInfo.subresourceRange.layerCount = CUBEMAP_FACE_COUNT;
+	}
 
 	VK_CHECK(vkCreateImageView(_logicalGPU, &viewInfo, nullptr, &newImage.imageView));
 
-	ImmediateSubmit([&](const VkCommandBuffer commandBuffer) {
-		VkBufferImageCopy copyRegion = {};
-		copyRegion.bufferOffset = 0;
-		copyRegion.bufferRowLength = newImage.imageExtent.width;
-		copyRegion.bufferImageHeight = newImage.imageExtent.height;
+	return newImage;
+}
+
+AllocatedImage PantomirEngine::CreateImage(void* dataSource, const VkExtent3D size, const VkFormat format, const VkImageUsageFlags usage, const bool mipmapped) {
+	const size_t dataSize = PantomirFunctionLibrary::ImageSizeFromFormat(format, size);
+
+	// Vulkan doesn't allow us to send pixel data straight to an image, it has to be sent to a buffer first.
+	const uint32_t       mipLevels = mipmapped ? static_cast<uint32_t>(std::floor(std::log2(std::max(size.width, size.height)))) + 1 : 1;
+	const AllocatedImage newImage = AllocateImage(size, format, usage, mipLevels);
+
+	_uploadBatcher.EnqueueImageUpload(newImage, dataSource, dataSize, mipmapped);
 
-		copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		copyRegion.imageSubresource.mipLevel = 0;
-		copyRegion.imageSubresource.baseArrayLayer = 0;
-		copyRegion.imageSubresource.layerCount = 1;
-		copyRegion.imageExtent = size;
+	return newImage;
+}
 
-		vkutil::TransitionImage(commandBuffer, newImage.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer.buffer, newImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-		mipmapped ? vkutil::GenerateMipmaps(commandBuffer, newImage.image, VkExtent2D { newImage.imageExtent.width, newImage.imageExtent.height })
-		          : vkutil::TransitionImage(commandBuffer, newImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL); });
+AllocatedImage PantomirEngine::CreateImage(const MipmappedTexture& texture, const VkImageUsageFlags usage) {
+	const AllocatedImage newImage = AllocateImage(texture.extent, texture.format, usage, static_cast<uint32_t>(texture.mipRegions.size()), texture.bCubemap);
 
-	DestroyBuffer(stagingBuffer);
+	_uploadBatcher.EnqueueImageUpload(newImage, texture.pixels, texture.mipRegions);
 
 	return newImage;
 }
@@ -482,6 +615,11 @@ void PantomirEngine::DestroyBuffer(const AllocatedBuffer& buffer) const {
 	vmaDestroyBuffer(_vmaAllocator, buffer.buffer, buffer.allocation);
 }
 
+VkDeviceAddress PantomirEngine::GetBufferDeviceAddress(const AllocatedBuffer& buffer) const {
+	const VkBufferDeviceAddressInfo deviceAddressInfo { .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO, .buffer = buffer.buffer };
+	return vkGetBufferDeviceAddress(_logicalGPU, &deviceAddressInfo);
+}
+
 PantomirEngine::PantomirEngine() {
 	InitSDLWindow();
 	InitVulkan();
@@ -496,7 +634,8 @@ PantomirEngine::PantomirEngine() {
 }
 
 PantomirEngine::~PantomirEngine() {
-	// Make sure the GPU has stopped doing work
+	// Make sure no worker is still touching engine resources, then that the GPU has stopped doing work
+	_threadPool.WaitIdle();
 	vkDeviceWaitIdle(_logicalGPU);
 
 	_loadedScenes.clear();
@@ -574,6 +713,12 @@ void PantomirEngine::InitVulkan() {
 	VkPhysicalDeviceVulkan12Features features_12 { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
 	features_12.bufferDeviceAddress = true;
 	features_12.descriptorIndexing = true;
+	features_12.runtimeDescriptorArray = true; // Bindless material textures
+	features_12.descriptorBindingPartiallyBound = true;
+	features_12.descriptorBindingSampledImageUpdateAfterBind = true;
+	features_12.descriptorBindingUpdateUnusedWhilePending = true;
+	features_12.shaderSampledImageArrayNonUniformIndexing = true;
+	features_12.timelineSemaphore = true;
 
 	// Required for glslangValidator -gVS debug info (OpExtInstWithForwardRefsKHR)
 	VkPhysicalDeviceShaderRelaxedExtendedInstructionFeaturesKHR relaxedExtInstFeatures {
@@ -590,6 +735,22 @@ void PantomirEngine::InitVulkan() {
 	                                                 .select()
 	                                                 .value();
 
+	// BCn sampling is near universal on desktop, but not guaranteed. The loader keeps RGBA8 textures without it.
+	VkPhysicalDeviceFeatures optionalFeatures {};
+	optionalFeatures.textureCompressionBC = VK_TRUE;
+	_bTextureCompressionBC = selectedPhysicalDevice.enable_features_if_present(optionalFeatures);
+	_maxImageDimension2D = selectedPhysicalDevice.properties.limits.maxImageDimension2D;
+
+	// Batched draws pass each command's draw object to the vertex shader as its first instance. GPU cluster culling
+	// compacts each surface's visible meshlets into indirect commands and lets the GPU read the count back.
+	VkPhysicalDeviceFeatures indirectFeatures {};
+	indirectFeatures.multiDrawIndirect = VK_TRUE;
+	indirectFeatures.drawIndirectFirstInstance = VK_TRUE;
+	VkPhysicalDeviceVulkan12Features indirectFeatures_12 { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+	indirectFeatures_12.drawIndirectCount = VK_TRUE;
+	_bMultiDrawIndirect = selectedPhysicalDevice.enable_features_if_present(indirectFeatures);
+	_bDrawIndirectCount = _bMultiDrawIndirect && selectedPhysicalDevice.enable_extension_features_if_present(indirectFeatures_12);
+
 	vkb::DeviceBuilder logicalDeviceBuilder { selectedPhysicalDevice };
 	vkb::Device        builtLogicalDevice = logicalDeviceBuilder.add_pNext(&relaxedExtInstFeatures).build().value();
 
@@ -599,6 +760,22 @@ void PantomirEngine::InitVulkan() {
 	_graphicsQueue = builtLogicalDevice.get_queue(vkb::QueueType::graphics).value();
 	_graphicsQueueFamilyIndex = builtLogicalDevice.get_queue_index(vkb::QueueType::graphics).value(); // ID Tag for GPU logical units; Useful for command pools, buffers, images.
 
+	// Uploads prefer a transfer-only family (usually the DMA engine), then any non-graphics family that can transfer, then graphics.
+	if (vkb::Result<VkQueue> dedicatedTransferQueue = builtLogicalDevice.get_dedicated_queue(vkb::QueueType::transfer)) {
+		_transferQueue = dedicatedTransferQueue.value();
+		_transferQueueFamilyIndex = builtLogicalDevice.get_dedicated_queue_index(vkb::QueueType::transfer).value();
+	} else if (vkb::Result<VkQueue> separateTransferQueue = builtLogicalDevice.get_queue(vkb::QueueType::transfer)) {
+		_transferQueue = separateTransferQueue.value();
+		_transferQueueFamilyIndex = builtLogicalDevice.get_queue_index(vkb::QueueType::transfer).value();
+	} else {
+		_transferQueue = _graphicsQueue;
+		_transferQueueFamilyIndex = _graphicsQueueFamilyIndex;
+	}
+	LOG(Engine, Info, "Graphics queue family: {}, transfer queue family: {}", _graphicsQueueFamilyIndex, _transferQueueFamilyIndex);
+	LOG(Engine, Info, "BC texture compression: {}", _bTextureCompressionBC ? "enabled" : "unsupported, using RGBA8");
+	LOG(Engine, Info, "Multi-draw indirect: {}", _bMultiDrawIndirect ? "enabled" : "unsupported, drawing surfaces one by one");
+	LOG(Engine, Info, "Draw indirect count: {}", _bDrawIndirectCount ? "enabled" : "unsupported, culling meshlets on the CPU");
+
 	VmaAllocatorCreateInfo allocatorInfo = {};
 	allocatorInfo.physicalDevice = _physicalGPU;
 	allocatorInfo.device = _logicalGPU;
@@ -670,6 +847,10 @@ void PantomirEngine::InitCommands() {
 	VK_CHECK(vkAllocateCommandBuffers(_logicalGPU, &commandBufferAllocInfoImmediate, &_immediateCommandBuffer)); /* Initial State */
 	_shutdownDeletionQueue.PushFunction([this]() { vkDestroyCommandPool(_logicalGPU, _immediateCommandPool, nullptr); });
 
+	/* UPLOADS */
+	_uploadBatcher.Init(this, UPLOAD_STAGING_RING_SIZE);
+	_shutdownDeletionQueue.PushFunction([this]() { _uploadBatcher.Destroy(); });
+
 	/* COMMAND POOLS AND BUFFERS PER BACK BUFFER FRAME */
 	for (FrameData& frame : _frames) {
 		VK_CHECK(vkCreateCommandPool(_logicalGPU, &commandPoolInfo, nullptr, &frame.commandPool));
@@ -746,12 +927,44 @@ void PantomirEngine::InitDescriptorPools() {
 }
 
 void PantomirEngine::InitPipelines() {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(_physicalGPU, &properties);
+
+	bool bWarmCache = false;
+	_pipelineCache = LoadPipelineCache(_logicalGPU, properties, GetPipelineCachePath(), bWarmCache);
+	// Pushed before any pipeline so it runs last, once every pipeline created through the cache is gone
+	_shutdownDeletionQueue.PushFunction([this, properties]() {
+		SavePipelineCache(_logicalGPU, properties, _pipelineCache, GetPipelineCachePath());
+		vkDestroyPipelineCache(_logicalGPU, _pipelineCache, nullptr);
+	});
+
+	_metalRoughMaterial.InitMaterialTable(this);
+	_shutdownDeletionQueue.PushFunction([this]() {
+		_metalRoughMaterial.ClearMaterialTable(this);
+	});
+
+	// Compiles run on the thread pool, the timer logs once the last one is done
+	const std::shared_ptr<PipelineBuildTimer> buildTimer = std::make_shared<PipelineBuildTimer>(bWarmCache);
+	_metalRoughMaterial._pipelineBuilds.SetTimer(buildTimer);
+	_hdriPipelineBuild.SetTimer(buildTimer);
+	_debugLinePipelineBuild.SetTimer(buildTimer);
+	_clusterCullPipelineBuild.SetTimer(buildTimer);
+	_objectCullPipelineBuild.SetTimer(buildTimer);
+
+	const std::chrono::time_point<std::chrono::steady_clock> start = std::chrono::steady_clock::now();
 	_metalRoughMaterial.BuildPipelines(this);
 	_shutdownDeletionQueue.PushFunction([this]() {
 		_metalRoughMaterial.ClearResources(_logicalGPU);
 	});
 	InitHDRIPipeline();
 	InitDebugLinePipeline();
+	InitClusterCullPipeline();
+	InitObjectCullPipeline();
+
+	// Only what the main thread spent queueing the builds
+	const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	LOG(Engine, Info, "Queued pipeline builds in {:.2f} ms", elapsed.count());
+	buildTimer->Seal();
 }
 
 void PantomirEngine::InitImgui() {
@@ -840,13 +1053,12 @@ void PantomirEngine::InitHDRIPipeline() {
 	pipelineBuilder.DisableBlending();
 	pipelineBuilder.SetColorAttachmentFormat(_colorImage.imageFormat);
 	pipelineBuilder.DisableDepthtest();
-	_hdriPipeline = pipelineBuilder.BuildPipeline(_logicalGPU);
-
-	// Clean structures
-	vkDestroyShaderModule(_logicalGPU, HDRIFragShader, nullptr);
-	vkDestroyShaderModule(_logicalGPU, HDRIVertexShader, nullptr);
+	_hdriPipelineBuild.Build(_threadPool, _logicalGPU, _pipelineCache, pipelineBuilder, &_hdriPipeline);
+	_hdriPipelineBuild.AddShaderModule(HDRIFragShader);
+	_hdriPipelineBuild.AddShaderModule(HDRIVertexShader);
 
 	_shutdownDeletionQueue.PushFunction([this]() {
+		_hdriPipelineBuild.Wait(_logicalGPU);
 		vkDestroyPipelineLayout(_logicalGPU, _hdriPipelineLayout, nullptr);
 		vkDestroyPipeline(_logicalGPU, _hdriPipeline, nullptr);
 	});
@@ -890,17 +1102,85 @@ void PantomirEngine::InitDebugLinePipeline() {
 	pipelineBuilder.SetColorAttachmentFormat(_colorImage.imageFormat);
 	pipelineBuilder.DisableDepthtest();
 
-	_debugLinePipeline = pipelineBuilder.BuildPipeline(_logicalGPU);
-
-	vkDestroyShaderModule(_logicalGPU, debugLineVertexShader, nullptr);
-	vkDestroyShaderModule(_logicalGPU, debugLineFragShader, nullptr);
+	_debugLinePipelineBuild.Build(_threadPool, _logicalGPU, _pipelineCache, pipelineBuilder, &_debugLinePipeline);
+	_debugLinePipelineBuild.AddShaderModule(debugLineVertexShader);
+	_debugLinePipelineBuild.AddShaderModule(debugLineFragShader);
 
 	_shutdownDeletionQueue.PushFunction([this]() {
+		_debugLinePipelineBuild.Wait(_logicalGPU);
 		vkDestroyPipelineLayout(_logicalGPU, _debugLinePipelineLayout, nullptr);
 		vkDestroyPipeline(_logicalGPU, _debugLinePipeline, nullptr);
 	});
 }
 
+void PantomirEngine::InitClusterCullPipeline() {
+	VkShaderModule clusterCullShader;
+	if (!vkutil::LoadShaderModule("Assets/Shaders/meshlet_cull.comp.spv", _logicalGPU, &clusterCullShader)) {
+		LOG(Engine, Error, "Error when building the {} compute shader module", __func__);
+	} else {
+		LOG(Engine, Info, "{} compute shader successfully loaded", __func__);
+	}
+
+	VkPushConstantRange bufferRange {};
+	bufferRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bufferRange.offset = 0;
+	bufferRange.size = sizeof(ClusterCullPushConstants);
+
+	// Everything is reached through buffer device addresses, no descriptor sets
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = vkinit::PipelineLayoutCreateInfo();
+	pipelineLayoutInfo.pPushConstantRanges = &bufferRange;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	VK_CHECK(vkCreatePipelineLayout(_logicalGPU, &pipelineLayoutInfo, nullptr, &_clusterCullPipelineLayout));
+
+	const VkComputePipelineCreateInfo computePipelineCreateInfo {
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.stage = vkinit::PipelineShaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT, clusterCullShader),
+		.layout = _clusterCullPipelineLayout
+	};
+	_clusterCullPipelineBuild.BuildCompute(_threadPool, _logicalGPU, _pipelineCache, computePipelineCreateInfo, &_clusterCullPipeline);
+	_clusterCullPipelineBuild.AddShaderModule(clusterCullShader);
+
+	_shutdownDeletionQueue.PushFunction([this]() {
+		_clusterCullPipelineBuild.Wait(_logicalGPU);
+		vkDestroyPipelineLayout(_logicalGPU, _clusterCullPipelineLayout, nullptr);
+		vkDestroyPipeline(_logicalGPU, _clusterCullPipeline, nullptr);
+	});
+}
+
+void PantomirEngine::InitObjectCullPipeline() {
+	VkShaderModule objectCullShader;
+	if (!vkutil::LoadShaderModule("Assets/Shaders/object_cull.comp.spv", _logicalGPU, &objectCullShader)) {
+		LOG(Engine, Error, "Error when building the {} compute shader module", __func__);
+	} else {
+		LOG(Engine, Info, "{} compute shader successfully loaded", __func__);
+	}
+
+	VkPushConstantRange bufferRange {};
+	bufferRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	bufferRange.offset = 0;
+	bufferRange.size = sizeof(ObjectCullPushConstants);
+
+	// Everything is reached through buffer device addresses, no descriptor sets
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = vkinit::PipelineLayoutCreateInfo();
+	pipelineLayoutInfo.pPushConstantRanges = &bufferRange;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	VK_CHECK(vkCreatePipelineLayout(_logicalGPU, &pipelineLayoutInfo, nullptr, &_objectCullPipelineLayout));
+
+	const VkComputePipelineCreateInfo computePipelineCreateInfo {
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.stage = vkinit::PipelineShaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT, objectCullShader),
+		.layout = _objectCullPipelineLayout
+	};
+	_objectCullPipelineBuild.BuildCompute(_threadPool, _logicalGPU, _pipelineCache, computePipelineCreateInfo, &_objectCullPipeline);
+	_objectCullPipelineBuild.AddShaderModule(objectCullShader);
+
+	_shutdownDeletionQueue.PushFunction([this]() {
+		_objectCullPipelineBuild.Wait(_logicalGPU);
+		vkDestroyPipelineLayout(_logicalGPU, _objectCullPipelineLayout, nullptr);
+		vkDestroyPipeline(_logicalGPU, _objectCullPipeline, nullptr);
+	});
+}
+
 void PantomirEngine::InitDefaultData() {
 	DebugLine WorldUp;
 	WorldUp.a = { 0.f, 0.f, 0.f };
@@ -967,18 +1247,23 @@ void PantomirEngine::InitDefaultData() {
 	});
 
 	std::string                                modelPath = { "Assets/Models/Echidna1.glb" };
-	std::optional<std::shared_ptr<LoadedGLTF>> modelFile = LoadGltf(this, modelPath);
-	std::string                                hdriPath = { "Assets/Textures/citrus_orchard_road_puresky_4k.hdr" };
-	std::string                                hdriPath2 = { "Assets/Textures/brown_photostudio_02_4k.hdr" };
-	std::optional<std::shared_ptr<LoadedHDRI>> hdriFile = LoadHDRI(this, hdriPath);
-	std::optional<std::shared_ptr<LoadedHDRI>> hdriFile2 = LoadHDRI(this, hdriPath2);
+	std::string                                objModelPath = { "Assets/Models/viking_room.obj" };
+	std::optional<std::shared_ptr<LoadedGLTF>> modelFile = LoadScene(this, modelPath);
+	std::optional<std::shared_ptr<LoadedGLTF>> objModelFile = LoadScene(this, objModelPath);
+	_hdriPaths["citrus_orchard_road_puresky_4k"] = "Assets/Textures/citrus_orchard_road_puresky_4k.hdr";
+	_hdriPaths["brown_photostudio_02_4k"] = "Assets/Textures/brown_photostudio_02_4k.hdr";
+	std::optional<std::shared_ptr<LoadedHDRI>> hdriFile = LoadHDRI(this, _hdriPaths["citrus_orchard_road_puresky_4k"]);
 
 	assert(modelFile.has_value());
+	assert(objModelFile.has_value());
 	assert(hdriFile.has_value());
 
+	// Default images and the startup assets are needed for the first frame
+	_uploadBatcher.Flush();
+
 	_loadedScenes["Echidna1"] = *modelFile;
+	_loadedScenes["viking_room"] = *objModelFile;
 	_loadedHDRIs["citrus_orchard_road_puresky_4k"] = *hdriFile;
-	_loadedHDRIs["brown_photostudio_02_4k"] = *hdriFile2;
 	_currentHDRI = _loadedHDRIs["citrus_orchard_road_puresky_4k"];
 }
 
@@ -1083,6 +1368,11 @@ void PantomirEngine::Draw() {
 	GetCurrentFrame().deletionQueue.Flush();
 	GetCurrentFrame().descriptorPoolManager.ClearPools(_logicalGPU);
 
+	_uploadBatcher.RetireCompletedBatches();
+	for (const std::shared_ptr<LoadedGLTF>& scene : _loadedScenes | std::views::values) {
+		scene->UpdateTextureStream();
+	}
+
 	uint32_t swapchainImageIndex;
 	if (!AcquireSwapchainImage(swapchainImageIndex)) {
 		return;
@@ -1144,11 +1434,21 @@ void PantomirEngine::Draw() {
 
 	PresentSwapchainImage(swapchainImageIndex);
 
+	if (_frameNumber == 0) {
+		const std::chrono::duration<float, std::milli> timeToFirstFrame = std::chrono::steady_clock::now() - _startTime;
+		_stats.timeToFirstFrame = timeToFirstFrame.count();
+		LOG(Engine, Info, "First frame presented {:.2f} ms after startup", _stats.timeToFirstFrame);
+	}
+
 	// Increase the number of frames drawn
 	++_frameNumber;
 }
 
 void PantomirEngine::DrawHDRI(const VkCommandBuffer commandBuffer) {
+	if (!_uploadBatcher.IsComplete(_currentHDRI->_uploadHandle)) {
+		return;
+	}
+
 	VkRenderingAttachmentInfo colorAttachment = vkinit::AttachmentInfo(_colorImage.imageView, nullptr, VK_IMAGE_LAYOUT_GENERAL); // Clear value can be set if you have 0 background to draw behind geometry.
 	const VkRenderingInfo     renderInfo = vkinit::RenderingInfo(_drawExtent, &colorAttachment, nullptr);
 	glm::mat4                 viewMatrix = _mainCamera.GetViewMatrix();
@@ -1161,6 +1461,7 @@ void PantomirEngine::DrawHDRI(const VkCommandBuffer commandBuffer) {
 
 	vkCmdBeginRendering(commandBuffer, &renderInfo);
 
+	_hdriPipelineBuild.Wait(_logicalGPU);
 	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _hdriPipeline);
 
 	VkDescriptorSet     hdriDescriptorSet = GetCurrentFrame().descriptorPoolManager.Allocate(_logicalGPU, _hdriDescriptorSetLayout); // Allocate a set from a descriptor pool, using this layout.
@@ -1177,18 +1478,40 @@ void PantomirEngine::DrawHDRI(const VkCommandBuffer commandBuffer) {
 }
 
 void PantomirEngine::DrawGeometry(VkCommandBuffer commandBuffer) {
+	_metalRoughMaterial._pipelineBuilds.Wait(_logicalGPU);
+
 	// Visibility Culling
 	std::vector<uint32_t> opaqueDraws;
 	std::vector<uint32_t> maskedDraws;
 	std::vector<uint32_t> transparentDraws;
 
-	BuildDrawListByMaterialMesh(_mainDrawContext.opaqueSurfaces,
-	                            _sceneData.viewProjection,
-	                            opaqueDraws);
-
-	BuildDrawListByMaterialMesh(_mainDrawContext.maskedSurfaces,
-	                            _sceneData.viewProjection,
-	                            maskedDraws);
+	// LODs go by the vertical field of view, the projection's [1][1] is the cotangent of its half angle
+	const float projectionScale = glm::abs(_sceneData.proj[1][1]);
+	_stats.lodDrawCounts.fill(0);
+
+	// The GPU-driven path culls and picks LODs for opaque and masked surfaces in its compute pass
+	const bool bGPUDriven = _bGPUDrivenRendering && _bDrawIndirectCount;
+	const bool bBatchDraws = !bGPUDriven && _bBatchDraws && _bMultiDrawIndirect;
+	_stats.bGPUDriven = bGPUDriven;
+	if (!bGPUDriven) {
+		BuildDrawListByMaterialMesh(_mainDrawContext.opaqueSurfaces,
+		                            _sceneData.viewProjection,
+		                            _mainCamera._position,
+		                            projectionScale,
+		                            _lodScreenSizeThreshold,
+		                            bBatchDraws,
+		                            _stats.lodDrawCounts,
+		                            opaqueDraws);
+
+		BuildDrawListByMaterialMesh(_mainDrawContext.maskedSurfaces,
+		                            _sceneData.viewProjection,
+		                            _mainCamera._position,
+		                            projectionScale,
+		                            _lodScreenSizeThreshold,
+		                            bBatchDraws,
+		                            _stats.lodDrawCounts,
+		                            maskedDraws);
+	}
 
 	BuildDrawListTransparent(_mainDrawContext.transparentSurfaces,
 	                         _sceneData.viewProjection,
@@ -1213,58 +1536,190 @@ void PantomirEngine::DrawGeometry(VkCommandBuffer commandBuffer) {
 	uniformWriter.WriteBuffer(0, uniformBufferGPUSceneData.buffer, sizeof(GPUSceneData), 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 	uniformWriter.UpdateSet(_logicalGPU, sceneDataDescriptorSet);
 
+	// Cluster culling. Opaque and masked surfaces go to the compute pass when the GPU can consume its output directly,
+	// everything else culls its meshlets on the CPU while recording. Transparent surfaces always stay on the CPU.
+	const std::array<glm::vec4, 6>    frustumPlanes = ExtractFrustumPlanes(_sceneData.viewProjection);
+	std::vector<GPUClusterCullObject> cullObjects;
+	std::vector<uint32_t>             opaqueCullObjects(opaqueDraws.size(), NO_CLUSTER_CULL_OBJECT);
+	std::vector<uint32_t>             maskedCullObjects(maskedDraws.size(), NO_CLUSTER_CULL_OBJECT);
+	uint32_t                          cullMeshletCount = 0;
+	AllocatedBuffer                   drawCommandBuffer {};
+	AllocatedBuffer                   drawCountBuffer {};
+
+	if (_bClusterCulling && _bGPUClusterCulling && _bDrawIndirectCount) {
+		auto addCullObjects = [&](const std::vector<RenderObject>& surfaces, const std::vector<uint32_t>& draws, std::vector<uint32_t>& out_cullObjects) {
+			for (size_t draw = 0; draw < draws.size(); ++draw) {
+				const RenderObject& renderObject = surfaces[draws[draw]];
+				if (renderObject.meshlets.empty()) {
+					continue;
+				}
+
+				out_cullObjects[draw] = static_cast<uint32_t>(cullObjects.size());
+				cullObjects.push_back(GPUClusterCullObject {
+				    .transform = renderObject.transform,
+				    .meshletBufferAddress = renderObject.meshletBufferAddress,
+				    .firstMeshlet = renderObject.firstMeshlet,
+				    .meshletCount = static_cast<uint32_t>(renderObject.meshlets.size()),
+				    .firstCommand = cullMeshletCount,
+				    .maxScale = GetMaxScale(renderObject.transform),
+				    .bConeCulling = CanConeCull(renderObject) ? 1u : 0u });
+				cullMeshletCount += static_cast<uint32_t>(renderObject.meshlets.size());
+			}
+		};
+		addCullObjects(_mainDrawContext.opaqueSurfaces, opaqueDraws, opaqueCullObjects);
+		addCullObjects(_mainDrawContext.maskedSurfaces, maskedDraws, maskedCullObjects);
+
+		if (!cullObjects.empty()) {
+			RecordClusterCulling(commandBuffer, cullObjects, cullMeshletCount, drawCommandBuffer, drawCountBuffer);
+		}
+	}
+
+	// Batches of opaque and masked draws, their commands come from the GPU-driven culling pass or straight from the CPU
+	std::vector<DrawBatch> drawBatches;
+	AllocatedBuffer        drawObjectBuffer {};
+	AllocatedBuffer        batchCommandBuffer {};
+	AllocatedBuffer        batchCountBuffer {}; // Only when the GPU wrote the commands
+	if (bGPUDriven) {
+		RecordObjectCulling(commandBuffer, projectionScale, drawBatches, drawObjectBuffer, batchCommandBuffer, batchCountBuffer);
+	} else if (bBatchDraws) {
+		BuildDrawBatches(frustumPlanes, opaqueDraws, opaqueCullObjects, maskedDraws, maskedCullObjects, drawBatches, drawObjectBuffer, batchCommandBuffer);
+	}
+
 	// Begin a render pass connected to our draw image
 	VkRenderingAttachmentInfo colorAttachment = vkinit::AttachmentInfo(_colorImage.imageView, nullptr, VK_IMAGE_LAYOUT_GENERAL);
 	VkRenderingAttachmentInfo depthAttachment = vkinit::DepthAttachmentInfo(_depthImage.imageView, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
 	VkRenderingInfo           renderInfo = vkinit::RenderingInfo(_drawExtent, &colorAttachment, &depthAttachment);
 	vkCmdBeginRendering(commandBuffer, &renderInfo); // At the start, a clear operation happens for each attachment
 
+	// Scene data and every material are reached through two sets, all material pipelines share the layout they're bound with
+	const VkDescriptorSet globalDescriptorSets[] = { sceneDataDescriptorSet, _metalRoughMaterial._bindlessDescriptorSet };
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _metalRoughMaterial._pipelineLayout, 0, 2, globalDescriptorSets, 0, nullptr);
+
 	// Defined outside the draw function, this is the state we will try to skip
-	MaterialPipeline* lastPipeline = nullptr;
-	MaterialInstance* lastMaterial = nullptr;
-	VkBuffer          lastIndexBuffer = VK_NULL_HANDLE;
+	MaterialPipeline*  lastPipeline = nullptr;
+	MaterialInstance*  lastMaterial = nullptr;
+	VkCullModeFlagBits lastCullMode = VK_CULL_MODE_FLAG_BITS_MAX_ENUM;
+	VkBuffer           lastIndexBuffer = VK_NULL_HANDLE;
+	VkIndexType        lastIndexType = VK_INDEX_TYPE_MAX_ENUM;
 
 	// TODO: Need to make this easier to understand, because the Draw() function is gathering draw context, and not recording draws for Vulkan yet.
-	auto              actualDrawFunction = [&](const RenderObject& renderObject) {
+	auto               actualDrawFunction = [&](const RenderObject& renderObject, const uint32_t cullObjectIndex) {
         // Step 1: Bind Pipeline
         if (renderObject.material != lastMaterial) {
             lastMaterial = renderObject.material;
-            // Rebind pipeline and descriptors if the material changed
+            // Rebind the pipeline if the material changed it, the material itself is only an index pushed with the draw
             if (renderObject.material->pipeline != lastPipeline) {
                 lastPipeline = renderObject.material->pipeline;
                 vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderObject.material->pipeline->pipeline);
-                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderObject.material->pipeline->layout, 0, 1, &sceneDataDescriptorSet, 0, nullptr);
             }
-            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderObject.material->pipeline->layout, 1, 1, &renderObject.material->descriptorSet, 0, nullptr);
+            // Every material pipeline takes its cull mode as dynamic state, so it carries over pipeline binds
+            if (renderObject.material->cullMode != lastCullMode) {
+                lastCullMode = renderObject.material->cullMode;
+                vkCmdSetCullMode(commandBuffer, renderObject.material->cullMode);
+            }
         }
-        // Step 2: Bind index buffer, Rebind index buffer if needed
-        if (renderObject.indexBuffer != lastIndexBuffer) {
+        // Step 2: Bind index buffer, Rebind index buffer if needed. Each index type has its own range of the buffer.
+        if (renderObject.indexBuffer != lastIndexBuffer || renderObject.indexType != lastIndexType) {
             lastIndexBuffer = renderObject.indexBuffer;
-            vkCmdBindIndexBuffer(commandBuffer, renderObject.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            lastIndexType = renderObject.indexType;
+            vkCmdBindIndexBuffer(commandBuffer, renderObject.indexBuffer, renderObject.indexBufferOffset, renderObject.indexType);
         }
 
-        // Step 3: Transform and the location of the model's vertices in the huge vertex buffer is sent through a push constant.
+        // Step 3: Transform, material and the location of the model's vertices in the huge vertex buffer are sent through a push constant.
         const GPUDrawPushConstants drawPushConstants {
 			             .worldSpaceTransform = renderObject.transform,
-			             .vertexBufferAddress = renderObject.vertexBufferAddress
+			             .positionOffset = glm::vec4(renderObject.positionOffset, 0.F),
+			             .positionScale = glm::vec4(renderObject.positionScale, 0.F),
+			             .vertexBufferAddress = renderObject.vertexBufferAddress,
+			             .materialIndex = renderObject.material->materialIndex
         };
         vkCmdPushConstants(commandBuffer, renderObject.material->pipeline->layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(GPUDrawPushConstants), &drawPushConstants);
 
         // THE ACTUAL DRAW CALL
-        vkCmdDrawIndexed(commandBuffer, renderObject.indexCount, 1, renderObject.firstIndex, 0, 0);
+        // GPU culled: the compute pass wrote one command per visible meshlet and how many there are
+        if (cullObjectIndex != NO_CLUSTER_CULL_OBJECT) {
+            const GPUClusterCullObject& cullObject = cullObjects[cullObjectIndex];
+            vkCmdDrawIndexedIndirectCount(commandBuffer,
+                                          drawCommandBuffer.buffer,
+                                          cullObject.firstCommand * sizeof(VkDrawIndexedIndirectCommand),
+                                          drawCountBuffer.buffer,
+                                          cullObjectIndex * sizeof(uint32_t),
+                                          cullObject.meshletCount,
+                                          sizeof(VkDrawIndexedIndirectCommand));
+
+            _stats.drawcallCount++;
+            _stats.triangleCount += renderObject.indexCount / 3; // Before culling, the survivors are only known to the GPU
+            return;
+        }
+
+        // CPU culled: each run of visible neighboring meshlets is one draw
+        if (_bClusterCulling && !renderObject.meshlets.empty()) {
+            ForEachVisibleMeshletRun(renderObject, frustumPlanes, _mainCamera._position, [&](const uint32_t runFirstIndex, const uint32_t runIndexCount) {
+                vkCmdDrawIndexed(commandBuffer, runIndexCount, 1, runFirstIndex, renderObject.vertexOffset, 0);
+                _stats.drawcallCount++;
+                _stats.triangleCount += runIndexCount / 3;
+            });
+            return;
+        }
+
+        vkCmdDrawIndexed(commandBuffer, renderObject.indexCount, 1, renderObject.firstIndex, renderObject.vertexOffset, 0);
 
         _stats.drawcallCount++;
         _stats.triangleCount += renderObject.indexCount / 3;
     };
 
-	for (const uint32_t& renderIndex : opaqueDraws) {
-		actualDrawFunction(_mainDrawContext.opaqueSurfaces[renderIndex]);
+	// One draw per batch. The GPU-driven culling pass also wrote how many of its commands survived.
+	if (!drawBatches.empty()) {
+		const GPUDrawIndirectPushConstants indirectPushConstants { .drawObjectBufferAddress = GetBufferDeviceAddress(drawObjectBuffer) };
+		vkCmdPushConstants(commandBuffer, _metalRoughMaterial._pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(GPUDrawIndirectPushConstants), &indirectPushConstants);
 	}
-	for (const uint32_t& renderIndex : maskedDraws) {
-		actualDrawFunction(_mainDrawContext.maskedSurfaces[renderIndex]);
+	for (uint32_t batchIndex = 0; batchIndex < static_cast<uint32_t>(drawBatches.size()); ++batchIndex) {
+		const DrawBatch& batch = drawBatches[batchIndex];
+		if (batch.pipeline != lastPipeline) {
+			lastPipeline = batch.pipeline;
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, batch.pipeline->indirectPipeline);
+		}
+		if (batch.cullMode != lastCullMode) {
+			lastCullMode = batch.cullMode;
+			vkCmdSetCullMode(commandBuffer, batch.cullMode);
+		}
+		if (batch.indexBuffer != lastIndexBuffer || batch.indexType != lastIndexType) {
+			lastIndexBuffer = batch.indexBuffer;
+			lastIndexType = batch.indexType;
+			vkCmdBindIndexBuffer(commandBuffer, batch.indexBuffer, batch.indexBufferOffset, batch.indexType);
+		}
+
+		if (batchCountBuffer.buffer != VK_NULL_HANDLE) {
+			vkCmdDrawIndexedIndirectCount(commandBuffer,
+			                              batchCommandBuffer.buffer,
+			                              batch.firstCommand * sizeof(VkDrawIndexedIndirectCommand),
+			                              batchCountBuffer.buffer,
+			                              batchIndex * sizeof(uint32_t),
+			                              batch.commandCount,
+			                              sizeof(VkDrawIndexedIndirectCommand));
+		} else {
+			vkCmdDrawIndexedIndirect(commandBuffer, batchCommandBuffer.buffer, batch.firstCommand * sizeof(VkDrawIndexedIndirectCommand), batch.commandCount, sizeof(VkDrawIndexedIndirectCommand));
+		}
+		_stats.drawcallCount++;
+	}
+	// What is bound now is an indirect pipeline, the surfaces below draw with the regular one
+	lastPipeline = nullptr;
+
+	// Batched draws are already recorded, only the ones the GPU cluster culls are left
+	for (size_t draw = 0; draw < opaqueDraws.size(); ++draw) {
+		if (bBatchDraws && opaqueCullObjects[draw] == NO_CLUSTER_CULL_OBJECT) {
+			continue;
+		}
+		actualDrawFunction(_mainDrawContext.opaqueSurfaces[opaqueDraws[draw]], opaqueCullObjects[draw]);
+	}
+	for (size_t draw = 0; draw < maskedDraws.size(); ++draw) {
+		if (bBatchDraws && maskedCullObjects[draw] == NO_CLUSTER_CULL_OBJECT) {
+			continue;
+		}
+		actualDrawFunction(_mainDrawContext.maskedSurfaces[maskedDraws[draw]], maskedCullObjects[draw]);
 	}
 	for (const uint32_t& renderIndex : transparentDraws) {
-		actualDrawFunction(_mainDrawContext.transparentSurfaces[renderIndex]);
+		actualDrawFunction(_mainDrawContext.transparentSurfaces[renderIndex], NO_CLUSTER_CULL_OBJECT);
 	}
 
 	ClearSurfaces();
@@ -1277,6 +1732,268 @@ void PantomirEngine::DrawGeometry(VkCommandBuffer commandBuffer) {
 	vkCmdEndRendering(commandBuffer);
 }
 
+void PantomirEngine::RecordClusterCulling(const VkCommandBuffer commandBuffer, const std::span<const GPUClusterCullObject> cullObjects, const uint32_t meshletCount, AllocatedBuffer& out_drawCommandBuffer, AllocatedBuffer& out_drawCountBuffer) {
+	const size_t    cullObjectBufferSize = cullObjects.size_bytes();
+	const size_t    drawCommandBufferSize = meshletCount * sizeof(VkDrawIndexedIndirectCommand);
+	const size_t    drawCountBufferSize = cullObjects.size() * sizeof(uint32_t);
+
+	AllocatedBuffer cullObjectBuffer = CreateBuffer(cullObjectBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+	out_drawCommandBuffer = CreateBuffer(drawCommandBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+	out_drawCountBuffer = CreateBuffer(drawCountBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+	GetCurrentFrame().deletionQueue.PushFunction([=, this, drawCommandBuffer = out_drawCommandBuffer, drawCountBuffer = out_drawCountBuffer]() {
+		DestroyBuffer(cullObjectBuffer);
+		DestroyBuffer(drawCommandBuffer);
+		DestroyBuffer(drawCountBuffer);
+	});
+	GPUClusterCullObject* cullObjectData = static_cast<GPUClusterCullObject*>(cullObjectBuffer.allocation->GetMappedData());
+	std::ranges::copy(cullObjects, cullObjectData);
+
+	// Every surface starts with no visible meshlets, the shader bumps its count for each one that survives
+	vkCmdFillBuffer(commandBuffer, out_drawCountBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+
+	const VkMemoryBarrier2 clearBarrier {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+		.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+	};
+	const VkDependencyInfo clearDependency { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .memoryBarrierCount = 1, .pMemoryBarriers = &clearBarrier };
+	vkCmdPipelineBarrier2(commandBuffer, &clearDependency);
+
+	const ClusterCullPushConstants constants {
+		.viewProjection = _sceneData.viewProjection,
+		.cameraPosition = glm::vec4(_mainCamera._position, 1.0F),
+		.cullObjectBufferAddress = GetBufferDeviceAddress(cullObjectBuffer),
+		.drawCommandBufferAddress = GetBufferDeviceAddress(out_drawCommandBuffer),
+		.drawCountBufferAddress = GetBufferDeviceAddress(out_drawCountBuffer),
+		.cullObjectCount = static_cast<uint32_t>(cullObjects.size()),
+		.meshletCount = meshletCount
+	};
+
+	_clusterCullPipelineBuild.Wait(_logicalGPU);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _clusterCullPipeline);
+	vkCmdPushConstants(commandBuffer, _clusterCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ClusterCullPushConstants), &constants);
+	vkCmdDispatch(commandBuffer, (meshletCount + CLUSTER_CULL_WORKGROUP_SIZE - 1) / CLUSTER_CULL_WORKGROUP_SIZE, 1, 1);
+
+	// The draws read the commands and counts as indirect parameters
+	const VkMemoryBarrier2 cullBarrier {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+		.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT
+	};
+	const VkDependencyInfo cullDependency { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .memoryBarrierCount = 1, .pMemoryBarriers = &cullBarrier };
+	vkCmdPipelineBarrier2(commandBuffer, &cullDependency);
+}
+
+void PantomirEngine::BuildDrawBatches(const std::array<glm::vec4, 6>& frustumPlanes,
+                                      const std::span<const uint32_t> opaqueDraws,
+                                      const std::span<const uint32_t> opaqueCullObjects,
+                                      const std::span<const uint32_t> maskedDraws,
+                                      const std::span<const uint32_t> maskedCullObjects,
+                                      std::vector<DrawBatch>&         out_drawBatches,
+                                      AllocatedBuffer&                out_drawObjectBuffer,
+                                      AllocatedBuffer&                out_drawCommandBuffer) {
+	std::vector<GPUDrawObject>                drawObjects;
+	std::vector<VkDrawIndexedIndirectCommand> drawCommands;
+	drawObjects.reserve(opaqueDraws.size() + maskedDraws.size());
+	drawCommands.reserve(opaqueDraws.size() + maskedDraws.size());
+	out_drawBatches.clear();
+
+	auto addDraws = [&](const std::vector<RenderObject>& surfaces, const std::span<const uint32_t> draws, const std::span<const uint32_t> cullObjects) {
+		for (size_t draw = 0; draw < draws.size(); ++draw) {
+			// The GPU cluster culling pass writes their commands itself
+			if (cullObjects[draw] != NO_CLUSTER_CULL_OBJECT) {
+				continue;
+			}
+
+			// The draw lists are sorted by what a draw binds, so each batch is a run of neighbors
+			const RenderObject& renderObject = surfaces[draws[draw]];
+			if (out_drawBatches.empty() ||
+			    std::tie(out_drawBatches.back().pipeline, out_drawBatches.back().cullMode, out_drawBatches.back().indexBuffer, out_drawBatches.back().indexBufferOffset, out_drawBatches.back().indexType) !=
+			        std::tie(renderObject.material->pipeline, renderObject.material->cullMode, renderObject.indexBuffer, renderObject.indexBufferOffset, renderObject.indexType)) {
+				out_drawBatches.push_back(DrawBatch {
+				    .pipeline = renderObject.material->pipeline,
+				    .cullMode = renderObject.material->cullMode,
+				    .indexBuffer = renderObject.indexBuffer,
+				    .indexBufferOffset = renderObject.indexBufferOffset,
+				    .indexType = renderObject.indexType,
+				    .firstCommand = static_cast<uint32_t>(drawCommands.size()),
+				    .commandCount = 0 });
+			}
+
+			// The LOD is already picked, firstIndex and indexCount hold its range. Only object_cull.comp reads the batch fields.
+			DrawBatch&     batch = out_drawBatches.back();
+			const uint32_t objectIndex = static_cast<uint32_t>(drawObjects.size());
+			drawObjects.push_back(GPUDrawObject {
+			    .transform = renderObject.transform,
+			    .positionOffset = glm::vec4(renderObject.positionOffset, 0.F),
+			    .positionScale = glm::vec4(renderObject.positionScale, 0.F),
+			    .boundingSphere = glm::vec4(renderObject.bounds.originPoint, renderObject.bounds.sphereRadius),
+			    .vertexBufferAddress = renderObject.vertexBufferAddress,
+			    .materialIndex = renderObject.material->materialIndex,
+			    .firstIndex = renderObject.firstIndex,
+			    .indexCount = renderObject.indexCount,
+			    .vertexOffset = renderObject.vertexOffset,
+			    .maxScale = GetMaxScale(renderObject.transform),
+			    .lodCount = 0 });
+
+			auto addCommand = [&](const uint32_t firstIndex, const uint32_t indexCount) {
+				drawCommands.push_back(VkDrawIndexedIndirectCommand {
+				    .indexCount = indexCount,
+				    .instanceCount = 1,
+				    .firstIndex = firstIndex,
+				    .vertexOffset = renderObject.vertexOffset,
+				    .firstInstance = objectIndex }); // mesh_indirect.vert finds its draw object through gl_InstanceIndex
+				++batch.commandCount;
+				_stats.triangleCount += indexCount / 3;
+			};
+
+			// CPU culled meshlets become one command per run of visible neighbors, all sharing the surface's draw object
+			if (_bClusterCulling && !renderObject.meshlets.empty()) {
+				ForEachVisibleMeshletRun(renderObject, frustumPlanes, _mainCamera._position, addCommand);
+			} else {
+				addCommand(renderObject.firstIndex, renderObject.indexCount);
+			}
+		}
+	};
+	addDraws(_mainDrawContext.opaqueSurfaces, opaqueDraws, opaqueCullObjects);
+	addDraws(_mainDrawContext.maskedSurfaces, maskedDraws, maskedCullObjects);
+
+	// Every meshlet of a surface can be culled, which leaves its batch with nothing to draw
+	std::erase_if(out_drawBatches, [](const DrawBatch& batch) { return batch.commandCount == 0; });
+	if (out_drawBatches.empty()) {
+		return;
+	}
+
+	out_drawObjectBuffer = CreateBuffer(drawObjects.size() * sizeof(GPUDrawObject), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+	out_drawCommandBuffer = CreateBuffer(drawCommands.size() * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+	GetCurrentFrame().deletionQueue.PushFunction([=, this, drawObjectBuffer = out_drawObjectBuffer, drawCommandBuffer = out_drawCommandBuffer]() {
+		DestroyBuffer(drawObjectBuffer);
+		DestroyBuffer(drawCommandBuffer);
+	});
+
+	// Host writes before the submit are visible to it, no barrier needed
+	std::ranges::copy(drawObjects, static_cast<GPUDrawObject*>(out_drawObjectBuffer.allocation->GetMappedData()));
+	std::ranges::copy(drawCommands, static_cast<VkDrawIndexedIndirectCommand*>(out_drawCommandBuffer.allocation->GetMappedData()));
+}
+
+void PantomirEngine::RecordObjectCulling(const VkCommandBuffer commandBuffer, const float projectionScale, std::vector<DrawBatch>& out_drawBatches, AllocatedBuffer& out_drawObjectBuffer, AllocatedBuffer& out_drawCommandBuffer, AllocatedBuffer& out_drawCountBuffer) {
+	const std::array<const std::vector<RenderObject>*, 2> surfaceLists = { &_mainDrawContext.opaqueSurfaces, &_mainDrawContext.maskedSurfaces };
+	const uint32_t                                         drawObjectCount = static_cast<uint32_t>(surfaceLists[0]->size() + surfaceLists[1]->size());
+	out_drawBatches.clear();
+	if (drawObjectCount == 0) {
+		return;
+	}
+
+	// Batch by everything a draw binds. The map keeps the batches in the order BuildDrawListByMaterialMesh would draw them.
+	using BatchKey = std::tuple<MaterialPipeline*, VkCullModeFlagBits, VkBuffer, VkDeviceSize, VkIndexType>;
+	auto batchKey = [](const RenderObject& renderObject) {
+		return BatchKey { renderObject.material->pipeline, renderObject.material->cullMode, renderObject.indexBuffer, renderObject.indexBufferOffset, renderObject.indexType };
+	};
+
+	std::map<BatchKey, uint32_t> batchIndices; // Counts the batch's objects first, then holds its index in out_drawBatches
+	for (const std::vector<RenderObject>* surfaces : surfaceLists) {
+		for (const RenderObject& renderObject : *surfaces) {
+			++batchIndices[batchKey(renderObject)];
+		}
+	}
+
+	// Each batch reserves a command for every object in it, culling leaves a prefix of that range filled
+	uint32_t commandCount = 0;
+	for (auto& [key, batchIndex] : batchIndices) {
+		const uint32_t objectCount = batchIndex;
+		batchIndex = static_cast<uint32_t>(out_drawBatches.size());
+		out_drawBatches.push_back(DrawBatch {
+		    .pipeline = std::get<0>(key),
+		    .cullMode = std::get<1>(key),
+		    .indexBuffer = std::get<2>(key),
+		    .indexBufferOffset = std::get<3>(key),
+		    .indexType = std::get<4>(key),
+		    .firstCommand = commandCount,
+		    .commandCount = objectCount });
+		commandCount += objectCount;
+	}
+
+	out_drawObjectBuffer = CreateBuffer(drawObjectCount * sizeof(GPUDrawObject), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+	out_drawCommandBuffer = CreateBuffer(commandCount * sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+	out_drawCountBuffer = CreateBuffer(out_drawBatches.size() * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+	GetCurrentFrame().deletionQueue.PushFunction([=, this, drawObjectBuffer = out_drawObjectBuffer, drawCommandBuffer = out_drawCommandBuffer, drawCountBuffer = out_drawCountBuffer]() {
+		DestroyBuffer(drawObjectBuffer);
+		DestroyBuffer(drawCommandBuffer);
+		DestroyBuffer(drawCountBuffer);
+	});
+
+	// Written straight into mapped memory, this is the only per-surface work left on the CPU
+	GPUDrawObject* drawObjects = static_cast<GPUDrawObject*>(out_drawObjectBuffer.allocation->GetMappedData());
+	for (const std::vector<RenderObject>* surfaces : surfaceLists) {
+		for (const RenderObject& renderObject : *surfaces) {
+			const uint32_t batchIndex = batchIndices.find(batchKey(renderObject))->second;
+			GPUDrawObject  drawObject {
+				.transform = renderObject.transform,
+				.positionOffset = glm::vec4(renderObject.positionOffset, 0.F),
+				.positionScale = glm::vec4(renderObject.positionScale, 0.F),
+				.boundingSphere = glm::vec4(renderObject.bounds.originPoint, renderObject.bounds.sphereRadius),
+				.vertexBufferAddress = renderObject.vertexBufferAddress,
+				.materialIndex = renderObject.material->materialIndex,
+				.firstIndex = renderObject.firstIndex,
+				.indexCount = renderObject.indexCount,
+				.vertexOffset = renderObject.vertexOffset,
+				.batchIndex = batchIndex,
+				.firstCommand = out_drawBatches[batchIndex].firstCommand,
+				.maxScale = GetMaxScale(renderObject.transform),
+				.lodCount = static_cast<uint32_t>(std::min<size_t>(renderObject.lods.size(), MAX_SURFACE_LODS))
+			};
+			for (uint32_t level = 0; level < drawObject.lodCount; ++level) {
+				drawObject.lods[level] = glm::uvec2(renderObject.lods[level].startIndex, renderObject.lods[level].count);
+			}
+			*drawObjects++ = drawObject;
+		}
+	}
+
+	// Every batch starts with no visible surfaces, the shader bumps its count for each one that survives
+	vkCmdFillBuffer(commandBuffer, out_drawCountBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+
+	const VkMemoryBarrier2 clearBarrier {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT,
+		.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+	};
+	const VkDependencyInfo clearDependency { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .memoryBarrierCount = 1, .pMemoryBarriers = &clearBarrier };
+	vkCmdPipelineBarrier2(commandBuffer, &clearDependency);
+
+	const ObjectCullPushConstants constants {
+		.viewProjection = _sceneData.viewProjection,
+		.cameraPosition = glm::vec4(_mainCamera._position, 1.0F),
+		.drawObjectBufferAddress = GetBufferDeviceAddress(out_drawObjectBuffer),
+		.drawCommandBufferAddress = GetBufferDeviceAddress(out_drawCommandBuffer),
+		.drawCountBufferAddress = GetBufferDeviceAddress(out_drawCountBuffer),
+		.drawObjectCount = drawObjectCount,
+		.projectionScale = projectionScale,
+		.lodScreenSizeThreshold = _lodScreenSizeThreshold
+	};
+
+	_objectCullPipelineBuild.Wait(_logicalGPU);
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _objectCullPipeline);
+	vkCmdPushConstants(commandBuffer, _objectCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ObjectCullPushConstants), &constants);
+	vkCmdDispatch(commandBuffer, (drawObjectCount + OBJECT_CULL_WORKGROUP_SIZE - 1) / OBJECT_CULL_WORKGROUP_SIZE, 1, 1);
+
+	// The draws read the commands and counts as indirect parameters, mesh_indirect.vert reads the draw objects
+	const VkMemoryBarrier2 cullBarrier {
+		.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
+		.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+		.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+		.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,
+		.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT
+	};
+	const VkDependencyInfo cullDependency { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .memoryBarrierCount = 1, .pMemoryBarriers = &cullBarrier };
+	vkCmdPipelineBarrier2(commandBuffer, &cullDependency);
+}
+
 void PantomirEngine::DrawImgui(const VkCommandBuffer commandBuffer, const VkImageView targetImageView) const {
 	VkRenderingAttachmentInfo colorAttachment = vkinit::AttachmentInfo(targetImageView, nullptr, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 	const VkRenderingInfo     renderInfo = vkinit::RenderingInfo(_swapchainExtent, &colorAttachment, nullptr);
@@ -1307,6 +2024,7 @@ void PantomirEngine::DrawDebugLines(const VkCommandBuffer commandBuffer, const s
 	descriptorWriter.WriteBuffer(0, uniformBufferGPUSceneData.buffer, sizeof(CameraUBO), 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 	descriptorWriter.UpdateSet(_logicalGPU, debugLineDescriptorSet);
 
+	_debugLinePipelineBuild.Wait(_logicalGPU);
 	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _debugLinePipeline);
 	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _debugLinePipelineLayout, 0, 1, &debugLineDescriptorSet, 0, nullptr);
 
@@ -1354,7 +2072,17 @@ void PantomirEngine::UpdateScene() {
 	_sceneData.viewProjection = projection * view;
 	_sceneData.cameraPosition = _mainCamera._position;
 
-	_loadedScenes["Echidna1"]->FillDrawContext(glm::mat4 { 1.f }, _mainDrawContext);
+	// Scenes still streaming in on the transfer queue are skipped until their upload completes
+	const std::shared_ptr<LoadedGLTF>& scene = _loadedScenes["Echidna1"];
+	if (_uploadBatcher.IsComplete(scene->_uploadHandle)) {
+		scene->FillDrawContext(glm::mat4 { 1.f }, _mainDrawContext);
+	}
+
+	// The OBJ is Z-up, stand it upright next to the glTF model
+	const std::shared_ptr<LoadedGLTF>& objScene = _loadedScenes["viking_room"];
+	if (_uploadBatcher.IsComplete(objScene->_uploadHandle)) {
+		objScene->FillDrawContext(glm::translate(glm::vec3 { 3.f, 0.f, 0.f }) * glm::rotate(glm::radians(-90.f), glm::vec3 { 1.f, 0.f, 0.f }), _mainDrawContext);
+	}
 
 	const std::chrono::time_point<std::chrono::steady_clock> end = std::chrono::steady_clock::now();
 	const std::chrono::duration<float>                       elapsed = std::chrono::duration<float>(end - start);
@@ -2,14 +2,22 @@
 #define PANTOMIR_ENGINE_H_
 
 #include "Camera.h"
+#include "ThreadPool.h"
 #include "VkDescriptors.h"
 #include "VkLoader.h"
+#include "VkPipelines.h"
 #include "VkTypes.h"
+#include "VkUploadBatcher.h"
+
+#include <chrono>
+#include <map>
+#include <tuple>
 
 struct RenderObject;
 struct ComputeEffect;
 struct LoadedHDRI;
 struct LoadedGLTF;
+struct MipmappedTexture;
 
 struct LinePushConstants {
 	glm::vec4 A;
@@ -30,11 +38,16 @@ struct CameraUBO {
 };
 
 struct EngineStats {
-	float frameTime;
-	int   triangleCount;
-	int   drawcallCount;
-	float sceneUpdateTime;
-	float meshDrawTime;
+	float                                 frameTime;
+	int                                   triangleCount;
+	int                                   drawcallCount;
+	float                                 sceneUpdateTime;
+	float                                 meshDrawTime;
+	float                                 textureDecodeWallTime; // Load-time, accumulated over every LoadGltf call
+	float                                 textureDecodeCpuTime;  // Sum of per-image decode time across all worker threads
+	float                                 timeToFirstFrame;      // From engine construction to the first present, textures may still be streaming in
+	std::array<int, MAX_SURFACE_LODS + 1> lodDrawCounts;         // Opaque and masked surfaces drawn at each level, 0 is full detail
+	bool                                  bGPUDriven;            // Opaque and masked surfaces were culled on the GPU, neither their triangles nor LODs are counted
 };
 
 struct DrawContext {
@@ -55,6 +68,56 @@ struct GPUSceneData {
 };
 static_assert(sizeof(GPUSceneData) % 16 == 0, "GPUSceneData struct must be aligned to 16 bytes.");
 
+// One surface handed to the GPU cluster culling pass. Matches CullObject in meshlet_cull.comp.
+struct GPUClusterCullObject {
+	glm::mat4       transform;
+	VkDeviceAddress meshletBufferAddress;
+	uint32_t        firstMeshlet;
+	uint32_t        meshletCount;
+	uint32_t        firstCommand; // Its indirect commands start here, also the first invocation that culls it
+	float           maxScale;     // Largest axis scale of transform, grows the bounding sphere
+	uint32_t        bConeCulling;
+	uint32_t        PADDING_0;
+};
+static_assert(sizeof(GPUClusterCullObject) == 96, "GPUClusterCullObject must match the std430 layout in meshlet_cull.comp");
+
+constexpr uint32_t CLUSTER_CULL_WORKGROUP_SIZE = 64;
+constexpr uint32_t NO_CLUSTER_CULL_OBJECT = ~0u;
+
+// One opaque or masked surface on the GPU-driven path. Matches DrawObject in draw_object.glsl.
+struct GPUDrawObject {
+	glm::mat4                                 transform;
+	glm::vec4                                 positionOffset; // xyz
+	glm::vec4                                 positionScale;  // xyz
+	glm::vec4                                 boundingSphere; // xyz object space center, w radius
+	VkDeviceAddress                           vertexBufferAddress;
+	uint32_t                                  materialIndex;
+	uint32_t                                  firstIndex; // Full detail, the culling pass swaps in a LOD
+	uint32_t                                  indexCount;
+	int32_t                                   vertexOffset;
+	uint32_t                                  batchIndex;   // Its DrawBatch, also its draw count slot
+	uint32_t                                  firstCommand; // Where its batch's indirect commands start
+	float                                     maxScale;
+	uint32_t                                  lodCount;
+	uint32_t                                  PADDING_0[2];
+	std::array<glm::uvec2, MAX_SURFACE_LODS> lods; // Levels 1 to lodCount, x first index, y index count
+};
+static_assert(sizeof(GPUDrawObject) == 192, "GPUDrawObject must match the std430 layout in draw_object.glsl");
+
+// Surfaces sharing everything a draw binds, recorded as a single indirect draw. Its commands are
+// [firstCommand, firstCommand + commandCount) of the frame's command buffer.
+struct DrawBatch {
+	MaterialPipeline*  pipeline;
+	VkCullModeFlagBits cullMode;
+	VkBuffer           indexBuffer;
+	VkDeviceSize       indexBufferOffset;
+	VkIndexType        indexType;
+	uint32_t           firstCommand;
+	uint32_t           commandCount; // Room for one per surface when the GPU culls, it may fill fewer
+};
+
+constexpr uint32_t OBJECT_CULL_WORKGROUP_SIZE = 64;
+
 struct DeletionQueue {
 	void PushFunction(std::function<void()>&& function) {
 		_deletionQueue.push_back(MakeDeletionTask(std::forward<decltype(function)>(function)));
@@ -91,18 +154,19 @@ struct FrameData {
 
 class PantomirEngine;
 constexpr unsigned int FRAME_OVERLAP = 2;
+constexpr VkDeviceSize UPLOAD_STAGING_RING_SIZE = 64ull * 1024 * 1024;
+constexpr uint32_t     MAX_BINDLESS_TEXTURES = 16384; // Image and sampler pairs in the global texture array
+constexpr uint32_t     MAX_MATERIALS = 16384;         // Entries in the global material buffer
 
 struct GLTFMetallic_Roughness {
+	// Cull mode is dynamic state, single and double sided materials of a pass share its pipeline
 	MaterialPipeline      _opaquePipeline;
 	MaterialPipeline      _transparentPipeline;
 	MaterialPipeline      _maskedPipeline;
-	// TODO: Probably want to do some bindless approach to dynamically switch between single/double sided culling methods
-	MaterialPipeline      _opaqueDoubleSidedPipeline;
-	MaterialPipeline      _transparentDoubleSidedPipeline;
-	MaterialPipeline      _maskedDoubleSidedPipeline;
 
-	VkDescriptorSetLayout _materialDescriptorSetLayout;
+	VkDescriptorSetLayout _materialDescriptorSetLayout; // Set 1, the material buffer and the bindless texture array
 	VkPipelineLayout      _pipelineLayout;
+	PipelineBuildGroup    _pipelineBuilds; // All three above, DrawGeometry waits on them
 
 	// Make sure this is aligned properly.
 	struct MaterialConstants {
@@ -129,16 +193,57 @@ struct GLTFMetallic_Roughness {
 		AllocatedImage specularImage;
 		VkSampler      specularSampler;
 
-		VkBuffer       dataBuffer;
-		uint32_t       dataBufferOffset;
+		MaterialConstants constants;
 	};
 
-	DescriptorSetWriter _writer;
+	// One entry of the global material buffer, matches MaterialData in input_structures.glsl
+	struct GPUMaterial {
+		MaterialConstants constants;
+		uint32_t          colorTexture; // Into the bindless texture array
+		uint32_t          metalRoughTexture;
+		uint32_t          emissiveTexture;
+		uint32_t          normalTexture;
+		uint32_t          specularTexture;
+		uint32_t          PADDING_0[3];
+	};
+	static_assert(sizeof(GPUMaterial) % 16 == 0, "SSBO struct must be aligned to 16 bytes.");
+
+	// Every material lives in one buffer and samples one texture array, so a single descriptor set serves all of them.
+	// Textures are deduplicated by image and sampler, a slot is recycled once no material samples it anymore and every
+	// frame that could still sample it has retired.
+	struct BindlessTexture {
+		VkImageView imageView;
+		VkSampler   sampler;
+		uint32_t    refCount;
+	};
 
-	void                BuildPipelines(PantomirEngine* engine);
-	void                ClearResources(VkDevice device) const;
+	VkDescriptorPool                                     _bindlessDescriptorPool {};
+	VkDescriptorSet                                      _bindlessDescriptorSet {}; // Bound once per frame
+	AllocatedBuffer                                      _materialBuffer {};
+	GPUMaterial*                                         _gpuMaterials = nullptr; // Mapped _materialBuffer
+	std::vector<GPUMaterial>                             _materials;              // What _gpuMaterials holds, without reading back mapped memory
+	std::vector<uint32_t>                                _freeMaterialIndices;
+	std::vector<BindlessTexture>                         _textures;
+	std::vector<uint32_t>                                _freeTextureIndices;
+	std::map<std::pair<VkImageView, VkSampler>, uint32_t> _textureIndexByView;
+	PantomirEngine*                                      _enginePtr = nullptr; // Set by InitMaterialTable
+
+	DescriptorSetWriter                                  _writer;
+
+	void                                                 InitMaterialTable(PantomirEngine* engine);
+	void                                                 ClearMaterialTable(PantomirEngine* engine);
+	void                                                 BuildPipelines(PantomirEngine* engine);
+	void                                                 ClearResources(VkDevice device);
+
+	uint32_t                                             AllocateMaterial();
+	void                                                 FreeMaterial(uint32_t materialIndex);
+	// Writes the material's entry in place. Frames in flight may read it, which is fine as long as every texture it
+	// swaps in is already uploaded.
+	MaterialInstance                                     WriteMaterial(VkDevice device, MaterialPass passType, VkCullModeFlagBits cullMode, const MaterialResources& resources, uint32_t materialIndex);
 
-	MaterialInstance    WriteMaterial(VkDevice device, MaterialPass passType, VkCullModeFlagBits cullMode, const MaterialResources& resources, DescriptorPoolManager& descriptorPoolManager);
+private:
+	uint32_t                                             AcquireTexture(VkDevice device, VkImageView imageView, VkSampler sampler);
+	void                                                 ReleaseTexture(uint32_t textureIndex);
 };
 
 inline bool IsVisible(const RenderObject& renderObject, const glm::mat4& viewProjection) {
@@ -183,27 +288,169 @@ inline bool IsVisible(const RenderObject& renderObject, const glm::mat4& viewPro
 	return !outOfBounds;
 }
 
-inline void BuildDrawListByMaterialMesh(const std::vector<RenderObject>& surfaces,
-                                        const glm::mat4&                 viewProjection,
-                                        std::vector<uint32_t>&           out_indices) {
+// Left, right, bottom, top, near, far. Normalized, a point is inside when dot(plane.xyz, point) + plane.w >= 0.
+inline std::array<glm::vec4, 6> ExtractFrustumPlanes(const glm::mat4& viewProjection) {
+	const glm::mat4          rows = glm::transpose(viewProjection);
+	std::array<glm::vec4, 6> planes {
+		rows[3] + rows[0],
+		rows[3] - rows[0],
+		rows[3] + rows[1],
+		rows[3] - rows[1],
+		rows[2],
+		rows[3] - rows[2],
+	};
+
+	for (glm::vec4& plane : planes) {
+		const float length = glm::length(glm::vec3(plane));
+		if (length > 0.0F) {
+			plane /= length;
+		}
+	}
+	return planes;
+}
+
+inline float GetMaxScale(const glm::mat4& transform) {
+	return glm::sqrt(glm::max(glm::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+	                                   glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1]))),
+	                          glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))));
+}
+
+// Normal cones only hold for back-face culled materials, under transforms that keep angles and winding.
+inline bool CanConeCull(const RenderObject& renderObject) {
+	if (renderObject.material->cullMode == VK_CULL_MODE_NONE || glm::determinant(glm::mat3(renderObject.transform)) <= 0.0F) {
+		return false;
+	}
+
+	const float scaleX = glm::length(glm::vec3(renderObject.transform[0]));
+	const float scaleY = glm::length(glm::vec3(renderObject.transform[1]));
+	const float scaleZ = glm::length(glm::vec3(renderObject.transform[2]));
+	return glm::abs(scaleX - scaleY) <= scaleX * 0.01F && glm::abs(scaleX - scaleZ) <= scaleX * 0.01F;
+}
+
+// CPU mirror of the test in meshlet_cull.comp.
+inline bool IsMeshletVisible(const Meshlet&                  meshlet,
+                             const glm::mat4&                transform,
+                             const float                     maxScale,
+                             const bool                      bConeCulling,
+                             const std::array<glm::vec4, 6>& frustumPlanes,
+                             const glm::vec3&                cameraPosition) {
+	const glm::vec3 center = glm::vec3(transform * glm::vec4(meshlet.center, 1.0F));
+	const float     radius = meshlet.radius * maxScale;
+
+	for (const glm::vec4& plane : frustumPlanes) {
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+			return false;
+		}
+	}
+
+	// Every triangle faces away when the view direction stays within the cone's cutoff of its axis, from anywhere in the sphere
+	if (bConeCulling) {
+		const glm::vec3 axis = glm::normalize(glm::mat3(transform) * meshlet.coneAxis);
+		const glm::vec3 toCenter = center - cameraPosition;
+		if (glm::dot(toCenter, axis) >= meshlet.coneCutoff * glm::length(toCenter) + radius) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Meshlets tile their surface in index order, so each run of visible neighbors is a single index range.
+// Calls drawRun(firstIndex, indexCount) once per run.
+template <typename DrawRunFunction>
+void ForEachVisibleMeshletRun(const RenderObject&             renderObject,
+                              const std::array<glm::vec4, 6>& frustumPlanes,
+                              const glm::vec3&                cameraPosition,
+                              DrawRunFunction&&               drawRun) {
+	const float maxScale = GetMaxScale(renderObject.transform);
+	const bool  bConeCulling = CanConeCull(renderObject);
+	uint32_t    runFirstIndex = 0;
+	uint32_t    runIndexCount = 0;
+
+	for (const Meshlet& meshlet : renderObject.meshlets) {
+		if (!IsMeshletVisible(meshlet, renderObject.transform, maxScale, bConeCulling, frustumPlanes, cameraPosition)) {
+			if (runIndexCount != 0) {
+				drawRun(runFirstIndex, runIndexCount);
+				runIndexCount = 0;
+			}
+			continue;
+		}
+		if (runIndexCount == 0) {
+			runFirstIndex = meshlet.firstIndex;
+		}
+		runIndexCount += meshlet.indexCount;
+	}
+
+	if (runIndexCount != 0) {
+		drawRun(runFirstIndex, runIndexCount);
+	}
+}
+
+// Swaps renderObject's index range for the LOD matching its bounding sphere's projected size, as a fraction of the
+// screen height. Each level halves the triangles, so each halving of the size below screenSizeThreshold drops one.
+// projectionScale is the projection's cotangent of half the vertical field of view. Returns the level it picked.
+inline uint32_t SelectSurfaceLOD(RenderObject& renderObject, const glm::vec3& cameraPosition, const float projectionScale, const float screenSizeThreshold) {
+	if (renderObject.lods.empty()) {
+		return 0;
+	}
+
+	const glm::vec3 center = glm::vec3(renderObject.transform * glm::vec4(renderObject.bounds.originPoint, 1.0F));
+	const float     radius = renderObject.bounds.sphereRadius * GetMaxScale(renderObject.transform);
+	const float     distance = glm::length(center - cameraPosition);
+	if (distance <= radius) {
+		return 0;
+	}
+
+	const float screenSize = radius * projectionScale / distance;
+	if (screenSize >= screenSizeThreshold) {
+		return 0;
+	}
+
+	// A zero screen size would take the log of infinity, it is as coarse as it gets
+	const uint32_t    lodCount = static_cast<uint32_t>(renderObject.lods.size());
+	const uint32_t    level = screenSize <= 0.0F ? lodCount : std::min(static_cast<uint32_t>(std::log2(screenSizeThreshold / screenSize)) + 1, lodCount);
+	const SurfaceLOD& lod = renderObject.lods[level - 1];
+	renderObject.firstIndex = lod.startIndex;
+	renderObject.indexCount = lod.count;
+	renderObject.meshlets = {}; // They tile the full-detail range only
+	return level;
+}
+
+inline void BuildDrawListByMaterialMesh(std::vector<RenderObject>&             surfaces,
+                                        const glm::mat4&                       viewProjection,
+                                        const glm::vec3&                       cameraPosition,
+                                        const float                            projectionScale,
+                                        const float                            lodScreenSizeThreshold,
+                                        const bool                             bBatchDraws,
+                                        std::array<int, MAX_SURFACE_LODS + 1>& out_lodDrawCounts,
+                                        std::vector<uint32_t>&                 out_indices) {
 	out_indices.clear();
 	out_indices.reserve(surfaces.size());
 
-	// Visibility culling
+	// Visibility culling, then LOD selection for the survivors
 	for (uint32_t index = 0; index < static_cast<uint32_t>(surfaces.size()); ++index) {
 		if (IsVisible(surfaces[index], viewProjection)) {
 			out_indices.push_back(index);
+			++out_lodDrawCounts[SelectSurfaceLOD(surfaces[index], cameraPosition, projectionScale, lodScreenSizeThreshold)];
 		}
 	}
 
-	// Sort by material, then by mesh index
+	// Batched draws read their material from the material buffer, leaving it out of the key makes the batches longer
+	if (bBatchDraws) {
+		std::ranges::sort(out_indices, [&](const uint32_t& a, const uint32_t& b) {
+			const RenderObject& A = surfaces[a];
+			const RenderObject& B = surfaces[b];
+			return std::tie(A.material->pipeline, A.material->cullMode, A.indexBuffer, A.indexType) <
+			       std::tie(B.material->pipeline, B.material->cullMode, B.indexBuffer, B.indexType); });
+		return;
+	}
+
+	// Sort by pipeline, then cull mode, then material, then by mesh index
 	std::ranges::sort(out_indices, [&](const uint32_t& a, const uint32_t& b) {
 		const RenderObject& A = surfaces[a];
 		const RenderObject& B = surfaces[b];
-		if (A.material == B.material) {
-			return A.indexBuffer < B.indexBuffer;
-		}
-		return A.material < B.material; });
+		return std::tie(A.material->pipeline, A.material->cullMode, A.material, A.indexBuffer, A.indexType) <
+		       std::tie(B.material->pipeline, B.material->cullMode, B.material, B.indexBuffer, B.indexType); });
 }
 
 inline void BuildDrawListTransparent(const std::vector<RenderObject>& surfaces,
@@ -236,19 +483,33 @@ public:
 
 	EngineStats              _stats {};
 
+	Pantomir::ThreadPool     _threadPool;
+
 	Camera                   _mainCamera {};
 
 	VkPipelineLayout         _hdriPipelineLayout {};
 	VkPipeline               _hdriPipeline {};
+	PipelineBuildGroup       _hdriPipelineBuild;
 
 	VkPipelineLayout         _debugLinePipelineLayout {};
 	VkPipeline               _debugLinePipeline {};
+	PipelineBuildGroup       _debugLinePipelineBuild;
 	std::vector<DebugLine>   _debugLines;
 
+	VkPipelineLayout         _clusterCullPipelineLayout {};
+	VkPipeline               _clusterCullPipeline {};
+	PipelineBuildGroup       _clusterCullPipelineBuild;
+
+	VkPipelineLayout         _objectCullPipelineLayout {};
+	VkPipeline               _objectCullPipeline {};
+	PipelineBuildGroup       _objectCullPipelineBuild;
+
 	VkFence                  _immediateFence {};
 	VkCommandBuffer          _immediateCommandBuffer {};
 	VkCommandPool            _immediateCommandPool {};
 
+	UploadBatcher            _uploadBatcher {};
+
 	GPUSceneData             _sceneData {};
 	VkDescriptorSetLayout    _gpuSceneDataDescriptorSetLayout {};
 	VkDescriptorSetLayout    _hdriDescriptorSetLayout {};
@@ -276,6 +537,7 @@ public:
 	VkPhysicalDevice         _physicalGPU {};    // GPU chosen as the default device
 	VkDevice                 _logicalGPU {};     // Vulkan device for commands
 	VkSurfaceKHR             _surface {};        // Vulkan window surface
+	VkPipelineCache          _pipelineCache {};  // Every pipeline is created through it, persisted under Cache/
 
 	VkSwapchainKHR           _swapchain {};
 	VkFormat                 _swapchainImageFormat {};
@@ -292,8 +554,22 @@ public:
 
 	VkQueue                                                      _graphicsQueue {};
 	uint32_t                                                     _graphicsQueueFamilyIndex {};
+	VkQueue                                                      _transferQueue {};            // Same as _graphicsQueue when the device has no separate transfer family
+	uint32_t                                                     _transferQueueFamilyIndex {};
+	bool                                                         _bTextureCompressionBC = false; // Optional feature, textures stay RGBA8 without it
+	uint32_t                                                     _maxImageDimension2D = 0;       // Device limit, DDS and KTX2 images above it are rejected
+	bool                                                         _bOptimizeMeshes = true;        // Cook glTF geometry through OptimizeMesh
+	bool                                                         _bStreamTextures = true;        // Draw glTF scenes with placeholder textures while theirs decode in the background
+	bool                                                         _bMultiDrawIndirect = false;    // Optional features batched draws need
+	bool                                                         _bDrawIndirectCount = false;    // Optional features the GPU cluster culling path needs, on top of _bMultiDrawIndirect
+	bool                                                         _bBatchDraws = true;            // Write CPU-culled opaque and masked draws into one indirect draw per batch, needs _bMultiDrawIndirect
+	bool                                                         _bClusterCulling = true;        // Cull surfaces per meshlet, not only as a whole
+	bool                                                         _bGPUClusterCulling = true;     // Cull opaque and masked meshlets in a compute pass, needs _bDrawIndirectCount
+	bool                                                         _bGPUDrivenRendering = false;   // Cull, pick LODs and batch opaque and masked surfaces in a compute pass, needs _bDrawIndirectCount
+	float                                                        _lodScreenSizeThreshold = 0.5f; // Surfaces smaller than this fraction of the screen height start dropping LODs
 
 	std::unordered_map<std::string, std::shared_ptr<LoadedGLTF>> _loadedScenes;
+	std::unordered_map<std::string, std::string>                 _hdriPaths; // Every selectable HDRI, loaded into _loadedHDRIs the first time it is picked
 	std::unordered_map<std::string, std::shared_ptr<LoadedHDRI>> _loadedHDRIs;
 	std::shared_ptr<LoadedHDRI>                                  _currentHDRI;
 
@@ -327,20 +603,24 @@ public:
 	void                          MainLoop();
 	void                          ImmediateSubmit(std::function<void(VkCommandBuffer cmd)>&& anonymousFunction) const;
 
-	[[nodiscard]] GPUMeshBuffers  UploadMesh(std::span<uint32_t> indices, std::span<Vertex> vertices) const;
+	[[nodiscard]] GPUMeshBuffers  UploadMesh(std::span<const uint16_t> indices16, std::span<const uint32_t> indices32, std::span<const PackedVertex> vertices);
 
 	[[nodiscard]] glm::mat4       GetProjectionMatrix() const;
 
-	AllocatedImage                CreateImage(void* dataSource, const VkExtent3D size, const VkFormat format, const VkImageUsageFlags usage, const bool mipmapped = false) const;
+	[[nodiscard]] AllocatedImage  AllocateImage(VkExtent3D size, VkFormat format, VkImageUsageFlags usage, uint32_t mipLevels, bool bCubemap = false) const;
+	AllocatedImage                CreateImage(void* dataSource, const VkExtent3D size, const VkFormat format, const VkImageUsageFlags usage, const bool mipmapped = false);
+	AllocatedImage                CreateImage(const MipmappedTexture& texture, VkImageUsageFlags usage);
 	void                          DestroyImage(const AllocatedImage& img) const;
 
 	[[nodiscard]] AllocatedBuffer CreateBuffer(size_t allocSize, VkBufferUsageFlags bufferUsage, VmaMemoryUsage memoryUsage) const;
 	void                          DestroyBuffer(const AllocatedBuffer& buffer) const;
+	[[nodiscard]] VkDeviceAddress GetBufferDeviceAddress(const AllocatedBuffer& buffer) const;
 
 private:
-	float _deltaTime = 0.0F;
-	float _minDeltaTimeClamp = 0.0001F;
-	float _maxDeltaTimeClamp = 0.016F;
+	float                                              _deltaTime = 0.0F;
+	float                                              _minDeltaTimeClamp = 0.0001F;
+	float                                              _maxDeltaTimeClamp = 0.016F;
+	std::chrono::time_point<std::chrono::steady_clock> _startTime = std::chrono::steady_clock::now(); // Before any Init step runs
 
 	PantomirEngine();
 	~PantomirEngine();
@@ -356,6 +636,8 @@ private:
 	void InitImgui();
 	void InitHDRIPipeline();
 	void InitDebugLinePipeline();
+	void InitClusterCullPipeline();
+	void InitObjectCullPipeline();
 	void InitDefaultData();
 
 	void CreateSwapchain(uint32_t width, uint32_t height);
@@ -372,6 +654,9 @@ private:
 	void Draw();
 	void DrawHDRI(VkCommandBuffer commandBuffer);
 	void DrawGeometry(VkCommandBuffer commandBuffer);
+	void RecordClusterCulling(VkCommandBuffer commandBuffer, std::span<const GPUClusterCullObject> cullObjects, uint32_t meshletCount, AllocatedBuffer& out_drawCommandBuffer, AllocatedBuffer& out_drawCountBuffer);
+	void BuildDrawBatches(const std::array<glm::vec4, 6>& frustumPlanes, std::span<const uint32_t> opaqueDraws, std::span<const uint32_t> opaqueCullObjects, std::span<const uint32_t> maskedDraws, std::span<const uint32_t> maskedCullObjects, std::vector<DrawBatch>& out_drawBatches, AllocatedBuffer& out_drawObjectBuffer, AllocatedBuffer& out_drawCommandBuffer);
+	void RecordObjectCulling(VkCommandBuffer commandBuffer, float projectionScale, std::vector<DrawBatch>& out_drawBatches, AllocatedBuffer& out_drawObjectBuffer, AllocatedBuffer& out_drawCommandBuffer, AllocatedBuffer& out_drawCountBuffer);
 	void DrawImgui(VkCommandBuffer commandBuffer, VkImageView targetImageView) const;
 	void DrawDebugLines(VkCommandBuffer commandBuffer, const std::vector<DebugLine>& DebugLines);
 
@@ -13,8 +13,48 @@ size_t PantomirFunctionLibrary::BytesPerPixelFromFormat(const VkFormat format) {
 		case VK_FORMAT_R16G16B16A16_SFLOAT:
 			return 8;
 		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
 			return 4;
 		default:
 			throw std::runtime_error("Unhandled format in BytesPerPixelFromFormat");
 	}
-}
\ No newline at end of file
+}
+
+bool PantomirFunctionLibrary::IsBlockCompressedFormat(const VkFormat format) {
+	switch (format) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+			return true;
+		default:
+			return false;
+	}
+}
+
+uint32_t PantomirFunctionLibrary::BlockDimensionFromFormat(const VkFormat format) {
+	return IsBlockCompressedFormat(format) ? 4 : 1;
+}
+
+size_t PantomirFunctionLibrary::BytesPerBlockFromFormat(const VkFormat format) {
+	switch (format) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			return 8; // 4x4 texels, 4 bits each
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+			return 16; // 4x4 texels, 8 bits each
+		default:
+			return BytesPerPixelFromFormat(format);
+	}
+}
+
+size_t PantomirFunctionLibrary::ImageSizeFromFormat(const VkFormat format, const VkExtent3D extent) {
+	// Partial blocks at the edges still take a whole block
+	const uint32_t blockDimension = BlockDimensionFromFormat(format);
+	const size_t   blocksWide = (static_cast<size_t>(extent.width) + blockDimension - 1) / blockDimension;
+	const size_t   blocksHigh = (static_cast<size_t>(extent.height) + blockDimension - 1) / blockDimension;
+	return blocksWide * blocksHigh * extent.depth * BytesPerBlockFromFormat(format);
+}
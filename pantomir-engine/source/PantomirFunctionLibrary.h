@@ -8,6 +8,12 @@ struct PantomirFunctionLibrary {
 	constexpr static float GOLDEN_RATIO = 1.6180339887498948482045868343656381f;
 
 	static size_t          BytesPerPixelFromFormat(const VkFormat format);
+
+	// Block-compressed formats store 4x4 texel blocks, uncompressed formats are treated as 1x1 blocks.
+	static bool            IsBlockCompressedFormat(const VkFormat format);
+	static uint32_t        BlockDimensionFromFormat(const VkFormat format);
+	static size_t          BytesPerBlockFromFormat(const VkFormat format);
+	static size_t          ImageSizeFromFormat(const VkFormat format, const VkExtent3D extent);
 };
 
 #endif /* PANTOMIRFUNCTIONLIBRARY_H_ */
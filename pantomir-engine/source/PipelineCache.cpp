@@ -0,0 +1,151 @@
+#include "PipelineCache.h"
+
+#include "ContentHash.h"
+#include "LoggerMacros.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace {
+	constexpr uint32_t PIPELINE_CACHE_MAGIC = 0x43505050; // "PPPC"
+	constexpr uint32_t PIPELINE_CACHE_VERSION = 1;
+
+	// Drivers check their own header too, but not all of them reject a blob from another driver version gracefully
+	struct PipelineCacheHeader {
+		uint32_t                          magic;
+		uint32_t                          version;
+		uint32_t                          vendorID;
+		uint32_t                          deviceID;
+		uint32_t                          driverVersion;
+		std::array<uint8_t, VK_UUID_SIZE> pipelineCacheUUID;
+		uint64_t                          dataSize;
+		ContentHash                       dataHash; // Catches a truncated or partially written blob
+	};
+
+	PipelineCacheHeader MakeHeader(const VkPhysicalDeviceProperties& properties) {
+		PipelineCacheHeader header {};
+		header.magic = PIPELINE_CACHE_MAGIC;
+		header.version = PIPELINE_CACHE_VERSION;
+		header.vendorID = properties.vendorID;
+		header.deviceID = properties.deviceID;
+		header.driverVersion = properties.driverVersion;
+		std::ranges::copy(properties.pipelineCacheUUID, header.pipelineCacheUUID.begin());
+		return header;
+	}
+
+	// The cached blob, empty when the file doesn't match this device and driver
+	std::span<const std::byte> ValidateCacheFile(const Pantomir::MappedFile& cacheFile, const VkPhysicalDeviceProperties& properties) {
+		if (!cacheFile.IsOpen() || cacheFile.Size() < sizeof(PipelineCacheHeader)) {
+			return {};
+		}
+
+		PipelineCacheHeader header;
+		memcpy(&header, cacheFile.Data(), sizeof(header));
+		const PipelineCacheHeader expected = MakeHeader(properties);
+		if (header.magic != expected.magic || header.version != expected.version) {
+			return {};
+		}
+		if (header.vendorID != expected.vendorID || header.deviceID != expected.deviceID || header.driverVersion != expected.driverVersion ||
+		    header.pipelineCacheUUID != expected.pipelineCacheUUID) {
+			LOG(Engine, Info, "Pipeline cache was written by another device or driver, it will be rebuilt");
+			return {};
+		}
+		if (header.dataSize != cacheFile.Size() - sizeof(PipelineCacheHeader)) {
+			return {};
+		}
+
+		const std::span<const std::byte> data = cacheFile.Bytes().subspan(sizeof(PipelineCacheHeader));
+		if (ContentHash::FromBytes(data) != header.dataHash) {
+			return {};
+		}
+		return data;
+	}
+} // namespace
+
+std::filesystem::path GetPipelineCachePath() {
+	return std::filesystem::path("Cache") / "pipelines.ppc";
+}
+
+VkPipelineCache LoadPipelineCache(const VkDevice device, const VkPhysicalDeviceProperties& properties, const std::filesystem::path& cachePath, bool& out_bWarm) {
+	Pantomir::MappedFile cacheFile;
+	if (!cacheFile.Open(cachePath)) {
+		LOG(Engine, Info, "No pipeline cache at '{}', pipelines compile cold", cachePath.string());
+	}
+
+	const std::span<const std::byte> data = ValidateCacheFile(cacheFile, properties);
+	VkPipelineCacheCreateInfo        createInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+	createInfo.initialDataSize = data.size();
+	createInfo.pInitialData = data.data();
+
+	VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+	if (vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache) == VK_SUCCESS) {
+		out_bWarm = !data.empty();
+		return pipelineCache;
+	}
+
+	// The driver turned the blob down after all
+	LOG(Engine, Warning, "Driver rejected the pipeline cache at '{}', starting empty", cachePath.string());
+	createInfo.initialDataSize = 0;
+	createInfo.pInitialData = nullptr;
+	VK_CHECK(vkCreatePipelineCache(device, &createInfo, nullptr, &pipelineCache));
+	out_bWarm = false;
+	return pipelineCache;
+}
+
+bool SavePipelineCache(const VkDevice device, const VkPhysicalDeviceProperties& properties, const VkPipelineCache pipelineCache, const std::filesystem::path& cachePath) {
+	size_t dataSize = 0;
+	if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+		return false;
+	}
+
+	std::vector<std::byte> data(dataSize);
+	if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+		return false;
+	}
+	data.resize(dataSize);
+
+	std::error_code directoryError;
+	std::filesystem::create_directories(cachePath.parent_path(), directoryError);
+	if (directoryError) {
+		LOG(Engine, Warning, "Failed to create pipeline cache directory '{}': {}", cachePath.parent_path().string(), directoryError.message());
+		return false;
+	}
+
+	PipelineCacheHeader header = MakeHeader(properties);
+	header.dataSize = data.size();
+	header.dataHash = ContentHash::FromBytes(data);
+
+	// Write next to the final path and rename, so a crash mid-write never leaves a cache that looks valid
+	std::filesystem::path temporaryPath = cachePath;
+	temporaryPath += ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			LOG(Engine, Warning, "Failed to create pipeline cache '{}'", temporaryPath.string());
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		if (!file.good()) {
+			LOG(Engine, Warning, "Failed to write pipeline cache '{}'", temporaryPath.string());
+			file.close();
+			std::filesystem::remove(temporaryPath, directoryError);
+			return false;
+		}
+	}
+
+	std::error_code renameError;
+	std::filesystem::rename(temporaryPath, cachePath, renameError);
+	if (renameError) {
+		LOG(Engine, Warning, "Failed to move pipeline cache into place '{}': {}", cachePath.string(), renameError.message());
+		std::filesystem::remove(temporaryPath, renameError);
+		return false;
+	}
+
+	LOG(Engine, Info, "Saved {} KB pipeline cache to '{}'", data.size() / 1024, cachePath.string());
+	return true;
+}
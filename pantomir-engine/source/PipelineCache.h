@@ -0,0 +1,17 @@
+#ifndef PIPELINECACHE_H_
+#define PIPELINECACHE_H_
+
+#include "VkTypes.h"
+
+#include <filesystem>
+
+// The driver's VkPipelineCache blob, kept under Cache/ between runs so pipelines compiled once are not compiled again.
+// The blob is only reused on the device and driver version that wrote it, anything else starts from an empty cache.
+
+std::filesystem::path GetPipelineCachePath();
+
+// Never fails, a missing, stale or corrupt file gives an empty cache. out_bWarm tells whether the file was reused.
+VkPipelineCache       LoadPipelineCache(VkDevice device, const VkPhysicalDeviceProperties& properties, const std::filesystem::path& cachePath, bool& out_bWarm);
+bool                  SavePipelineCache(VkDevice device, const VkPhysicalDeviceProperties& properties, VkPipelineCache pipelineCache, const std::filesystem::path& cachePath);
+
+#endif /*! PIPELINECACHE_H_ */
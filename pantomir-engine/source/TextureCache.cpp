@@ -0,0 +1,573 @@
+#include "TextureCache.h"
+
+#include "LoggerMacros.h"
+#include "PantomirFunctionLibrary.h"
+#include "ThreadPool.h"
+#include "VkLoader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PANTOMIR_TEXTURE_SSE2 1
+#endif
+
+namespace {
+	constexpr uint32_t TEXTURE_CACHE_MAGIC = 0x58455450; // "PTEX"
+	constexpr uint32_t TEXTURE_CACHE_VERSION = 1;
+	constexpr uint32_t TEXTURE_CACHE_MAX_MIPS = 16;      // Enough for 32768x32768
+	constexpr uint64_t TEXTURE_CACHE_DATA_ALIGNMENT = 16;
+
+	struct TextureCacheMip {
+		uint64_t offset; // Relative to the start of the file
+		uint64_t size;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	struct TextureCacheHeader {
+		uint32_t                                             magic;
+		uint32_t                                             version;
+		uint32_t                                             width;
+		uint32_t                                             height;
+		uint32_t                                             format;
+		uint32_t                                             mipCount;
+		std::array<TextureCacheMip, TEXTURE_CACHE_MAX_MIPS> mips;
+	};
+
+	constexpr uint64_t AlignUp(const uint64_t value, const uint64_t alignment) {
+		return ((value + alignment - 1) / alignment) * alignment;
+	}
+
+	// Only what BuildMipChain and CompressMipChain produce is ever written, anything else is a corrupt or foreign file
+	bool IsCachedFormat(const VkFormat format) {
+		switch (format) {
+			case VK_FORMAT_R8G8B8A8_UNORM:
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	// One destination pixel from up to four source pixels. Coordinates are clamped, so odd edges and 1-wide levels reuse their last texel.
+	void DownsamplePixelScalar(const uint8_t* source, const uint32_t sourceWidth, const uint32_t sourceHeight, const uint32_t x, const uint32_t y, uint8_t* destination) {
+		const uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+		const uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+		const uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+		const uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+
+		const uint8_t* p00 = source + (static_cast<size_t>(y0) * sourceWidth + x0) * 4;
+		const uint8_t* p01 = source + (static_cast<size_t>(y0) * sourceWidth + x1) * 4;
+		const uint8_t* p10 = source + (static_cast<size_t>(y1) * sourceWidth + x0) * 4;
+		const uint8_t* p11 = source + (static_cast<size_t>(y1) * sourceWidth + x1) * 4;
+		for (int channel = 0; channel < 4; ++channel) {
+			destination[channel] = static_cast<uint8_t>((p00[channel] + p01[channel] + p10[channel] + p11[channel] + 2) >> 2);
+		}
+	}
+
+	void DownsampleRGBA8(const uint8_t* source, const uint32_t sourceWidth, const uint32_t sourceHeight, uint8_t* destination, const uint32_t width, const uint32_t height) {
+		for (uint32_t y = 0; y < height; ++y) {
+			uint8_t* destinationRow = destination + static_cast<size_t>(y) * width * 4;
+			uint32_t x = 0;
+
+#ifdef PANTOMIR_TEXTURE_SSE2
+			// Only full 2x2 footprints can take the vector path, which is every pixel unless a side is already 1 texel wide.
+			if (sourceWidth >= 2 && sourceHeight >= 2) {
+				const uint8_t* row0 = source + static_cast<size_t>(y * 2) * sourceWidth * 4;
+				const uint8_t* row1 = row0 + static_cast<size_t>(sourceWidth) * 4;
+				const __m128i  zero = _mm_setzero_si128();
+				const __m128i  rounding = _mm_set1_epi16(2);
+
+				// 8 source texels per row in, 4 destination texels out
+				for (; x + 4 <= width; x += 4) {
+					const __m128i top0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+					const __m128i top1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+					const __m128i bottom0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+					const __m128i bottom1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+					// Vertical sums in 16 bits, two texels per register
+					const __m128i columns01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero), _mm_unpacklo_epi8(bottom0, zero));
+					const __m128i columns23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero), _mm_unpackhi_epi8(bottom0, zero));
+					const __m128i columns45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero), _mm_unpacklo_epi8(bottom1, zero));
+					const __m128i columns67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero), _mm_unpackhi_epi8(bottom1, zero));
+
+					// Horizontal sums: pair even columns with odd columns
+					const __m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi64(columns01, columns23), _mm_unpackhi_epi64(columns01, columns23));
+					const __m128i sum23 = _mm_add_epi16(_mm_unpacklo_epi64(columns45, columns67), _mm_unpackhi_epi64(columns45, columns67));
+
+					const __m128i average01 = _mm_srli_epi16(_mm_add_epi16(sum01, rounding), 2);
+					const __m128i average23 = _mm_srli_epi16(_mm_add_epi16(sum23, rounding), 2);
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(destinationRow + x * 4), _mm_packus_epi16(average01, average23));
+				}
+			}
+#endif
+
+			for (; x < width; ++x) {
+				DownsamplePixelScalar(source, sourceWidth, sourceHeight, x, y, destinationRow + x * 4);
+			}
+		}
+	}
+
+	// Same clamped 2x2 footprint as DownsamplePixelScalar, on RGB floats
+	void DownsampleRGB32F(const float* source, const uint32_t sourceWidth, const uint32_t sourceHeight, float* destination, const uint32_t width, const uint32_t height) {
+		for (uint32_t y = 0; y < height; ++y) {
+			const uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+			const uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+			for (uint32_t x = 0; x < width; ++x) {
+				const uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+				const uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+
+				const float*   p00 = source + (static_cast<size_t>(y0) * sourceWidth + x0) * 3;
+				const float*   p01 = source + (static_cast<size_t>(y0) * sourceWidth + x1) * 3;
+				const float*   p10 = source + (static_cast<size_t>(y1) * sourceWidth + x0) * 3;
+				const float*   p11 = source + (static_cast<size_t>(y1) * sourceWidth + x1) * 3;
+				float*         out = destination + (static_cast<size_t>(y) * width + x) * 3;
+				for (int channel = 0; channel < 3; ++channel) {
+					out[channel] = (p00[channel] + p01[channel] + p10[channel] + p11[channel]) * 0.25f;
+				}
+			}
+		}
+	}
+
+	// E5B9G9R9 as laid out in the Vulkan spec: three 9-bit mantissas sharing a 5-bit exponent, biased by 15.
+	// Negative and NaN channels become 0, anything past the format's range saturates.
+	uint32_t PackRGB9E5(const float* rgb) {
+		constexpr int   MANTISSA_BITS = 9;
+		constexpr int   EXPONENT_BIAS = 15;
+		constexpr float MAX_VALUE = 65408.0f; // (511 / 512) * 2^16
+
+		std::array<float, 3> channels {};
+		float                maxChannel = 0.0f;
+		for (int channel = 0; channel < 3; ++channel) {
+			channels[channel] = rgb[channel] > 0.0f ? std::min(rgb[channel], MAX_VALUE) : 0.0f;
+			maxChannel = std::max(maxChannel, channels[channel]);
+		}
+
+		int   sharedExponent = std::max(-EXPONENT_BIAS - 1, static_cast<int>(std::floor(std::log2(std::max(maxChannel, 1e-30f))))) + 1 + EXPONENT_BIAS;
+		float scale = std::exp2(static_cast<float>(EXPONENT_BIAS + MANTISSA_BITS - sharedExponent));
+		if (static_cast<uint32_t>(std::floor(maxChannel * scale + 0.5f)) == (1u << MANTISSA_BITS)) {
+			// Rounding overflowed the mantissa, go one exponent up
+			++sharedExponent;
+			scale *= 0.5f;
+		}
+
+		uint32_t packed = static_cast<uint32_t>(sharedExponent) << 27;
+		for (int channel = 0; channel < 3; ++channel) {
+			packed |= static_cast<uint32_t>(std::floor(channels[channel] * scale + 0.5f)) << (channel * MANTISSA_BITS);
+		}
+		return packed;
+	}
+
+	// Direction through texel (s, t) of a face is axis + s * sAxis + t * tAxis, s and t in [-1, 1] with t growing down
+	// the rows. Matches the face selection rules of the Vulkan spec, so a cube lookup returns the texel built here.
+	struct CubeFace {
+		glm::vec3 axis;
+		glm::vec3 sAxis;
+		glm::vec3 tAxis;
+	};
+
+	const std::array<CubeFace, CUBEMAP_FACE_COUNT> CUBE_FACES { {
+		{ { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f, 0.0f } },  // +X
+		{ { -1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f } },  // -X
+		{ { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } },    // +Y
+		{ { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },  // -Y
+		{ { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } },   // +Z
+		{ { 0.0f, 0.0f, -1.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, -1.0f, 0.0f } }, // -Z
+	} };
+
+	// Bilinear tap of the panorama. Longitude wraps, latitude clamps at the poles.
+	void SampleEquirect(const float* rgb, const VkExtent3D extent, const float u, const float v, float* out) {
+		const float    x = u * static_cast<float>(extent.width) - 0.5f;
+		const float    y = std::clamp(v * static_cast<float>(extent.height) - 0.5f, 0.0f, static_cast<float>(extent.height - 1));
+		const float    xFloor = std::floor(x);
+		const float    yFloor = std::floor(y);
+		const float    fx = x - xFloor;
+		const float    fy = y - yFloor;
+
+		const int64_t  width = extent.width;
+		const uint32_t x0 = static_cast<uint32_t>(((static_cast<int64_t>(xFloor) % width) + width) % width);
+		const uint32_t x1 = x0 + 1 == extent.width ? 0 : x0 + 1;
+		const uint32_t y0 = static_cast<uint32_t>(yFloor);
+		const uint32_t y1 = std::min(y0 + 1, extent.height - 1);
+
+		const float*   p00 = rgb + (static_cast<size_t>(y0) * extent.width + x0) * 3;
+		const float*   p01 = rgb + (static_cast<size_t>(y0) * extent.width + x1) * 3;
+		const float*   p10 = rgb + (static_cast<size_t>(y1) * extent.width + x0) * 3;
+		const float*   p11 = rgb + (static_cast<size_t>(y1) * extent.width + x1) * 3;
+		for (int channel = 0; channel < 3; ++channel) {
+			const float top = p00[channel] + (p01[channel] - p00[channel]) * fx;
+			const float bottom = p10[channel] + (p11[channel] - p10[channel]) * fx;
+			out[channel] = top + (bottom - top) * fy;
+		}
+	}
+
+	// Same mapping HDRI.frag used on the panorama: u = atan(z, x) / 2pi + 0.5, v = asin(y) / pi + 0.5. asin(y) of the
+	// normalized direction is atan(y, length(xz)), which spares the normalize.
+	void DirectionToEquirect(const glm::vec3& direction, float& out_u, float& out_v) {
+		out_u = std::atan2(direction.z, direction.x) / (2.0f * PantomirFunctionLibrary::PI) + 0.5f;
+		out_v = std::atan2(direction.y, std::sqrt(direction.x * direction.x + direction.z * direction.z)) / PantomirFunctionLibrary::PI + 0.5f;
+	}
+
+#ifdef PANTOMIR_TEXTURE_SSE2
+	// Minimax atan on [-1, 1], within 1e-5 radians. Far below a texel of any panorama this engine loads.
+	__m128 AtanUnit(const __m128 t) {
+		const __m128 t2 = _mm_mul_ps(t, t);
+		__m128       result = _mm_set1_ps(-0.01172120f);
+		result = _mm_add_ps(_mm_mul_ps(result, t2), _mm_set1_ps(0.05265332f));
+		result = _mm_add_ps(_mm_mul_ps(result, t2), _mm_set1_ps(-0.11643287f));
+		result = _mm_add_ps(_mm_mul_ps(result, t2), _mm_set1_ps(0.19354346f));
+		result = _mm_add_ps(_mm_mul_ps(result, t2), _mm_set1_ps(-0.33262347f));
+		result = _mm_add_ps(_mm_mul_ps(result, t2), _mm_set1_ps(0.99997726f));
+		return _mm_mul_ps(result, t);
+	}
+
+	__m128 Select(const __m128 mask, const __m128 a, const __m128 b) {
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	// Folds both arguments into the first octant so AtanUnit only ever sees [0, 1], then unfolds by quadrant
+	__m128 Atan2(const __m128 y, const __m128 x) {
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 absY = _mm_andnot_ps(signMask, y);
+		const __m128 absX = _mm_andnot_ps(signMask, x);
+
+		const __m128 bSteep = _mm_cmpgt_ps(absY, absX);
+		const __m128 numerator = _mm_min_ps(absX, absY);
+		const __m128 denominator = _mm_max_ps(_mm_max_ps(absX, absY), _mm_set1_ps(1e-30f));
+
+		__m128       angle = AtanUnit(_mm_div_ps(numerator, denominator));
+		angle = Select(bSteep, _mm_sub_ps(_mm_set1_ps(0.5f * PantomirFunctionLibrary::PI), angle), angle);
+		angle = Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(PantomirFunctionLibrary::PI), angle), angle);
+		return _mm_or_ps(angle, _mm_and_ps(y, signMask));
+	}
+#endif
+
+	void ConvertCubeFaceRow(const float* rgb, const VkExtent3D extent, const CubeFace& face, const uint32_t faceSize, const uint32_t y, float* out_row) {
+		const float     texelScale = 2.0f / static_cast<float>(faceSize);
+		const float     t = (static_cast<float>(y) + 0.5f) * texelScale - 1.0f;
+		const glm::vec3 rowOrigin = face.axis + face.tAxis * t;
+		uint32_t        x = 0;
+
+#ifdef PANTOMIR_TEXTURE_SSE2
+		// Four texels per step through the trigonometry, the bilinear taps are scattered reads and stay scalar
+		const __m128 inverseTwoPi = _mm_set1_ps(0.5f / PantomirFunctionLibrary::PI);
+		const __m128 inversePi = _mm_set1_ps(1.0f / PantomirFunctionLibrary::PI);
+		const __m128 half = _mm_set1_ps(0.5f);
+		for (; x + 4 <= faceSize; x += 4) {
+			const __m128 s = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(_mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f), _mm_set1_ps(static_cast<float>(x))), _mm_set1_ps(texelScale)), _mm_set1_ps(1.0f));
+			const __m128 directionX = _mm_add_ps(_mm_set1_ps(rowOrigin.x), _mm_mul_ps(s, _mm_set1_ps(face.sAxis.x)));
+			const __m128 directionY = _mm_add_ps(_mm_set1_ps(rowOrigin.y), _mm_mul_ps(s, _mm_set1_ps(face.sAxis.y)));
+			const __m128 directionZ = _mm_add_ps(_mm_set1_ps(rowOrigin.z), _mm_mul_ps(s, _mm_set1_ps(face.sAxis.z)));
+			const __m128 horizontal = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(directionX, directionX), _mm_mul_ps(directionZ, directionZ)));
+
+			alignas(16) float u[4];
+			alignas(16) float v[4];
+			_mm_store_ps(u, _mm_add_ps(_mm_mul_ps(Atan2(directionZ, directionX), inverseTwoPi), half));
+			_mm_store_ps(v, _mm_add_ps(_mm_mul_ps(Atan2(directionY, horizontal), inversePi), half));
+			for (uint32_t lane = 0; lane < 4; ++lane) {
+				SampleEquirect(rgb, extent, u[lane], v[lane], out_row + (x + lane) * 3);
+			}
+		}
+#endif
+
+		for (; x < faceSize; ++x) {
+			const float s = (static_cast<float>(x) + 0.5f) * texelScale - 1.0f;
+			float       u = 0.0f;
+			float       v = 0.0f;
+			DirectionToEquirect(rowOrigin + face.sAxis * s, u, v);
+			SampleEquirect(rgb, extent, u, v, out_row + x * 3);
+		}
+	}
+} // namespace
+
+MipmappedTexture BuildMipChain(const DecodedImage& image) {
+	MipmappedTexture texture {};
+	texture.extent = image.extent;
+	texture.format = image.format;
+
+	const uint32_t mipCount = static_cast<uint32_t>(std::floor(std::log2(std::max(image.extent.width, image.extent.height)))) + 1;
+
+	// Lay out every level first so the chain is filled in a single allocation
+	VkDeviceSize   totalSize = 0;
+	for (uint32_t mip = 0; mip < mipCount; ++mip) {
+		const uint32_t    width = std::max(1u, image.extent.width >> mip);
+		const uint32_t    height = std::max(1u, image.extent.height >> mip);
+
+		VkBufferImageCopy region {};
+		region.bufferOffset = totalSize;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = mip;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = VkExtent3D { width, height, 1 };
+		texture.mipRegions.push_back(region);
+
+		totalSize = AlignUp(totalSize + static_cast<VkDeviceSize>(width) * height * 4, TEXTURE_CACHE_DATA_ALIGNMENT);
+	}
+
+	texture.ownedPixels.resize(totalSize);
+	uint8_t* pixels = reinterpret_cast<uint8_t*>(texture.ownedPixels.data());
+	memcpy(pixels, image.pixels.data(), image.pixels.size());
+
+	for (uint32_t mip = 1; mip < mipCount; ++mip) {
+		const VkBufferImageCopy& source = texture.mipRegions[mip - 1];
+		const VkBufferImageCopy& destination = texture.mipRegions[mip];
+		DownsampleRGBA8(pixels + source.bufferOffset, source.imageExtent.width, source.imageExtent.height,
+		                pixels + destination.bufferOffset, destination.imageExtent.width, destination.imageExtent.height);
+	}
+
+	texture.pixels = texture.ownedPixels;
+	return texture;
+}
+
+MipmappedTexture BuildHDRCubemap(const float* rgb, const VkExtent3D extent, Pantomir::ThreadPool& threadPool) {
+	// A face a quarter of the panorama wide keeps texel density at the equator
+	const uint32_t   faceSize = std::max(1u, extent.width / 4);
+	const uint32_t   mipCount = static_cast<uint32_t>(std::floor(std::log2(faceSize))) + 1;
+	const size_t     facePixelCount = static_cast<size_t>(faceSize) * faceSize;
+
+	MipmappedTexture texture {};
+	texture.extent = VkExtent3D { faceSize, faceSize, 1 };
+	texture.format = VK_FORMAT_E5B9G9R9_UFLOAT_PACK32;
+	texture.bCubemap = true;
+
+	// Faces of a level are back to back, one region copies all six
+	VkDeviceSize     totalSize = 0;
+	for (uint32_t mip = 0; mip < mipCount; ++mip) {
+		const uint32_t    size = std::max(1u, faceSize >> mip);
+
+		VkBufferImageCopy region {};
+		region.bufferOffset = totalSize;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = mip;
+		region.imageSubresource.layerCount = CUBEMAP_FACE_COUNT;
+		region.imageExtent = VkExtent3D { size, size, 1 };
+		texture.mipRegions.push_back(region);
+
+		totalSize = AlignUp(totalSize + static_cast<VkDeviceSize>(size) * size * sizeof(uint32_t) * CUBEMAP_FACE_COUNT, TEXTURE_CACHE_DATA_ALIGNMENT);
+	}
+	texture.ownedPixels.resize(totalSize);
+
+	std::vector<float> faces(facePixelCount * 3 * CUBEMAP_FACE_COUNT);
+	threadPool.ParallelFor(static_cast<size_t>(faceSize) * CUBEMAP_FACE_COUNT, [&](const size_t faceRow) {
+		const uint32_t face = static_cast<uint32_t>(faceRow / faceSize);
+		const uint32_t y = static_cast<uint32_t>(faceRow % faceSize);
+		ConvertCubeFaceRow(rgb, extent, CUBE_FACES[face], faceSize, y, faces.data() + (face * facePixelCount + static_cast<size_t>(y) * faceSize) * 3);
+	});
+
+	// Filtering runs on the float levels, packing each level only after it has been averaged keeps rounding from piling up
+	threadPool.ParallelFor(CUBEMAP_FACE_COUNT, [&](const size_t face) {
+		std::vector<float> level(faces.begin() + face * facePixelCount * 3, faces.begin() + (face + 1) * facePixelCount * 3);
+		std::vector<float> nextLevel;
+		for (uint32_t mip = 0; mip < mipCount; ++mip) {
+			const VkBufferImageCopy& region = texture.mipRegions[mip];
+			const size_t             pixelCount = static_cast<size_t>(region.imageExtent.width) * region.imageExtent.height;
+			uint32_t*                packed = reinterpret_cast<uint32_t*>(texture.ownedPixels.data() + region.bufferOffset) + face * pixelCount;
+			for (size_t pixel = 0; pixel < pixelCount; ++pixel) {
+				packed[pixel] = PackRGB9E5(level.data() + pixel * 3);
+			}
+
+			if (mip + 1 < mipCount) {
+				const VkExtent3D& nextExtent = texture.mipRegions[mip + 1].imageExtent;
+				nextLevel.resize(static_cast<size_t>(nextExtent.width) * nextExtent.height * 3);
+				DownsampleRGB32F(level.data(), region.imageExtent.width, region.imageExtent.height, nextLevel.data(), nextExtent.width, nextExtent.height);
+				std::swap(level, nextLevel);
+			}
+		}
+	});
+
+	texture.pixels = texture.ownedPixels;
+	return texture;
+}
+
+MipmappedTexture CompressMipChain(const MipmappedTexture& texture, const TextureCompression compression) {
+	MipmappedTexture compressed {};
+	compressed.extent = texture.extent;
+	compressed.format = GetCompressedFormat(compression);
+
+	VkDeviceSize totalSize = 0;
+	for (const VkBufferImageCopy& sourceRegion : texture.mipRegions) {
+		VkBufferImageCopy region = sourceRegion;
+		region.bufferOffset = totalSize;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		compressed.mipRegions.push_back(region);
+
+		totalSize = AlignUp(totalSize + PantomirFunctionLibrary::ImageSizeFromFormat(compressed.format, region.imageExtent), TEXTURE_CACHE_DATA_ALIGNMENT);
+	}
+	compressed.ownedPixels.resize(totalSize);
+
+	const size_t blockByteSize = GetBlockByteSize(compression);
+	for (size_t mip = 0; mip < texture.mipRegions.size(); ++mip) {
+		const VkBufferImageCopy& sourceRegion = texture.mipRegions[mip];
+		const uint32_t           width = sourceRegion.imageExtent.width;
+		const uint32_t           height = sourceRegion.imageExtent.height;
+		const uint8_t*           source = reinterpret_cast<const uint8_t*>(texture.pixels.data() + sourceRegion.bufferOffset);
+		uint8_t*                 destination = reinterpret_cast<uint8_t*>(compressed.ownedPixels.data() + compressed.mipRegions[mip].bufferOffset);
+
+		std::array<uint8_t, BC_BLOCK_TEXEL_COUNT * 4> block {};
+		for (uint32_t blockY = 0; blockY < height; blockY += 4) {
+			for (uint32_t blockX = 0; blockX < width; blockX += 4) {
+				for (uint32_t y = 0; y < 4; ++y) {
+					const uint32_t sourceY = std::min(blockY + y, height - 1);
+					for (uint32_t x = 0; x < 4; ++x) {
+						const uint32_t sourceX = std::min(blockX + x, width - 1);
+						memcpy(&block[(y * 4 + x) * 4], source + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+					}
+				}
+
+				EncodeBlock(compression, block.data(), destination);
+				destination += blockByteSize;
+			}
+		}
+	}
+
+	compressed.pixels = compressed.ownedPixels;
+	return compressed;
+}
+
+VkFormat GetCompressedFormat(const TextureCompression compression) {
+	switch (compression) {
+		case TextureCompression::BC1:
+			return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		case TextureCompression::BC4:
+			return VK_FORMAT_BC4_UNORM_BLOCK;
+		case TextureCompression::BC5:
+			return VK_FORMAT_BC5_UNORM_BLOCK;
+		case TextureCompression::BC7:
+			return VK_FORMAT_BC7_UNORM_BLOCK;
+		case TextureCompression::None:
+		default:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+std::filesystem::path GetTextureCachePath(const ContentHash& sourceHash, const TextureCompression compression) {
+	constexpr std::array<std::string_view, 5> compressionSuffixes = { "rgba8", "bc1", "bc4", "bc5", "bc7" };
+	return std::filesystem::path("Cache") / "Textures" / (sourceHash.ToString() + "." + std::string(compressionSuffixes[static_cast<size_t>(compression)]) + ".ptex");
+}
+
+bool WriteTextureCache(const std::filesystem::path& cachePath, const MipmappedTexture& texture) {
+	if (texture.mipRegions.size() > TEXTURE_CACHE_MAX_MIPS) {
+		return false;
+	}
+
+	std::error_code directoryError;
+	std::filesystem::create_directories(cachePath.parent_path(), directoryError);
+	if (directoryError) {
+		LOG(Engine, Warning, "Failed to create texture cache directory '{}': {}", cachePath.parent_path().string(), directoryError.message());
+		return false;
+	}
+
+	TextureCacheHeader header {};
+	header.magic = TEXTURE_CACHE_MAGIC;
+	header.version = TEXTURE_CACHE_VERSION;
+	header.width = texture.extent.width;
+	header.height = texture.extent.height;
+	header.format = static_cast<uint32_t>(texture.format);
+	header.mipCount = static_cast<uint32_t>(texture.mipRegions.size());
+
+	// Pixel data keeps the in-memory layout, shifted past the header
+	const uint64_t dataOffset = AlignUp(sizeof(TextureCacheHeader), TEXTURE_CACHE_DATA_ALIGNMENT);
+	for (uint32_t mip = 0; mip < header.mipCount; ++mip) {
+		const VkBufferImageCopy& region = texture.mipRegions[mip];
+		header.mips[mip] = TextureCacheMip {
+			dataOffset + region.bufferOffset,
+			PantomirFunctionLibrary::ImageSizeFromFormat(texture.format, region.imageExtent),
+			region.imageExtent.width,
+			region.imageExtent.height,
+		};
+	}
+
+	// Several loader threads may race on the same hash, each writes its own temporary file and the last rename wins
+	std::filesystem::path temporaryPath = cachePath;
+	temporaryPath += "." + std::to_string(std::hash<std::thread::id> {}(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		constexpr std::array<char, TEXTURE_CACHE_DATA_ALIGNMENT> padding {};
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(padding.data(), static_cast<std::streamsize>(dataOffset - sizeof(header)));
+		file.write(reinterpret_cast<const char*>(texture.pixels.data()), static_cast<std::streamsize>(texture.pixels.size()));
+
+		if (!file.good()) {
+			file.close();
+			std::filesystem::remove(temporaryPath, directoryError);
+			return false;
+		}
+	}
+
+	std::error_code renameError;
+	std::filesystem::rename(temporaryPath, cachePath, renameError);
+	if (renameError) {
+		std::filesystem::remove(temporaryPath, renameError);
+		return false;
+	}
+
+	return true;
+}
+
+std::optional<MipmappedTexture> ReadTextureCache(const std::filesystem::path& cachePath) {
+	MipmappedTexture texture {};
+	if (!texture.mappedFile.Open(cachePath) || texture.mappedFile.Size() < sizeof(TextureCacheHeader)) {
+		return std::nullopt;
+	}
+
+	TextureCacheHeader header;
+	memcpy(&header, texture.mappedFile.Data(), sizeof(header));
+	if (header.magic != TEXTURE_CACHE_MAGIC || header.version != TEXTURE_CACHE_VERSION || header.mipCount == 0 || header.mipCount > TEXTURE_CACHE_MAX_MIPS) {
+		return std::nullopt;
+	}
+
+	// Every level's extent and size follow from the base extent and format, the copies trust them blindly
+	const VkFormat format = static_cast<VkFormat>(header.format);
+	if (!IsCachedFormat(format) || header.width == 0 || header.height == 0 || (std::max(header.width, header.height) >> (header.mipCount - 1)) == 0) {
+		LOG(Engine, Warning, "Texture cache '{}' has an invalid format or extent, it will be rebuilt", cachePath.string());
+		return std::nullopt;
+	}
+	for (uint32_t mip = 0; mip < header.mipCount; ++mip) {
+		const VkExtent3D       mipExtent { std::max(header.width >> mip, 1u), std::max(header.height >> mip, 1u), 1 };
+		const TextureCacheMip& cachedMip = header.mips[mip];
+		if (cachedMip.width != mipExtent.width || cachedMip.height != mipExtent.height || cachedMip.size != PantomirFunctionLibrary::ImageSizeFromFormat(format, mipExtent)) {
+			LOG(Engine, Warning, "Texture cache '{}' has an inconsistent mip chain, it will be rebuilt", cachePath.string());
+			return std::nullopt;
+		}
+	}
+
+	// Regions are rebased onto the first mip, so the pixel span starts there
+	const uint64_t dataOffset = header.mips[0].offset;
+	const uint64_t dataEnd = header.mips[header.mipCount - 1].offset + header.mips[header.mipCount - 1].size;
+	if (dataOffset > dataEnd || dataEnd > texture.mappedFile.Size()) {
+		LOG(Engine, Warning, "Texture cache '{}' is truncated, it will be rebuilt", cachePath.string());
+		return std::nullopt;
+	}
+
+	texture.extent = VkExtent3D { header.width, header.height, 1 };
+	texture.format = format;
+	for (uint32_t mip = 0; mip < header.mipCount; ++mip) {
+		const TextureCacheMip& cachedMip = header.mips[mip];
+		if (cachedMip.offset < dataOffset || cachedMip.offset + cachedMip.size > dataEnd) {
+			return std::nullopt;
+		}
+
+		VkBufferImageCopy region {};
+		region.bufferOffset = cachedMip.offset - dataOffset;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = mip;
+		region.imageSubresource.layerCount = 1;
+		region.imageExtent = VkExtent3D { cachedMip.width, cachedMip.height, 1 };
+		texture.mipRegions.push_back(region);
+	}
+
+	texture.pixels = texture.mappedFile.Bytes().subspan(dataOffset, dataEnd - dataOffset);
+	return texture;
+}
@@ -0,0 +1,50 @@
+#ifndef TEXTURECACHE_H_
+#define TEXTURECACHE_H_
+
+#include "BlockCompression.h"
+#include "ContentHash.h"
+#include "MappedFile.h"
+#include "VkTypes.h"
+
+#include <filesystem>
+
+namespace Pantomir {
+	class ThreadPool;
+} // namespace Pantomir
+
+struct DecodedImage;
+
+constexpr uint32_t CUBEMAP_FACE_COUNT = 6;
+
+// A texture with its whole mip chain, mip levels packed back to back. Regions are ready for vkCmdCopyBufferToImage
+// once their bufferOffset is rebased onto the staging allocation.
+struct MipmappedTexture {
+	VkExtent3D                     extent {};
+	VkFormat                       format = VK_FORMAT_UNDEFINED;
+	std::vector<VkBufferImageCopy> mipRegions;
+	std::span<const std::byte>     pixels;           // Views ownedPixels or mappedFile
+	bool                           bCubemap = false; // Every level holds six faces, +X, -X, +Y, -Y, +Z, -Z
+
+	std::vector<std::byte>         ownedPixels;
+	Pantomir::MappedFile           mappedFile;
+};
+
+// Box-filters an RGBA8 image down to 1x1 on the CPU, SSE2 when available. Matches what a linear blit chain would give,
+// without the per-level barriers on the GPU.
+MipmappedTexture                BuildMipChain(const DecodedImage& image);
+
+// Resamples an RGB float equirectangular panorama into a cubemap, box-filters each face down to 1x1 and packs every level
+// as E5B9G9R9. A quarter of the size of RGBA32F, with enough range and precision for environment maps. Rows are spread
+// across threadPool.
+MipmappedTexture                BuildHDRCubemap(const float* rgb, VkExtent3D extent, Pantomir::ThreadPool& threadPool);
+
+// Encodes every level of an RGBA8 chain into BCn blocks. Levels smaller than a block are padded by clamping.
+MipmappedTexture                CompressMipChain(const MipmappedTexture& texture, TextureCompression compression);
+VkFormat                        GetCompressedFormat(TextureCompression compression);
+
+// Decoded textures are cached under Cache/Textures, keyed by the hash of their encoded bytes and the format they were cooked to.
+std::filesystem::path           GetTextureCachePath(const ContentHash& sourceHash, TextureCompression compression);
+bool                            WriteTextureCache(const std::filesystem::path& cachePath, const MipmappedTexture& texture);
+std::optional<MipmappedTexture> ReadTextureCache(const std::filesystem::path& cachePath);
+
+#endif /*! TEXTURECACHE_H_ */
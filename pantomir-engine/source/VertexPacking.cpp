@@ -0,0 +1,63 @@
+#include "VertexPacking.h"
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/packing.hpp>
+
+namespace {
+	// Octahedral mapping: project onto the octahedron |x| + |y| + |z| = 1, then fold the lower hemisphere over the diagonals.
+	// Matches OctahedralDecode in mesh.vert.
+	uint32_t PackOctahedral(const glm::vec3& direction) {
+		const float lengthL1 = glm::abs(direction.x) + glm::abs(direction.y) + glm::abs(direction.z);
+		if (lengthL1 < 1e-12f) {
+			return glm::packSnorm2x16(glm::vec2(0.F)); // Missing data decodes to +Z
+		}
+
+		glm::vec2 encoded = glm::vec2(direction) / lengthL1;
+		if (direction.z < 0.F) {
+			const glm::vec2 signs { encoded.x >= 0.F ? 1.F : -1.F, encoded.y >= 0.F ? 1.F : -1.F };
+			encoded = (1.F - glm::abs(glm::vec2(encoded.y, encoded.x))) * signs;
+		}
+		return glm::packSnorm2x16(encoded);
+	}
+} // namespace
+
+PositionQuantization ComputePositionQuantization(const std::span<const Vertex> vertices) {
+	if (vertices.empty()) {
+		return {};
+	}
+
+	glm::vec3 minPosition = vertices.front().position;
+	glm::vec3 maxPosition = vertices.front().position;
+	for (const Vertex& vertex : vertices) {
+		minPosition = glm::min(minPosition, vertex.position);
+		maxPosition = glm::max(maxPosition, vertex.position);
+	}
+
+	return PositionQuantization { minPosition, maxPosition - minPosition };
+}
+
+PackedVertex PackVertex(const Vertex& vertex, const PositionQuantization& quantization) {
+	glm::vec3 normalizedPosition { 0.F };
+	for (int axis = 0; axis < 3; ++axis) {
+		if (quantization.scale[axis] > 0.F) {
+			normalizedPosition[axis] = (vertex.position[axis] - quantization.offset[axis]) / quantization.scale[axis];
+		}
+	}
+
+	PackedVertex packedVertex {};
+	packedVertex.positionXY = glm::packUnorm2x16(glm::vec2(normalizedPosition));
+	packedVertex.positionZ = glm::packUnorm2x16(glm::vec2(normalizedPosition.z, vertex.tangent.w < 0.F ? 0.F : 1.F));
+	packedVertex.normal = PackOctahedral(vertex.normal);
+	packedVertex.tangent = PackOctahedral(glm::vec3(vertex.tangent));
+	packedVertex.uv = glm::packHalf2x16(glm::vec2(vertex.uv_x, vertex.uv_y));
+	packedVertex.color = glm::packUnorm4x8(vertex.color);
+	return packedVertex;
+}
+
+void PackVertices(const std::span<const Vertex> vertices, const PositionQuantization& quantization, std::vector<PackedVertex>& out_vertices) {
+	out_vertices.reserve(out_vertices.size() + vertices.size());
+	for (const Vertex& vertex : vertices) {
+		out_vertices.push_back(PackVertex(vertex, quantization));
+	}
+}
@@ -0,0 +1,20 @@
+#ifndef VERTEXPACKING_H_
+#define VERTEXPACKING_H_
+
+#include "VkTypes.h"
+
+#include <glm/vec3.hpp>
+
+// Maps unorm16 positions back into object space: position = offset + quantized * scale.
+struct PositionQuantization {
+	glm::vec3 offset { 0.F };
+	glm::vec3 scale { 0.F };
+};
+
+// Fits the quantization box tightly around the vertices. Flat axes get a zero scale and decode to the offset.
+PositionQuantization ComputePositionQuantization(std::span<const Vertex> vertices);
+
+PackedVertex         PackVertex(const Vertex& vertex, const PositionQuantization& quantization);
+void                 PackVertices(std::span<const Vertex> vertices, const PositionQuantization& quantization, std::vector<PackedVertex>& out_vertices);
+
+#endif /*! VERTEXPACKING_H_ */
@@ -124,10 +124,10 @@ VkDescriptorSetLayout DescriptorLayoutBuilder::Build(VkDevice device, VkShaderSt
 	return descriptor_set_layout;
 }
 
-void DescriptorLayoutBuilder::AddBinding(const uint32_t binding, const VkDescriptorType type) {
+void DescriptorLayoutBuilder::AddBinding(const uint32_t binding, const VkDescriptorType type, const uint32_t descriptorCount) {
 	VkDescriptorSetLayoutBinding newDescriptorSetLayoutBinding {};
 	newDescriptorSetLayoutBinding.binding = binding;
-	newDescriptorSetLayoutBinding.descriptorCount = 1;
+	newDescriptorSetLayoutBinding.descriptorCount = descriptorCount;
 	newDescriptorSetLayoutBinding.descriptorType = type;
 
 	_bindings.push_back(newDescriptorSetLayoutBinding);
@@ -175,7 +175,7 @@ void DescriptorSetWriter::WriteBuffer(const int binding, const VkBuffer buffer,
 	_writes.push_back(write);
 }
 
-void DescriptorSetWriter::WriteImage(int binding, VkImageView image, VkSampler sampler, VkImageLayout layout, VkDescriptorType type) {
+void DescriptorSetWriter::WriteImage(int binding, VkImageView image, VkSampler sampler, VkImageLayout layout, VkDescriptorType type, const uint32_t arrayElement) {
 	VkDescriptorImageInfo& info = _imageInfos.emplace_back(VkDescriptorImageInfo {
 	    .sampler = sampler,
 	    .imageView = image,
@@ -184,6 +184,7 @@ void DescriptorSetWriter::WriteImage(int binding, VkImageView image, VkSampler s
 	VkWriteDescriptorSet   write = { .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
 
 	write.dstBinding = binding;
+	write.dstArrayElement = arrayElement;
 	write.dstSet = VK_NULL_HANDLE; // left empty for now until we need to write it
 	write.descriptorCount = 1;
 	write.descriptorType = type;
@@ -32,7 +32,7 @@ private:
 // DescriptorLayoutBuilder
 // ------------------------------------------------------------
 struct DescriptorLayoutBuilder {
-	void                  AddBinding(uint32_t binding, VkDescriptorType type);
+	void                  AddBinding(uint32_t binding, VkDescriptorType type, uint32_t descriptorCount = 1);
 	VkDescriptorSetLayout Build(VkDevice device, VkShaderStageFlags shaderStages, void* pNext = nullptr, VkDescriptorSetLayoutCreateFlags flags = 0);
 
 	void                  Clear();
@@ -45,7 +45,7 @@ private:
 // DescriptorWriter
 // ------------------------------------------------------------
 struct DescriptorSetWriter {
-	void WriteImage(int binding, VkImageView image, VkSampler sampler, VkImageLayout layout, VkDescriptorType type);
+	void WriteImage(int binding, VkImageView image, VkSampler sampler, VkImageLayout layout, VkDescriptorType type, uint32_t arrayElement = 0);
 	void WriteBuffer(int binding, VkBuffer buffer, size_t size, size_t offset, VkDescriptorType type);
 
 	void Clear();
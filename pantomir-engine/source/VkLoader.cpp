@@ -2,17 +2,27 @@
 
 #include "LoggerMacros.h"
 
+#include "ContentHash.h"
+#include "GltfSource.h"
+#include "ImageContainers.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "ObjImporter.h"
 #include "PantomirEngine.h"
+#include "PantomirFunctionLibrary.h"
+#include "TextureCache.h"
 #include "VkTypes.h"
 
-#include <glm/gtx/quaternion.hpp>
-
 #define STB_IMAGE_IMPLEMENTATION // Compiles stb_image functions
 #include "stb_image.h"
 
 #include <fastgltf/core.hpp>
-#include <fastgltf/glm_element_traits.hpp>
-#include <fastgltf/tools.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <future>
+#include <limits>
 #include <ranges>
 #include <unordered_set>
 
@@ -46,533 +56,929 @@ VkSamplerMipmapMode ExtractMipmapMode(fastgltf::Filter filter) {
 	}
 }
 
-std::string GetImageSourceKey(fastgltf::Asset& asset, fastgltf::Image& image) {
-	std::string key;
-
-	std::visit(fastgltf::visitor {
-	               [&](fastgltf::sources::URI& uriSource) {
-		               if (uriSource.uri.isLocalPath()) {
-			               const std::string filePath(uriSource.uri.path().begin(), uriSource.uri.path().end());
-			               key = "uri:" + filePath;
-		               }
-	               },
-	               [&](fastgltf::sources::Vector& vectorSource) {
-		               // Use size and first few bytes as a simple hash
-		               key = "vector:size=" + std::to_string(vectorSource.bytes.size());
-		               if (vectorSource.bytes.size() >= 16) {
-			               // Add first 16 bytes as additional identifier
-			               for (int i = 0; i < 16; ++i) {
-				               key += std::to_string(static_cast<unsigned int>(vectorSource.bytes[i]));
-			               }
-		               }
-	               },
-	               [&](fastgltf::sources::BufferView& bufferViewSource) {
-		               fastgltf::BufferView& bufferView = asset.bufferViews[bufferViewSource.bufferViewIndex];
-		               key = "bufferview:" + std::to_string(bufferViewSource.bufferViewIndex) +
-		                     ":offset=" + std::to_string(bufferView.byteOffset) +
-		                     ":length=" + std::to_string(bufferView.byteLength);
-	               },
-	               [&](auto&) {
-		               key = "unknown";
-	               },
-	           },
-	           image.data);
-
-	return key;
-}
-
-// TODO: Only usage is here, maybe don't make this a free function available to everywhere.
-std::optional<AllocatedImage> LoadImage(PantomirEngine* engine, fastgltf::Asset& asset, fastgltf::Image& image) {
-	AllocatedImage newImage {};
-	int            width = 0;
-	int            height = 0;
-	int            channelCount = 0;
-	constexpr int  desiredChannelCount = 4;
-
-	const auto     CreateImageFromMemory = [&](const stbi_uc* sourceData, int dataSize, bool forceStaging = false) -> bool {
-        unsigned char* imageData = stbi_load_from_memory(sourceData, dataSize, &width, &height, &channelCount, desiredChannelCount);
-        if (imageData == nullptr) {
-            LOG(Engine, Error, "stbi_load_from_memory failed: {}", stbi_failure_reason());
-            return false;
-        }
-
-        VkExtent3D imageExtent {};
-        imageExtent.width = static_cast<uint32_t>(width);
-        imageExtent.height = static_cast<uint32_t>(height);
-        imageExtent.depth = 1;
-
-        newImage = engine->CreateImage(imageData, imageExtent, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT, forceStaging);
-        stbi_image_free(imageData);
-        return true;
-	};
-
-	const auto CreateImageFromFile = [&](const std::string& filePath) -> bool {
-		unsigned char* imageData = stbi_load(filePath.c_str(), &width, &height, &channelCount, desiredChannelCount);
-		if (imageData == nullptr) {
-			LOG(Engine, Error, "stbi_load failed for file '{}': {}", filePath, stbi_failure_reason());
-			return false;
-		}
-
-		VkExtent3D imageExtent {};
-		imageExtent.width = static_cast<uint32_t>(width);
-		imageExtent.height = static_cast<uint32_t>(height);
-		imageExtent.depth = 1;
+// Resolves the encoded bytes of an image without decoding them. LoadGltfSource already mapped external image files, so
+// every image is viewed in place.
+std::optional<EncodedImage> ReadEncodedImage(const fastgltf::Asset& asset, const fastgltf::Image& image) {
+	EncodedImage encodedImage {};
+	bool         bResolved = false;
 
-		newImage = engine->CreateImage(imageData, imageExtent, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT, false);
-		stbi_image_free(imageData);
-		return true;
+	const auto   ViewBytes = [&](const std::byte* data, const size_t size) {
+        encodedImage.bytes = std::span<const std::byte>(data, size);
+        bResolved = true;
 	};
 
 	std::visit(fastgltf::visitor {
-	               // URI Case
-	               [&](fastgltf::sources::URI& uriSource) {
-		               if (!uriSource.uri.isLocalPath()) {
-			               LOG(Engine, Warning, "Image URI is not a local path. Skipping.");
-			               return;
-		               }
-		               if (uriSource.fileByteOffset != 0) {
-			               LOG(Engine, Warning, "Non-zero fileByteOffset not supported in image URI. Skipping.");
-			               return;
-		               }
-
-		               const std::string filePath(uriSource.uri.path().begin(), uriSource.uri.path().end());
-		               CreateImageFromFile(filePath);
+	               // URI Case, only left when the file couldn't be mapped
+	               [&](const fastgltf::sources::URI& uriSource) {
+		               LOG(Engine, Error, "Failed to open image file '{}'", uriSource.uri.string());
+	               },
+
+	               // Mapped image files and decoded data URIs
+	               [&](const fastgltf::sources::ByteView& byteViewSource) {
+		               ViewBytes(byteViewSource.bytes.data(), byteViewSource.bytes.size());
 	               },
 
 	               // Embedded raw bytes
-	               [&](fastgltf::sources::Vector& vectorSource) {
-		               const stbi_uc* imageBytes = reinterpret_cast<const stbi_uc*>(vectorSource.bytes.data());
-		               int            byteSize = static_cast<int>(vectorSource.bytes.size());
-		               CreateImageFromMemory(imageBytes, byteSize);
+	               [&](const fastgltf::sources::Array& arraySource) {
+		               ViewBytes(arraySource.bytes.data(), arraySource.bytes.size());
+	               },
+	               [&](const fastgltf::sources::Vector& vectorSource) {
+		               ViewBytes(vectorSource.bytes.data(), vectorSource.bytes.size());
 	               },
 
 	               // BufferView image data
-	               [&](fastgltf::sources::BufferView& bufferViewSource) {
-		               fastgltf::BufferView& bufferView = asset.bufferViews[bufferViewSource.bufferViewIndex];
-		               fastgltf::Buffer&     buffer = asset.buffers[bufferView.bufferIndex];
-		               std::visit(fastgltf::visitor { [&](fastgltf::sources::Array& arraySource) {
-			                                             const stbi_uc* dataPointer = reinterpret_cast<const stbi_uc*>(arraySource.bytes.data() + bufferView.byteOffset);
-			                                             int            dataSize = static_cast<int>(bufferView.byteLength);
-			                                             CreateImageFromMemory(dataPointer, dataSize);
+	               [&](const fastgltf::sources::BufferView& bufferViewSource) {
+		               const fastgltf::BufferView& bufferView = asset.bufferViews[bufferViewSource.bufferViewIndex];
+		               const fastgltf::Buffer&     buffer = asset.buffers[bufferView.bufferIndex];
+		               std::visit(fastgltf::visitor { [&](const fastgltf::sources::Array& arraySource) {
+			                                             ViewBytes(arraySource.bytes.data() + bufferView.byteOffset, bufferView.byteLength);
 		                                             },
-		                                              [&](fastgltf::sources::Vector& vectorSource) {
-			                                              const stbi_uc* dataPointer = reinterpret_cast<const stbi_uc*>(vectorSource.bytes.data() + bufferView.byteOffset);
-			                                              int            dataSize = static_cast<int>(bufferView.byteLength);
-			                                              CreateImageFromMemory(dataPointer, dataSize);
+		                                              [&](const fastgltf::sources::Vector& vectorSource) {
+			                                              ViewBytes(vectorSource.bytes.data() + bufferView.byteOffset, bufferView.byteLength);
 		                                              },
-		                                              [&](fastgltf::sources::ByteView& byteViewSource) {
-			                                              const stbi_uc* dataPointer = reinterpret_cast<const stbi_uc*>(byteViewSource.bytes.data() + bufferView.byteOffset);
-			                                              int            dataSize = static_cast<int>(bufferView.byteLength);
-			                                              // For ByteView, we force staging to true
-			                                              CreateImageFromMemory(dataPointer, dataSize, true);
+		                                              [&](const fastgltf::sources::ByteView& byteViewSource) {
+			                                              ViewBytes(byteViewSource.bytes.data() + bufferView.byteOffset, bufferView.byteLength);
 		                                              },
-		                                              [&](fastgltf::sources::URI&) {
+		                                              [&](const fastgltf::sources::URI&) {
 			                                              LOG(Engine, Warning, "BufferView uses URI source. This may not be supported in binary GLB format.");
 		                                              },
-		                                              [&](auto&) {
+		                                              [&](const auto&) {
 			                                              LOG(Engine, Error, "Unhandled buffer source type in BufferView.");
 		                                              } },
 		                          buffer.data);
 	               },
-	               [&](auto&) {
+	               [&](const auto&) {
 		               LOG(Engine, Error, "Unhandled image data variant type.");
 	               },
 	           },
 	           image.data);
 
-	if (newImage.image == VK_NULL_HANDLE) {
+	if (!bResolved) {
 		return std::nullopt;
 	}
 
-	return newImage;
+	return encodedImage;
 }
 
-// We use fastgltf to parse the json, then we use STBI to load the images from either memory or a filepath.
-std::optional<std::shared_ptr<LoadedGLTF>> LoadGltf(PantomirEngine* engine, const std::string_view& filePath) {
-	LOG(Engine, Info, "Loading GLTF: {}", filePath);
-	fastgltf::Parser                             parser { fastgltf::Extensions::KHR_materials_emissive_strength | fastgltf::Extensions::KHR_materials_specular };
-	constexpr fastgltf::Options                  gltfParserOptions { fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble | fastgltf::Options::LoadExternalBuffers };
-	std::filesystem::path                        path(filePath);
-	fastgltf::Expected<fastgltf::GltfDataBuffer> dataBufferResult = fastgltf::GltfDataBuffer::FromPath(path);
-	if (!dataBufferResult) {
-		LOG(Engine, Error, "Failed to read GLTF file: {}", getErrorMessage(dataBufferResult.error()));
+// Decodes on the calling thread without touching Vulkan, so it is safe to run on worker threads.
+std::optional<DecodedImage> DecodeImage(const EncodedImage& encodedImage) {
+	constexpr int  desiredChannelCount = 4;
+	int            width = 0;
+	int            height = 0;
+	int            channelCount = 0;
+
+	unsigned char* imageData = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(encodedImage.bytes.data()), static_cast<int>(encodedImage.bytes.size()), &width, &height, &channelCount, desiredChannelCount);
+	if (imageData == nullptr) {
+		LOG(Engine, Error, "stbi_load_from_memory failed: {}", stbi_failure_reason());
 		return std::nullopt;
 	}
-	fastgltf::GltfDataBuffer            oneGiantDataBuffer = std::move(dataBufferResult.get());
-	fastgltf::Expected<fastgltf::Asset> assetResult = parser.loadGltf(oneGiantDataBuffer, path.parent_path(), gltfParserOptions);
-	if (!assetResult) {
-		LOG(Engine, Error, "Failed to load GLTF: {}", getErrorMessage(assetResult.error()));
+
+	DecodedImage decodedImage {};
+	decodedImage.extent.width = static_cast<uint32_t>(width);
+	decodedImage.extent.height = static_cast<uint32_t>(height);
+	decodedImage.extent.depth = 1;
+	decodedImage.format = VK_FORMAT_R8G8B8A8_UNORM;
+
+	const size_t byteSize = static_cast<size_t>(width) * static_cast<size_t>(height) * desiredChannelCount;
+	decodedImage.pixels.assign(imageData, imageData + byteSize);
+	stbi_image_free(imageData);
+
+	return decodedImage;
+}
+
+// Where a texture's mip chain came from, for the load statistics.
+enum class TextureSource : uint8_t {
+	Decoded,
+	Cache,
+	Container
+};
+
+// DDS and KTX2 images are viewed in place, everything else maps the cached mip chain for these encoded bytes, or decodes
+// and builds it, then refreshes the cache. Worker-thread safe.
+static std::optional<MipmappedTexture> LoadMipmappedTexture(const EncodedImage& encodedImage, const ContentHash& contentHash, const TextureCompression compression, const bool bTextureCompressionBC, const uint32_t maxImageDimension, TextureSource& out_source) {
+	if (IsImageContainer(encodedImage.bytes)) {
+		out_source = TextureSource::Container;
+		std::optional<MipmappedTexture> texture = ParseImageContainer(encodedImage.bytes, maxImageDimension);
+		if (texture.has_value() && PantomirFunctionLibrary::IsBlockCompressedFormat(texture->format) && !bTextureCompressionBC) {
+			LOG(Engine, Warning, "Skipping block-compressed image, the device cannot sample BC formats");
+			return std::nullopt;
+		}
+		return texture;
+	}
+
+	const std::filesystem::path cachePath = GetTextureCachePath(contentHash, compression);
+	if (std::optional<MipmappedTexture> cachedTexture = ReadTextureCache(cachePath); cachedTexture.has_value()) {
+		out_source = TextureSource::Cache;
+		return cachedTexture;
+	}
+
+	out_source = TextureSource::Decoded;
+	const std::optional<DecodedImage> decodedImage = DecodeImage(encodedImage);
+	if (!decodedImage.has_value()) {
 		return std::nullopt;
 	}
-	fastgltf::Asset                                                    gltfAsset = std::move(assetResult.get());
 
-	std::vector<DescriptorPoolManager::DescriptorTypeCountMultipliers> poolSizeRatios {
-		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 },
-		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 },
-		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1 }
-	};
+	MipmappedTexture texture = BuildMipChain(*decodedImage);
+	if (compression != TextureCompression::None) {
+		texture = CompressMipChain(texture, compression);
+	}
+	if (!WriteTextureCache(cachePath, texture)) {
+		LOG(Engine, Warning, "Failed to write texture cache '{}'", cachePath.string());
+	}
 
-	std::shared_ptr<LoadedGLTF> currentGLTFPointer = std::make_shared<LoadedGLTF>();
-	currentGLTFPointer->_enginePtr = engine;
-	LoadedGLTF& currentGLTF = *currentGLTFPointer;
-	currentGLTF._descriptorPool.Init(engine->_logicalGPU, gltfAsset.materials.size(), poolSizeRatios);
+	return texture;
+}
 
-	std::vector<std::shared_ptr<MeshAsset>>    meshes;
-	std::vector<std::shared_ptr<Node>>         nodes;
-	std::vector<std::shared_ptr<GLTFMaterial>> materials;
+// Images a texture may sample, most preferred first: the DDS image from MSFT_texture_dds, the KTX2 image from
+// KHR_texture_basisu, then the core PNG/JPEG image they fall back to.
+static std::array<std::optional<size_t>, 3> GetTextureImageCandidates(const fastgltf::Texture& texture) {
+	const auto ToOptional = [](const fastgltf::Optional<size_t>& index) {
+		return index.has_value() ? std::optional<size_t>(*index) : std::nullopt;
+	};
+	return { ToOptional(texture.ddsImageIndex), ToOptional(texture.basisuImageIndex), ToOptional(texture.imageIndex) };
+}
 
-	// Load samplers
-	for (fastgltf::Sampler& sampler : gltfAsset.samplers) {
-		VkSamplerCreateInfo samplerCreateInfo = { .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO, .pNext = nullptr };
-		samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
-		samplerCreateInfo.minLod = 0;
-		samplerCreateInfo.magFilter = ExtractFilter(sampler.magFilter.value_or(fastgltf::Filter::Nearest));
-		samplerCreateInfo.minFilter = ExtractFilter(sampler.minFilter.value_or(fastgltf::Filter::Nearest));
-		samplerCreateInfo.mipmapMode = ExtractMipmapMode(sampler.minFilter.value_or(fastgltf::Filter::Nearest));
+// Calls visit for the TextureInfo of every texture slot of every material.
+template <typename VisitFunction>
+static void ForEachMaterialTexture(const fastgltf::Asset& asset, VisitFunction&& visit) {
+	for (const fastgltf::Material& material : asset.materials) {
+		if (material.pbrData.baseColorTexture.has_value()) {
+			visit(*material.pbrData.baseColorTexture, MaterialTextureSlot::Color);
+		}
+		if (material.pbrData.metallicRoughnessTexture.has_value()) {
+			visit(*material.pbrData.metallicRoughnessTexture, MaterialTextureSlot::MetalRough);
+		}
+		if (material.emissiveTexture.has_value()) {
+			visit(*material.emissiveTexture, MaterialTextureSlot::Emissive);
+		}
+		if (material.normalTexture.has_value()) {
+			visit(*material.normalTexture, MaterialTextureSlot::Normal);
+		}
+		if (material.specular && material.specular->specularTexture.has_value()) {
+			visit(*material.specular->specularTexture, MaterialTextureSlot::Specular);
+		}
+	}
+}
 
-		VkSampler      newSampler = VK_NULL_HANDLE;
-		const VkResult samRes = vkCreateSampler(engine->_logicalGPU, &samplerCreateInfo, nullptr, &newSampler);
-		if (samRes != VK_SUCCESS) {
-			LOG(Engine, Error, "vkCreateSampler failed: {}", static_cast<int>(samRes));
-			newSampler = engine->_defaultSamplerLinear;
+// Images some material will actually sample. DDS and KTX2 candidates parse in place, so whether one loads is known
+// before any decoding, and the core image behind it is only needed when it doesn't. Images no material samples are
+// never needed.
+static std::vector<uint8_t> FindNeededImages(const fastgltf::Asset& asset, const std::vector<std::optional<EncodedImage>>& encodedImages, const bool bTextureCompressionBC, const uint32_t maxImageDimension) {
+	std::vector<uint8_t>             bNeeded(asset.images.size(), 0);
+	std::vector<std::optional<bool>> bUsable(asset.images.size()); // Filled the first time a texture asks
+
+	const auto IsUsable = [&](const size_t imageIndex) {
+		std::optional<bool>& bImageUsable = bUsable[imageIndex];
+		if (bImageUsable.has_value()) {
+			return *bImageUsable;
 		}
 
-		currentGLTF._samplers.push_back(newSampler);
-	}
+		bImageUsable = encodedImages[imageIndex].has_value();
+		if (*bImageUsable && IsImageContainer(encodedImages[imageIndex]->bytes)) {
+			const std::optional<MipmappedTexture> container = ParseImageContainer(encodedImages[imageIndex]->bytes, maxImageDimension);
+			if (container.has_value() && PantomirFunctionLibrary::IsBlockCompressedFormat(container->format) && !bTextureCompressionBC) {
+				LOG(Engine, Warning, "Skipping block-compressed image {}, the device cannot sample BC formats", imageIndex);
+			}
+			bImageUsable = container.has_value() && (bTextureCompressionBC || !PantomirFunctionLibrary::IsBlockCompressedFormat(container->format));
+		}
+		return *bImageUsable;
+	};
 
-	// Images
-	currentGLTF._imagesByIndex.resize(gltfAsset.images.size(), engine->_errorCheckerboardImage);
+	ForEachMaterialTexture(asset, [&](const fastgltf::TextureInfo& textureInfo, MaterialTextureSlot) {
+		std::optional<size_t> firstCandidate;
+		for (const std::optional<size_t>& imageIndex : GetTextureImageCandidates(asset.textures[textureInfo.textureIndex])) {
+			if (!imageIndex.has_value()) {
+				continue;
+			}
+			if (IsUsable(*imageIndex)) {
+				bNeeded[*imageIndex] = 1;
+				return;
+			}
+			firstCandidate = firstCandidate.value_or(*imageIndex);
+		}
 
-	// Image deduplication map: maps image source key to loaded image
-	std::unordered_map<std::string, AllocatedImage> imageCache;
+		// Nothing loads, the preferred image still goes through the loader so the texture shows up as an error
+		if (firstCandidate.has_value()) {
+			bNeeded[*firstCandidate] = 1;
+		}
+	});
+	return bNeeded;
+}
 
-	// Load all textures with deduplication
-	for (size_t i = 0; i < gltfAsset.images.size(); ++i) {
-		fastgltf::Image& image = gltfAsset.images[i];
+// Picks a block format per image from the material slots that sample it. Normals only need two channels, the
+// metal-roughness and emissive maps no alpha. Base color, specular (its factor lives in alpha), and anything used in
+// more than one role or by no material keeps every channel with BC7.
+static std::vector<TextureCompression> ClassifyImageCompression(const fastgltf::Asset& asset) {
+	std::vector<std::optional<TextureCompression>> compressionByImage(asset.images.size());
+
+	// Precompressed candidates ignore the classification, marking them is harmless
+	const auto UseAs = [&](const fastgltf::TextureInfo& textureInfo, const TextureCompression compression) {
+		for (const std::optional<size_t>& imageIndex : GetTextureImageCandidates(asset.textures[textureInfo.textureIndex])) {
+			if (!imageIndex.has_value()) {
+				continue;
+			}
 
-		// Generate a unique source key for dedup
-		std::string      imageKey = GetImageSourceKey(gltfAsset, image);
+			std::optional<TextureCompression>& imageCompression = compressionByImage[*imageIndex];
+			imageCompression = !imageCompression.has_value() || *imageCompression == compression ? compression : TextureCompression::BC7;
+		}
+	};
 
-		AllocatedImage   img {};
-		if (auto it = imageCache.find(imageKey); it != imageCache.end()) {
-			img = it->second;
-		} else {
-			auto loaded = LoadImage(engine, gltfAsset, image);
-			img = loaded.value_or(engine->_errorCheckerboardImage);
-			if (loaded)
-				imageCache.emplace(std::move(imageKey), img);
+	ForEachMaterialTexture(asset, [&](const fastgltf::TextureInfo& textureInfo, const MaterialTextureSlot slot) {
+		switch (slot) {
+			case MaterialTextureSlot::MetalRough:
+			case MaterialTextureSlot::Emissive:
+				UseAs(textureInfo, TextureCompression::BC1);
+				break;
+			case MaterialTextureSlot::Normal:
+				UseAs(textureInfo, TextureCompression::BC5);
+				break;
+			default:
+				UseAs(textureInfo, TextureCompression::BC7);
+				break;
 		}
+	});
 
-		currentGLTF._imagesByIndex[i] = img;
+	std::vector<TextureCompression> result(asset.images.size());
+	for (size_t i = 0; i < asset.images.size(); ++i) {
+		result[i] = compressionByImage[i].value_or(TextureCompression::BC7);
 	}
+	return result;
+}
 
-	// Create buffer to hold the material data
-	currentGLTF._materialDataBuffer = engine->CreateBuffer(
-	    sizeof(GLTFMetallic_Roughness::MaterialConstants) * gltfAsset.materials.size(),
-	    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-	    VMA_MEMORY_USAGE_CPU_TO_GPU);
-	int                                        dataIndex = 0;
-	GLTFMetallic_Roughness::MaterialConstants* sceneMaterialConstants = static_cast<GLTFMetallic_Roughness::MaterialConstants*>(currentGLTF._materialDataBuffer.info.pMappedData);
+// What a glTF material needs to rewrite its material buffer entry once a streamed texture arrives.
+struct GLTFMaterialBinding {
+	std::shared_ptr<GLTFMaterial>                    material;
+	MaterialPass                                     passType;
+	VkCullModeFlagBits                               cullMode;
+	uint32_t                                         materialIndex; // Into the engine's global material buffer
+	GLTFMetallic_Roughness::MaterialConstants        constants;
+	std::array<int32_t, MATERIAL_TEXTURE_SLOT_COUNT> textureIndices;
+};
+
+// Textures of one LoadedGLTF that are still on their way. Decoding runs on the worker pool and GPU uploads are paced
+// per frame, materials sample placeholders in the meantime. Worker jobs hold a reference, so the scene can be unloaded
+// while they run.
+struct GLTFTextureStream {
+	enum class ImageState : uint8_t {
+		Decoding,
+		Uploading,
+		Ready,
+		Failed
+	};
 
-	for (fastgltf::Material& material : gltfAsset.materials) {
-		std::shared_ptr<GLTFMaterial> currentMaterial = std::make_shared<GLTFMaterial>();
-		materials.push_back(currentMaterial);
-		currentGLTF._materials[material.name.c_str()] = currentMaterial;
+	std::shared_ptr<const fastgltf::Asset>                    asset; // Embedded images are viewed in place
+	std::vector<std::optional<EncodedImage>>                  encodedImages;
+	std::vector<size_t>                                       uniqueImageIndexByImage; // NO_UNIQUE_IMAGE for images no material needs
+	std::vector<ImageState>                                   imageStates;     // Per unique image
+	std::vector<std::future<std::optional<MipmappedTexture>>> decodedTextures; // Per unique image, invalid once consumed
+	std::vector<std::pair<size_t, UploadHandle>>              uploadingImages;
+	std::vector<GLTFMaterialBinding>                          materials;
+	std::chrono::time_point<std::chrono::steady_clock>        startTime;
+};
+
+// Stands in for the unique image of images FindNeededImages left out, they are never loaded
+constexpr size_t NO_UNIQUE_IMAGE = std::numeric_limits<size_t>::max();
+
+// Staging bytes UpdateTextureStream hands to the upload batcher per frame, larger batches would stall the frame
+constexpr size_t TEXTURE_STREAM_UPLOAD_BUDGET = 32 * 1024 * 1024;
+
+// The image a texture samples. A candidate that is still decoding or uploading keeps the default texture for now.
+static std::optional<AllocatedImage> ResolveTextureImage(const PantomirEngine* engine, const LoadedGLTF& gltf, const GLTFTextureStream* stream, const fastgltf::Texture& texture) {
+	std::optional<AllocatedImage> fallback;
+	for (const std::optional<size_t>& imageIndex : GetTextureImageCandidates(texture)) {
+		if (!imageIndex.has_value()) {
+			continue;
+		}
 
-		GLTFMetallic_Roughness::MaterialConstants constants {};
-		constants.colorFactors.x = material.pbrData.baseColorFactor[0];
-		constants.colorFactors.y = material.pbrData.baseColorFactor[1];
-		constants.colorFactors.z = material.pbrData.baseColorFactor[2];
-		constants.colorFactors.w = material.pbrData.baseColorFactor[3];
+		if (stream != nullptr) {
+			const size_t uniqueIndex = stream->uniqueImageIndexByImage[*imageIndex];
+			if (uniqueIndex == NO_UNIQUE_IMAGE) {
+				continue;
+			}
 
-		constants.metalRoughFactors.x = material.pbrData.metallicFactor;
-		constants.metalRoughFactors.y = material.pbrData.roughnessFactor;
+			const GLTFTextureStream::ImageState state = stream->imageStates[uniqueIndex];
+			if (state == GLTFTextureStream::ImageState::Decoding || state == GLTFTextureStream::ImageState::Uploading) {
+				return std::nullopt;
+			}
+		}
 
-		constants.emissiveFactors.x = material.emissiveFactor[0];
-		constants.emissiveFactors.y = material.emissiveFactor[1];
-		constants.emissiveFactors.z = material.emissiveFactor[2];
+		// Take the first candidate that loaded, a DDS or KTX2 image the device cannot sample falls back to the core image
+		const AllocatedImage& image = gltf._imagesByIndex[*imageIndex];
+		if (image.image != engine->_errorCheckerboardImage.image) {
+			return image;
+		}
+		fallback = image;
+	}
+	return fallback;
+}
 
-		// Extensions
-		constants.emissiveStrength = material.emissiveStrength;
-		if (material.specular) {
-			constants.specularFactor = material.specular->specularFactor;
-		} else {
-			constants.specularFactor = 1.0f;
+// asset may be null for scenes that don't come from glTF, their materials reference no textures.
+static MaterialInstance WriteGltfMaterial(PantomirEngine* engine, LoadedGLTF& gltf, const GLTFTextureStream* stream, const fastgltf::Asset* asset, const GLTFMaterialBinding& binding) {
+	GLTFMetallic_Roughness::MaterialResources materialResources {};
+
+	// Default the material textures
+	materialResources.colorImage = engine->_whiteImage;
+	materialResources.colorSampler = engine->_defaultSamplerLinear;
+	materialResources.metalRoughImage = engine->_greyImage;
+	materialResources.metalRoughSampler = engine->_defaultSamplerLinear;
+	materialResources.emissiveImage = engine->_whiteImage;
+	materialResources.emissiveSampler = engine->_defaultSamplerLinear;
+	materialResources.normalImage = engine->_whiteImage;
+	materialResources.normalSampler = engine->_defaultSamplerLinear;
+	materialResources.specularImage = engine->_whiteImage;
+	materialResources.specularSampler = engine->_defaultSamplerLinear;
+
+	materialResources.constants = binding.constants;
+
+	// Grab textures from gltf file
+	const auto BindTexture = [&](const MaterialTextureSlot slot, AllocatedImage& out_image, VkSampler& out_sampler) {
+		const int32_t texIndex = binding.textureIndices[static_cast<size_t>(slot)];
+		if (texIndex < 0 || asset == nullptr) {
+			return;
 		}
 
-		if (material.alphaMode == fastgltf::AlphaMode::Blend) {
-			constants.alphaMode = 2;
-		} else if (material.alphaMode == fastgltf::AlphaMode::Mask) {
-			constants.alphaMode = 1;
-			constants.alphaCutoff = material.alphaCutoff;
-		} else {
-			constants.alphaMode = 0;
+		const fastgltf::Texture&            texture = asset->textures[texIndex];
+		const std::optional<AllocatedImage> image = ResolveTextureImage(engine, gltf, stream, texture);
+		if (!image.has_value()) {
+			return;
 		}
+		out_image = *image;
 
-		// Write material parameters to buffer
-		sceneMaterialConstants[dataIndex] = constants;
+		size_t samplerIndex = texture.samplerIndex.value();
+		out_sampler = gltf._samplers[samplerIndex];
+	};
 
-		GLTFMetallic_Roughness::MaterialResources materialResources {};
+	BindTexture(MaterialTextureSlot::Color, materialResources.colorImage, materialResources.colorSampler);
+	BindTexture(MaterialTextureSlot::MetalRough, materialResources.metalRoughImage, materialResources.metalRoughSampler);
+	BindTexture(MaterialTextureSlot::Emissive, materialResources.emissiveImage, materialResources.emissiveSampler);
+	BindTexture(MaterialTextureSlot::Normal, materialResources.normalImage, materialResources.normalSampler);
+	BindTexture(MaterialTextureSlot::Specular, materialResources.specularImage, materialResources.specularSampler);
 
-		// Default the material textures
-		materialResources.colorImage = engine->_whiteImage;
-		materialResources.colorSampler = engine->_defaultSamplerLinear;
-		materialResources.metalRoughImage = engine->_greyImage;
-		materialResources.metalRoughSampler = engine->_defaultSamplerLinear;
-		materialResources.emissiveImage = engine->_whiteImage;
-		materialResources.emissiveSampler = engine->_defaultSamplerLinear;
-		materialResources.normalImage = engine->_whiteImage;
-		materialResources.normalSampler = engine->_defaultSamplerLinear;
-		materialResources.specularImage = engine->_whiteImage;
-		materialResources.specularSampler = engine->_defaultSamplerLinear;
+	return engine->_metalRoughMaterial.WriteMaterial(engine->_logicalGPU, binding.passType, binding.cullMode, materialResources, binding.materialIndex);
+}
 
-		// Set the uniform buffer for the material data
-		materialResources.dataBuffer = currentGLTF._materialDataBuffer.buffer;
-		materialResources.dataBufferOffset = dataIndex * sizeof(GLTFMetallic_Roughness::MaterialConstants);
+// Materials, meshes and the node hierarchy of a cooked scene, shared by every source format. Queues the mesh and
+// meshlet uploads, the caller submits them. asset resolves the materials' texture indices, null when there are none.
+static void BuildLoadedScene(PantomirEngine* engine, LoadedGLTF& gltf, const CookedSceneView& scene, const fastgltf::Asset* asset) {
+	std::vector<std::shared_ptr<MeshAsset>>    meshes;
+	std::vector<std::shared_ptr<Node>>         nodes;
+	std::vector<std::shared_ptr<GLTFMaterial>> materials;
+	std::vector<GLTFMaterialBinding>           materialBindings;
+	materialBindings.reserve(scene.materials.size());
 
-		// Grab textures from gltf file
-		if (material.pbrData.baseColorTexture.has_value()) {
-			size_t texIndex = material.pbrData.baseColorTexture->textureIndex;
-			size_t imageIndex = gltfAsset.textures[texIndex].imageIndex.value();
-			size_t sampler = gltfAsset.textures[texIndex].samplerIndex.value();
+	// Material parameters and texture indices go to the engine's global material buffer, one entry per material
+	for (const CookedMaterial& material : scene.materials) {
+		std::shared_ptr<GLTFMaterial> currentMaterial = std::make_shared<GLTFMaterial>();
+		materials.push_back(currentMaterial);
+		gltf._materials[std::string(scene.GetName(material.name))] = currentMaterial;
+
+		const GLTFMaterialBinding binding {
+			.material = currentMaterial,
+			.passType = material.passType,
+			.cullMode = material.bDoubleSided ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT,
+			.materialIndex = engine->_metalRoughMaterial.AllocateMaterial(),
+			.constants = material.constants,
+			.textureIndices = material.textureIndices
+		};
+		gltf._materialIndices.push_back(binding.materialIndex);
+		currentMaterial->data = WriteGltfMaterial(engine, gltf, gltf._textureStream.get(), asset, binding);
+		materialBindings.push_back(binding);
+	}
 
-			materialResources.colorImage = currentGLTF._imagesByIndex[imageIndex];
-			materialResources.colorSampler = currentGLTF._samplers[sampler];
-		}
+	// Streamed materials are rewritten as their textures arrive
+	if (gltf._textureStream != nullptr) {
+		gltf._textureStream->materials = std::move(materialBindings);
+	}
 
-		if (material.pbrData.metallicRoughnessTexture.has_value()) {
-			size_t texIndex = material.pbrData.metallicRoughnessTexture->textureIndex;
-			size_t imageIndex = gltfAsset.textures[texIndex].imageIndex.value();
-			size_t sampler = gltfAsset.textures[texIndex].samplerIndex.value();
+	// Vertex and index data is copied straight from the cooked blobs (or the mapped cache file) into staging memory.
+	// The whole file shares one vertex and one index buffer, meshes only keep their offsets into them.
+	if (!scene.indices16.empty() || !scene.indices32.empty()) {
+		gltf._meshBuffers = engine->UploadMesh(scene.indices16, scene.indices32, scene.vertices);
+	}
 
-			materialResources.metalRoughImage = currentGLTF._imagesByIndex[imageIndex];
-			materialResources.metalRoughSampler = currentGLTF._samplers[sampler];
+	// Cooked meshlets are relative to their mesh, the renderer draws them straight from the scene-wide buffers
+	gltf._meshlets.assign(scene.meshlets.begin(), scene.meshlets.end());
+	for (const CookedMesh& mesh : scene.meshes) {
+		for (const CookedSurface& surface : scene.surfaces.subspan(mesh.firstSurface, mesh.surfaceCount)) {
+			for (Meshlet& meshlet : std::span(gltf._meshlets).subspan(surface.firstMeshlet, surface.meshletCount)) {
+				meshlet.firstIndex += static_cast<uint32_t>(mesh.firstIndex);
+				meshlet.vertexOffset = static_cast<int32_t>(mesh.firstVertex);
+			}
 		}
+	}
+	if (!gltf._meshlets.empty()) {
+		const size_t meshletBufferSize = gltf._meshlets.size() * sizeof(Meshlet);
+		gltf._meshletBuffer = engine->CreateBuffer(meshletBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+		gltf._meshletBufferAddress = engine->GetBufferDeviceAddress(gltf._meshletBuffer);
+		engine->_uploadBatcher.EnqueueBufferUpload(gltf._meshletBuffer.buffer, gltf._meshlets.data(), meshletBufferSize);
+	}
 
-		if (material.emissiveTexture.has_value()) {
-			size_t texIndex = material.emissiveTexture->textureIndex;
-			size_t imageIndex = gltfAsset.textures[texIndex].imageIndex.value();
-			size_t samplerIndex = gltfAsset.textures[texIndex].samplerIndex.value();
+	for (const CookedMesh& mesh : scene.meshes) {
+		std::shared_ptr<MeshAsset> newMesh = std::make_shared<MeshAsset>();
+		meshes.push_back(newMesh);
+		newMesh->name = scene.GetName(mesh.name);
+		gltf._meshes[newMesh->name] = newMesh;
 
-			materialResources.emissiveImage = currentGLTF._imagesByIndex[imageIndex];
-			materialResources.emissiveSampler = currentGLTF._samplers[samplerIndex];
+		for (const CookedSurface& surface : scene.surfaces.subspan(mesh.firstSurface, mesh.surfaceCount)) {
+			GeoSurface newSurface;
+			newSurface.startIndex = static_cast<uint32_t>(mesh.firstIndex) + surface.startIndex;
+			newSurface.count = surface.count;
+			newSurface.vertexOffset = static_cast<int32_t>(mesh.firstVertex);
+			newSurface.bounds = surface.bounds;
+			newSurface.material = materials[surface.materialIndex];
+			newSurface.firstMeshlet = surface.firstMeshlet;
+			newSurface.meshletCount = surface.meshletCount;
+			newSurface.firstLOD = static_cast<uint32_t>(newMesh->lods.size());
+			newSurface.lodCount = surface.lodCount;
+			newMesh->surfaces.push_back(newSurface);
+
+			for (SurfaceLOD lod : scene.lods.subspan(surface.firstLOD, surface.lodCount)) {
+				lod.startIndex += static_cast<uint32_t>(mesh.firstIndex);
+				newMesh->lods.push_back(lod);
+			}
 		}
 
-		if (material.normalTexture.has_value()) {
-			size_t texIndex = material.normalTexture->textureIndex;
-			size_t imageIndex = gltfAsset.textures[texIndex].imageIndex.value();
-			size_t samplerIndex = gltfAsset.textures[texIndex].samplerIndex.value();
+		newMesh->meshBuffers = gltf._meshBuffers;
+		newMesh->indexType = mesh.indexType;
+		newMesh->positionOffset = mesh.quantization.offset;
+		newMesh->positionScale = mesh.quantization.scale;
+		newMesh->meshlets = gltf._meshlets;
+		newMesh->meshletBufferAddress = gltf._meshletBufferAddress;
+	}
 
-			materialResources.normalImage = currentGLTF._imagesByIndex[imageIndex];
-			materialResources.normalSampler = currentGLTF._samplers[samplerIndex];
+	// Load all nodes and their attached meshes
+	for (const CookedNode& cookedNode : scene.nodes) {
+		std::shared_ptr<Node> newNode;
+
+		// If the node has a mesh, create a MeshNode and assign the corresponding mesh
+		if (cookedNode.meshIndex >= 0) {
+			auto meshNode = std::make_shared<MeshNode>();
+			meshNode->_mesh = meshes[cookedNode.meshIndex];
+			newNode = meshNode;
+		} else {
+			newNode = std::make_shared<Node>();
 		}
 
-		if (material.specular && material.specular->specularTexture.has_value()) {
-			size_t texIndex = material.specular->specularTexture->textureIndex;
-			size_t imageIndex = gltfAsset.textures[texIndex].imageIndex.value();
-			size_t samplerIndex = gltfAsset.textures[texIndex].samplerIndex.value();
+		newNode->_localTransform = cookedNode.localTransform;
+		nodes.push_back(newNode);
+
+		gltf._nodes[std::string(scene.GetName(cookedNode.name))] = newNode;
+	}
+
+	// Build entity hierarchy
+	for (size_t index = 0; index < scene.nodes.size(); index++) {
+		const CookedNode&      cookedNode = scene.nodes[index];
+		std::shared_ptr<Node>& sceneNode = nodes[index];
 
-			materialResources.specularImage = currentGLTF._imagesByIndex[imageIndex];
-			materialResources.specularSampler = currentGLTF._samplers[samplerIndex];
+		for (const uint32_t child : scene.childIndices.subspan(cookedNode.firstChild, cookedNode.childCount)) {
+			sceneNode->_children.push_back(nodes[child]);
+			nodes[child]->_parent = sceneNode;
 		}
+	}
 
-		MaterialPass passType = MaterialPass::Opaque;
-		if (material.alphaMode == fastgltf::AlphaMode::Blend) {
-			passType = MaterialPass::AlphaBlend;
+	// Go through built nodes, propagate transforms on parents so it travels through everything.
+	for (std::shared_ptr<Node>& node : nodes) {
+		if (node->_parent.lock() == nullptr) {
+			gltf._topNodes.push_back(node);
+			node->PropagateTransform(glm::mat4 { 1.F });
 		}
-		if (material.alphaMode == fastgltf::AlphaMode::Mask) {
-			passType = MaterialPass::AlphaMask;
+	}
+}
+
+// Queues one decode job per unique image. Nothing here waits on them, UpdateTextureStream collects the results.
+static std::shared_ptr<GLTFTextureStream> StartTextureStream(PantomirEngine* engine, std::shared_ptr<const fastgltf::Asset> asset, std::vector<std::optional<EncodedImage>>&& encodedImages, const std::vector<ContentHash>& imageHashes, std::vector<size_t>&& uniqueImageIndexByImage, const std::vector<size_t>& firstImageByUniqueImage, const std::vector<TextureCompression>& compressionByUniqueImage) {
+	const size_t                       uniqueImageCount = firstImageByUniqueImage.size();
+
+	std::shared_ptr<GLTFTextureStream> stream = std::make_shared<GLTFTextureStream>();
+	stream->asset = std::move(asset);
+	stream->encodedImages = std::move(encodedImages);
+	stream->uniqueImageIndexByImage = std::move(uniqueImageIndexByImage);
+	stream->imageStates.resize(uniqueImageCount, GLTFTextureStream::ImageState::Decoding);
+	stream->decodedTextures.resize(uniqueImageCount);
+	stream->startTime = std::chrono::steady_clock::now();
+
+	const bool     bTextureCompressionBC = engine->_bTextureCompressionBC;
+	const uint32_t maxImageDimension = engine->_maxImageDimension2D;
+	for (size_t uniqueIndex = 0; uniqueIndex < uniqueImageCount; ++uniqueIndex) {
+		const size_t imageIndex = firstImageByUniqueImage[uniqueIndex];
+		if (!stream->encodedImages[imageIndex].has_value()) {
+			stream->imageStates[uniqueIndex] = GLTFTextureStream::ImageState::Failed;
+			continue;
 		}
-		VkCullModeFlagBits cullMode = material.doubleSided ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT;
 
-		currentMaterial->data = engine->_metalRoughMaterial.WriteMaterial(engine->_logicalGPU, passType, cullMode, materialResources, currentGLTF._descriptorPool);
+		// The encoded bytes stay put until the main thread has consumed the future
+		stream->decodedTextures[uniqueIndex] = engine->_threadPool.Submit([stream, imageIndex, contentHash = imageHashes[imageIndex], compression = compressionByUniqueImage[uniqueIndex], bTextureCompressionBC, maxImageDimension]() {
+			TextureSource source = TextureSource::Decoded;
+			return LoadMipmappedTexture(*stream->encodedImages[imageIndex], contentHash, compression, bTextureCompressionBC, maxImageDimension, source);
+		});
+	}
+
+	return stream;
+}
 
-		dataIndex++;
+// TODO: Only usage is here, maybe don't make this a free function available to everywhere.
+std::optional<AllocatedImage> LoadImage(PantomirEngine* engine, fastgltf::Asset& asset, fastgltf::Image& image) {
+	const std::optional<EncodedImage> encodedImage = ReadEncodedImage(asset, image);
+	if (!encodedImage.has_value()) {
+		return std::nullopt;
 	}
 
-	// Use the same vectors for all meshes so that the memory doesn't reallocate as often
-	std::vector<uint32_t> indices;
-	std::vector<Vertex>   vertices;
+	TextureSource                         source = TextureSource::Decoded;
+	const TextureCompression              compression = engine->_bTextureCompressionBC ? TextureCompression::BC7 : TextureCompression::None;
+	const std::optional<MipmappedTexture> texture = LoadMipmappedTexture(*encodedImage, ContentHash::FromBytes(encodedImage->bytes), compression, engine->_bTextureCompressionBC, engine->_maxImageDimension2D, source);
+	if (!texture.has_value()) {
+		return std::nullopt;
+	}
 
-	for (fastgltf::Mesh& mesh : gltfAsset.meshes) {
-		std::shared_ptr<MeshAsset> newMesh = std::make_shared<MeshAsset>();
-		meshes.push_back(newMesh);
-		currentGLTF._meshes[mesh.name.c_str()] = newMesh;
-		newMesh->name = mesh.name;
+	return engine->CreateImage(*texture, VK_IMAGE_USAGE_SAMPLED_BIT);
+}
 
-		// Clear the mesh arrays each mesh, we don't want to merge them by error
-		indices.clear();
-		vertices.clear();
+// We use fastgltf to parse the json over a mapping of the file, then we use STBI to decode the images in place.
+std::optional<std::shared_ptr<LoadedGLTF>> LoadGltf(PantomirEngine* engine, const std::string_view& filePath) {
+	LOG(Engine, Info, "Loading GLTF: {}", filePath);
+	fastgltf::Parser                           parser { fastgltf::Extensions::KHR_materials_emissive_strength | fastgltf::Extensions::KHR_materials_specular | fastgltf::Extensions::MSFT_texture_dds | fastgltf::Extensions::KHR_texture_basisu };
+	constexpr fastgltf::Options                gltfParserOptions { fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble };
+	std::filesystem::path                      path(filePath);
+	std::optional<std::shared_ptr<GltfSource>> sourceResult = LoadGltfSource(parser, path, gltfParserOptions);
+	if (!sourceResult.has_value()) {
+		return std::nullopt;
+	}
+	// Shared with the texture stream, which keeps the mappings alive while images are still decoding out of them
+	const std::shared_ptr<GltfSource>      source = std::move(*sourceResult);
+	const std::shared_ptr<fastgltf::Asset> gltfAssetPointer(source, &source->asset);
+	fastgltf::Asset&                       gltfAsset = *gltfAssetPointer;
+
+	// Geometry, hierarchy and material parameters come from the cooked cache when it still matches the source. It is
+	// looked up before any image work, a miss is cooked once the images are underway.
+	const std::chrono::time_point<std::chrono::steady_clock> cacheLookupStart = std::chrono::steady_clock::now();
+	const std::filesystem::path                              cachePath = GetMeshCachePath(path);
+	const ContentHash                                        sourceHash = HashGltfSource(source->file, path, gltfAsset);
+
+	Pantomir::MappedFile                                     cacheFile; // Must outlive the uploads below, the cooked view points into it
+	CookedScene                                              cookedScene;
+	std::optional<CookedSceneView>                           cookedView;
+	if (cacheFile.Open(cachePath)) {
+		cookedView = ReadMeshCache(cacheFile, sourceHash, engine->_bOptimizeMeshes, gltfAsset.textures.size());
+	}
+	const bool                               bCacheHit = cookedView.has_value();
+	std::chrono::duration<float, std::milli> cookTime = std::chrono::steady_clock::now() - cacheLookupStart;
 
-		for (fastgltf::Primitive& primitive : mesh.primitives) {
-			GeoSurface newSurface;
-			newSurface.startIndex = static_cast<uint32_t>(indices.size());
-			newSurface.count = static_cast<uint32_t>(gltfAsset.accessors[primitive.indicesAccessor.value()].count);
+	std::shared_ptr<LoadedGLTF>              currentGLTFPointer = std::make_shared<LoadedGLTF>();
+	currentGLTFPointer->_enginePtr = engine;
+	LoadedGLTF& currentGLTF = *currentGLTFPointer;
 
-			size_t initialVertex = vertices.size();
+	// Load samplers
+	for (fastgltf::Sampler& sampler : gltfAsset.samplers) {
+		VkSamplerCreateInfo samplerCreateInfo = { .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO, .pNext = nullptr };
+		samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+		samplerCreateInfo.minLod = 0;
+		samplerCreateInfo.magFilter = ExtractFilter(sampler.magFilter.value_or(fastgltf::Filter::Nearest));
+		samplerCreateInfo.minFilter = ExtractFilter(sampler.minFilter.value_or(fastgltf::Filter::Nearest));
+		samplerCreateInfo.mipmapMode = ExtractMipmapMode(sampler.minFilter.value_or(fastgltf::Filter::Nearest));
 
-			// Load indexes
-			{
-				fastgltf::Accessor& indexAccessor = gltfAsset.accessors[primitive.indicesAccessor.value()];
-				indices.reserve(indices.size() + indexAccessor.count);
+		VkSampler      newSampler = VK_NULL_HANDLE;
+		const VkResult samRes = vkCreateSampler(engine->_logicalGPU, &samplerCreateInfo, nullptr, &newSampler);
+		if (samRes != VK_SUCCESS) {
+			LOG(Engine, Error, "vkCreateSampler failed: {}", static_cast<int>(samRes));
+			newSampler = engine->_defaultSamplerLinear;
+		}
 
-				fastgltf::iterateAccessor<std::uint32_t>(gltfAsset, indexAccessor, [&](std::uint32_t index) {
-					indices.push_back(index + initialVertex);
-				});
-			}
+		currentGLTF._samplers.push_back(newSampler);
+	}
 
-			// Load vertex positions
-			{
-				fastgltf::Accessor& posAccessor = gltfAsset.accessors[primitive.findAttribute("POSITION")->accessorIndex];
-				vertices.resize(vertices.size() + posAccessor.count);
-
-				fastgltf::iterateAccessorWithIndex<glm::vec3>(gltfAsset, posAccessor, [&](glm::vec3 vertex, size_t index) {
-					Vertex newVertex {};
-					newVertex.position = vertex;
-					newVertex.normal = { 1, 0, 0 };
-					newVertex.color = glm::vec4 { 1.f };
-					newVertex.uv_x = 0;
-					newVertex.uv_y = 0;
-					vertices[initialVertex + index] = newVertex;
-				});
-			}
+	// Images
+	currentGLTF._imagesByIndex.resize(gltfAsset.images.size(), engine->_errorCheckerboardImage);
 
-			// Load vertex normals
-			if (fastgltf::Attribute* normals = primitive.findAttribute("NORMAL"); normals != primitive.attributes.end()) {
-				fastgltf::iterateAccessorWithIndex<glm::vec3>(gltfAsset, gltfAsset.accessors[normals->accessorIndex], [&](glm::vec3 vertex, size_t index) {
-					vertices[initialVertex + index].normal = vertex;
-				});
-			}
+	// Only views the encoded bytes, buffers and URIs were mapped when the asset was parsed
+	std::vector<std::optional<EncodedImage>> encodedImages(gltfAsset.images.size());
+	for (size_t imageIndex = 0; imageIndex < gltfAsset.images.size(); ++imageIndex) {
+		encodedImages[imageIndex] = ReadEncodedImage(gltfAsset, gltfAsset.images[imageIndex]);
+	}
 
-			// Load vertex tangents
-			if (fastgltf::Attribute* tangents = primitive.findAttribute("TANGENT"); tangents != primitive.attributes.end()) {
-				fastgltf::iterateAccessorWithIndex<glm::vec4>(gltfAsset, gltfAsset.accessors[tangents->accessorIndex], [&](glm::vec4 tangent, size_t index) {
-					vertices[initialVertex + index].tangent = tangent;
-				});
-			}
+	// Hash the encoded bytes of every needed image. XXH3 runs at memory speed, faulting in the mapped pages dominates.
+	const std::vector<uint8_t> bImageNeeded = FindNeededImages(gltfAsset, encodedImages, engine->_bTextureCompressionBC, engine->_maxImageDimension2D);
+	std::vector<ContentHash>   imageHashes(gltfAsset.images.size());
+	engine->_threadPool.ParallelFor(gltfAsset.images.size(), [&](const size_t imageIndex) {
+		if (bImageNeeded[imageIndex] && encodedImages[imageIndex].has_value()) {
+			imageHashes[imageIndex] = ContentHash::FromBytes(encodedImages[imageIndex]->bytes);
+		}
+	});
 
-			// Load UVs
-			if (fastgltf::Attribute* uv = primitive.findAttribute("TEXCOORD_0"); uv != primitive.attributes.end()) {
-				fastgltf::iterateAccessorWithIndex<glm::vec2>(gltfAsset, gltfAsset.accessors[uv->accessorIndex], [&](glm::vec2 vertex, size_t index) {
-					vertices[initialVertex + index].uv_x = vertex.x;
-					vertices[initialVertex + index].uv_y = vertex.y;
-				});
-			}
+	// Image deduplication: images with identical encoded bytes share one decode and one GPU image.
+	std::unordered_map<ContentHash, size_t, ContentHashHasher> uniqueImageByHash;
+	std::vector<size_t>                                        uniqueImageIndexByImage(gltfAsset.images.size());
+	std::vector<size_t>                                        firstImageByUniqueImage;
+	size_t                                                     skippedImageCount = 0;
+	for (size_t i = 0; i < gltfAsset.images.size(); ++i) {
+		if (!bImageNeeded[i]) {
+			// Unused, or the fallback of a DDS or KTX2 image that loads fine. Its slot keeps the error texture.
+			encodedImages[i].reset();
+			uniqueImageIndexByImage[i] = NO_UNIQUE_IMAGE;
+			++skippedImageCount;
+			continue;
+		}
 
-			// Load vertex colors
-			if (fastgltf::Attribute* colors = primitive.findAttribute("COLOR_0"); colors != primitive.attributes.end()) {
-				fastgltf::iterateAccessorWithIndex<glm::vec4>(gltfAsset, gltfAsset.accessors[colors->accessorIndex], [&](glm::vec4 vertex, size_t index) {
-					vertices[initialVertex + index].color = vertex;
-				});
+		if (!encodedImages[i].has_value()) {
+			// Unresolvable images keep their own slot and end up as the error texture
+			uniqueImageIndexByImage[i] = firstImageByUniqueImage.size();
+			firstImageByUniqueImage.push_back(i);
+			continue;
+		}
+
+		auto [it, bInserted] = uniqueImageByHash.try_emplace(imageHashes[i], firstImageByUniqueImage.size());
+		if (bInserted) {
+			firstImageByUniqueImage.push_back(i);
+		} else {
+			// Duplicate, only the first image with these bytes is decoded
+			encodedImages[i].reset();
+		}
+		uniqueImageIndexByImage[i] = it->second;
+	}
+
+	// Duplicates that ended up in different roles are compressed for the most demanding one
+	const size_t                    uniqueImageCount = firstImageByUniqueImage.size();
+	std::vector<TextureCompression> compressionByUniqueImage(uniqueImageCount, TextureCompression::None);
+	if (engine->_bTextureCompressionBC) {
+		const std::vector<TextureCompression> compressionByImage = ClassifyImageCompression(gltfAsset);
+		std::vector<uint8_t>                  bAssigned(uniqueImageCount, 0);
+		for (size_t i = 0; i < gltfAsset.images.size(); ++i) {
+			const size_t uniqueIndex = uniqueImageIndexByImage[i];
+			if (uniqueIndex == NO_UNIQUE_IMAGE) {
+				continue;
 			}
 
-			if (primitive.materialIndex.has_value()) {
-				newSurface.material = materials[primitive.materialIndex.value()];
+			if (!bAssigned[uniqueIndex] || compressionByUniqueImage[uniqueIndex] == compressionByImage[i]) {
+				compressionByUniqueImage[uniqueIndex] = compressionByImage[i];
 			} else {
-				newSurface.material = materials[0];
+				compressionByUniqueImage[uniqueIndex] = TextureCompression::BC7;
 			}
+			bAssigned[uniqueIndex] = 1;
+		}
+	}
 
-			// Loop the vertices of this surface, find min/max bounds
-			glm::vec3 minPosition = vertices[initialVertex].position;
-			glm::vec3 maxPosition = vertices[initialVertex].position;
-			for (int index = initialVertex; index < vertices.size(); index++) {
-				minPosition = glm::min(minPosition, vertices[index].position);
-				maxPosition = glm::max(maxPosition, vertices[index].position);
+	if (engine->_bStreamTextures) {
+		// Placeholders until UpdateTextureStream swaps the real images in, the scene can draw as soon as its geometry lands
+		currentGLTF._textureStream = StartTextureStream(engine, gltfAssetPointer, std::move(encodedImages), imageHashes, std::move(uniqueImageIndexByImage), firstImageByUniqueImage, compressionByUniqueImage);
+		LOG(Engine, Info, "Streaming {} unique images ({} referenced, {} skipped) on {} threads", uniqueImageCount, gltfAsset.images.size(), skippedImageCount, engine->_threadPool.GetThreadCount());
+	} else {
+		// Map cached mip chains or decode and build them across the worker pool. Each job writes only its own slot.
+		std::vector<std::optional<MipmappedTexture>>          textures(uniqueImageCount);
+		std::vector<TextureSource>                            textureSources(uniqueImageCount, TextureSource::Decoded);
+		std::vector<std::chrono::duration<float, std::milli>> decodeTimes(uniqueImageCount);
+
+		const std::chrono::time_point<std::chrono::steady_clock> decodeStart = std::chrono::steady_clock::now();
+		engine->_threadPool.ParallelFor(uniqueImageCount, [&](const size_t uniqueIndex) {
+			const std::chrono::time_point<std::chrono::steady_clock> jobStart = std::chrono::steady_clock::now();
+			const size_t                                             imageIndex = firstImageByUniqueImage[uniqueIndex];
+			if (const std::optional<EncodedImage>& encodedImage = encodedImages[imageIndex]; encodedImage.has_value()) {
+				textures[uniqueIndex] = LoadMipmappedTexture(*encodedImage, imageHashes[imageIndex], compressionByUniqueImage[uniqueIndex], engine->_bTextureCompressionBC, engine->_maxImageDimension2D, textureSources[uniqueIndex]);
 			}
+			decodeTimes[uniqueIndex] = std::chrono::steady_clock::now() - jobStart;
+		});
+		const std::chrono::duration<float, std::milli> decodeWallTime = std::chrono::steady_clock::now() - decodeStart;
 
-			// Calculate origin and extents from the min/max, use extent length for radius
-			newSurface.bounds.originPoint = (maxPosition + minPosition) / 2.f;
-			newSurface.bounds.extents = (maxPosition - minPosition) / 2.f;
-			newSurface.bounds.sphereRadius = glm::length(newSurface.bounds.extents);
+		std::chrono::duration<float, std::milli>       decodeCpuTime {};
+		for (const std::chrono::duration<float, std::milli>& decodeTime : decodeTimes) {
+			decodeCpuTime += decodeTime;
+		}
 
-			newMesh->surfaces.push_back(newSurface);
+		engine->_stats.textureDecodeWallTime += decodeWallTime.count();
+		engine->_stats.textureDecodeCpuTime += decodeCpuTime.count();
+		LOG(Engine, Info, "Prepared {} unique images ({} referenced, {} skipped, {} from texture cache, {} precompressed) in {:.2f} ms wall / {:.2f} ms CPU on {} threads",
+		    uniqueImageCount,
+		    gltfAsset.images.size(),
+		    skippedImageCount,
+		    std::ranges::count(textureSources, TextureSource::Cache),
+		    std::ranges::count(textureSources, TextureSource::Container),
+		    decodeWallTime.count(),
+		    decodeCpuTime.count(),
+		    engine->_threadPool.GetThreadCount() + 1);
+
+		// GPU upload stays serialized on this thread. Staging copies happen here, so cache mappings and the encoded bytes
+		// precompressed textures view can be released right after.
+		std::vector<AllocatedImage> uniqueImages(uniqueImageCount, engine->_errorCheckerboardImage);
+		size_t                      textureBytes = 0;
+		for (size_t uniqueIndex = 0; uniqueIndex < uniqueImageCount; ++uniqueIndex) {
+			if (const std::optional<MipmappedTexture>& texture = textures[uniqueIndex]; texture.has_value()) {
+				uniqueImages[uniqueIndex] = engine->CreateImage(*texture, VK_IMAGE_USAGE_SAMPLED_BIT);
+				textureBytes += texture->pixels.size();
+			}
 		}
+		textures.clear();
+		encodedImages.clear();
+		LOG(Engine, Info, "Uploading {:.2f} MB of texture data ({})", static_cast<double>(textureBytes) / (1024.0 * 1024.0), engine->_bTextureCompressionBC ? "BCn" : "RGBA8");
 
-		newMesh->meshBuffers = engine->UploadMesh(indices, vertices);
+		for (size_t i = 0; i < gltfAsset.images.size(); ++i) {
+			if (uniqueImageIndexByImage[i] != NO_UNIQUE_IMAGE) {
+				currentGLTF._imagesByIndex[i] = uniqueImages[uniqueImageIndexByImage[i]];
+			}
+		}
 	}
 
-	// Load all nodes and their attached meshes
-	for (fastgltf::Node& gltfNode : gltfAsset.nodes) {
-		std::shared_ptr<Node> newNode;
-
-		// If the node has a mesh, create a MeshNode and assign the corresponding mesh
-		if (gltfNode.meshIndex.has_value()) {
-			auto meshNode = std::make_shared<MeshNode>();
-			meshNode->_mesh = meshes[*gltfNode.meshIndex];
-			newNode = meshNode;
-		} else {
-			newNode = std::make_shared<Node>();
-		}
+	const std::chrono::time_point<std::chrono::steady_clock> cookStart = std::chrono::steady_clock::now();
+	if (!bCacheHit) {
+		cacheFile.Close();
+		cookedScene = CookScene(gltfAsset, engine->_bOptimizeMeshes);
+		cookedView = cookedScene.View();
+		WriteMeshCache(cachePath, sourceHash, engine->_bOptimizeMeshes, *cookedView);
+	}
+	const CookedSceneView& scene = *cookedView;
 
-		nodes.push_back(newNode);
+	BuildLoadedScene(engine, currentGLTF, scene, &gltfAsset);
 
-		currentGLTF._nodes[gltfNode.name.c_str()] = newNode;
+	cookTime += std::chrono::steady_clock::now() - cookStart;
+	LOG(Engine, Info, "{} mesh data for {} in {:.2f} ms ({} vertices, {} indices, {} of them 16-bit)",
+	    bCacheHit ? "Mapped cached" : "Cooked",
+	    path.filename().string(),
+	    cookTime.count(),
+	    scene.vertices.size(),
+	    scene.indices16.size() + scene.indices32.size(),
+	    scene.indices16.size());
 
-		std::visit(fastgltf::visitor {
-		               [&](const fastgltf::math::fmat4x4& matrix) {
-			               memcpy(&newNode->_localTransform, matrix.data(), sizeof(matrix));
-		               },
-		               // Handle TRS (Translation-Rotation-Scale) transform
-		               [&](const fastgltf::TRS& transform) {
-			               const glm::vec3 translation(transform.translation[0], transform.translation[1], transform.translation[2]);
-			               const glm::quat rotation(transform.rotation[3], transform.rotation[0], transform.rotation[1], transform.rotation[2]); // Note: glTF uses (x, y, z, w)
-			               const glm::vec3 scale(transform.scale[0], transform.scale[1], transform.scale[2]);
+	// Every mesh and, unless they are streamed, every image of this file goes out in one batch
+	currentGLTF._uploadHandle = engine->_uploadBatcher.Submit();
 
-			               const glm::mat4 Translation = glm::translate(glm::mat4(1.0F), translation);
-			               const glm::mat4 Rotation = glm::toMat4(rotation);
-			               const glm::mat4 Scale = glm::scale(glm::mat4(1.0F), scale);
+	return currentGLTFPointer;
+}
 
-			               newNode->_localTransform = Translation * Rotation * Scale;
-		               },
-		           },
-		           gltfNode.transform);
+// OBJ files carry no textures, so the whole load is cooking (or mapping the cached cook) and queueing the upload.
+std::optional<std::shared_ptr<LoadedGLTF>> LoadObj(PantomirEngine* engine, const std::string_view& filePath) {
+	LOG(Engine, Info, "Loading OBJ: {}", filePath);
+	const std::filesystem::path path(filePath);
+	Pantomir::MappedFile        sourceFile;
+	if (!sourceFile.Open(path)) {
+		LOG(Engine, Error, "Failed to map OBJ file '{}'", path.string());
+		return std::nullopt;
 	}
 
-	// Build entity hierarchy
-	for (int index = 0; index < gltfAsset.nodes.size(); index++) {
-		fastgltf::Node&        node = gltfAsset.nodes[index];
-		std::shared_ptr<Node>& sceneNode = nodes[index];
+	const std::chrono::time_point<std::chrono::steady_clock> cookStart = std::chrono::steady_clock::now();
+	const std::filesystem::path                              cachePath = GetMeshCachePath(path);
+	const ContentHash                                        sourceHash = ContentHash::FromBytes(sourceFile.Bytes());
 
-		for (size_t& child : node.children) {
-			sceneNode->_children.push_back(nodes[child]);
-			nodes[child]->_parent = sceneNode;
-		}
+	Pantomir::MappedFile           cacheFile; // Must outlive the uploads below, the cooked view points into it
+	std::optional<CookedScene>     cookedScene;
+	std::optional<CookedSceneView> cookedView;
+	if (cacheFile.Open(cachePath)) {
+		cookedView = ReadMeshCache(cacheFile, sourceHash, engine->_bOptimizeMeshes, 0); // OBJ materials sample no textures
 	}
 
-	// Go through built nodes, propagate transforms on parents so it travels through everything.
-	for (std::shared_ptr<Node>& node : nodes) {
-		if (node->_parent.lock() == nullptr) {
-			currentGLTF._topNodes.push_back(node);
-			node->PropagateTransform(glm::mat4 { 1.F });
+	const bool bCacheHit = cookedView.has_value();
+	if (!bCacheHit) {
+		cacheFile.Close();
+		cookedScene = CookObj(sourceFile.Bytes(), path.stem().string(), engine->_threadPool, engine->_bOptimizeMeshes);
+		if (!cookedScene.has_value()) {
+			return std::nullopt;
 		}
+		cookedView = cookedScene->View();
+		WriteMeshCache(cachePath, sourceHash, engine->_bOptimizeMeshes, *cookedView);
 	}
+	sourceFile.Close();
+	const CookedSceneView&      scene = *cookedView;
+
+	std::shared_ptr<LoadedGLTF> currentGLTFPointer = std::make_shared<LoadedGLTF>();
+	currentGLTFPointer->_enginePtr = engine;
+	BuildLoadedScene(engine, *currentGLTFPointer, scene, nullptr);
+
+	const std::chrono::duration<float, std::milli> cookTime = std::chrono::steady_clock::now() - cookStart;
+	LOG(Engine, Info, "{} mesh data for {} in {:.2f} ms ({} vertices, {} indices, {} of them 16-bit)",
+	    bCacheHit ? "Mapped cached" : "Cooked",
+	    path.filename().string(),
+	    cookTime.count(),
+	    scene.vertices.size(),
+	    scene.indices16.size() + scene.indices32.size(),
+	    scene.indices16.size());
+
+	currentGLTFPointer->_uploadHandle = engine->_uploadBatcher.Submit();
 
 	return currentGLTFPointer;
 }
 
+// Picks the loader from the file extension, .obj goes to LoadObj and everything else is treated as glTF.
+std::optional<std::shared_ptr<LoadedGLTF>> LoadScene(PantomirEngine* engine, const std::string_view& filePath) {
+	std::string extension = std::filesystem::path(filePath).extension().string();
+	std::ranges::transform(extension, extension.begin(), [](const unsigned char character) { return static_cast<char>(std::tolower(character)); });
+	if (extension == ".obj") {
+		return LoadObj(engine, filePath);
+	}
+	return LoadGltf(engine, filePath);
+}
+
 void LoadedGLTF::FillDrawContext(const glm::mat4& topMatrix, DrawContext& drawContext) {
 	for (const std::shared_ptr<Node>& node : _topNodes) {
 		node->FillDrawContext(topMatrix, drawContext);
 	}
 }
 
+void LoadedGLTF::UpdateTextureStream() {
+	if (_textureStream == nullptr) {
+		return;
+	}
+
+	GLTFTextureStream&   stream = *_textureStream;
+	UploadBatcher&       uploadBatcher = _enginePtr->_uploadBatcher;
+	std::vector<uint8_t> bSettledThisFrame(stream.imageStates.size(), 0);
+	bool                 bAnySettled = false;
+
+	// Uploads the GPU has finished with can be sampled from now on
+	std::erase_if(stream.uploadingImages, [&](const std::pair<size_t, UploadHandle>& upload) {
+		if (!uploadBatcher.IsComplete(upload.second)) {
+			return false;
+		}
+		stream.imageStates[upload.first] = GLTFTextureStream::ImageState::Ready;
+		bSettledThisFrame[upload.first] = 1;
+		bAnySettled = true;
+		return true;
+	});
+
+	// Hand finished decodes to the upload batcher, within this frame's budget
+	std::vector<size_t> startedUploads;
+	size_t              uploadedBytes = 0;
+	for (size_t uniqueIndex = 0; uniqueIndex < stream.decodedTextures.size() && uploadedBytes < TEXTURE_STREAM_UPLOAD_BUDGET; ++uniqueIndex) {
+		std::future<std::optional<MipmappedTexture>>& decodedTexture = stream.decodedTextures[uniqueIndex];
+		if (!decodedTexture.valid() || decodedTexture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			continue;
+		}
+
+		const std::optional<MipmappedTexture> texture = decodedTexture.get();
+		if (!texture.has_value()) {
+			// Keeps the error texture, which the material picks up like any other settled image
+			stream.imageStates[uniqueIndex] = GLTFTextureStream::ImageState::Failed;
+			bSettledThisFrame[uniqueIndex] = 1;
+			bAnySettled = true;
+			continue;
+		}
+
+		// Staging copies happen in CreateImage, the cache mapping and encoded bytes can go right after
+		const AllocatedImage image = _enginePtr->CreateImage(*texture, VK_IMAGE_USAGE_SAMPLED_BIT);
+		uploadedBytes += texture->pixels.size();
+		for (size_t imageIndex = 0; imageIndex < _imagesByIndex.size(); ++imageIndex) {
+			if (stream.uniqueImageIndexByImage[imageIndex] == uniqueIndex) {
+				_imagesByIndex[imageIndex] = image;
+				stream.encodedImages[imageIndex].reset();
+			}
+		}
+		stream.imageStates[uniqueIndex] = GLTFTextureStream::ImageState::Uploading;
+		startedUploads.push_back(uniqueIndex);
+	}
+
+	if (!startedUploads.empty()) {
+		_textureUploadHandle = uploadBatcher.Submit();
+		for (const size_t uniqueIndex : startedUploads) {
+			stream.uploadingImages.emplace_back(uniqueIndex, _textureUploadHandle);
+		}
+	}
+
+	if (bAnySettled) {
+		// Recorded frames may still read the affected entries, which is fine since they only swap in uploaded textures
+		const fastgltf::Asset& asset = *stream.asset;
+		for (const GLTFMaterialBinding& binding : stream.materials) {
+			const bool bAffected = std::ranges::any_of(binding.textureIndices, [&](const int32_t texIndex) {
+				return texIndex >= 0 && std::ranges::any_of(GetTextureImageCandidates(asset.textures[texIndex]), [&](const std::optional<size_t>& imageIndex) {
+					return imageIndex.has_value() && stream.uniqueImageIndexByImage[*imageIndex] != NO_UNIQUE_IMAGE && bSettledThisFrame[stream.uniqueImageIndexByImage[*imageIndex]];
+				});
+			});
+			if (bAffected) {
+				binding.material->data = WriteGltfMaterial(_enginePtr, *this, &stream, &asset, binding);
+			}
+		}
+	}
+
+	const bool bStreamComplete = std::ranges::all_of(stream.imageStates, [](const GLTFTextureStream::ImageState state) {
+		return state == GLTFTextureStream::ImageState::Ready || state == GLTFTextureStream::ImageState::Failed;
+	});
+	if (bStreamComplete) {
+		const std::chrono::duration<float, std::milli> streamTime = std::chrono::steady_clock::now() - stream.startTime;
+		LOG(Engine, Info, "Streamed {} unique images in {:.2f} ms ({} failed)", stream.imageStates.size(), streamTime.count(), std::ranges::count(stream.imageStates, GLTFTextureStream::ImageState::Failed));
+		_textureStream.reset();
+	}
+}
+
 void LoadedGLTF::ClearAll() {
 	const VkDevice device = _enginePtr->_logicalGPU;
 
-	_descriptorPool.DestroyPools(device);
-	_enginePtr->DestroyBuffer(_materialDataBuffer);
+	// The batch may still be copying into these resources
+	_enginePtr->_uploadBatcher.Wait(_uploadHandle);
+	_enginePtr->_uploadBatcher.Wait(_textureUploadHandle);
 
-	for (const std::shared_ptr<MeshAsset>& value : _meshes | std::views::values) {
-		_enginePtr->DestroyBuffer(value->meshBuffers.indexBuffer);
-		_enginePtr->DestroyBuffer(value->meshBuffers.vertexBuffer);
+	// Releases their bindless texture slots too, before the images behind them go
+	for (const uint32_t materialIndex : _materialIndices) {
+		_enginePtr->_metalRoughMaterial.FreeMaterial(materialIndex);
 	}
 
+	_enginePtr->DestroyBuffer(_meshBuffers.indexBuffer);
+	_enginePtr->DestroyBuffer(_meshBuffers.vertexBuffer);
+	_enginePtr->DestroyBuffer(_meshletBuffer);
+
+	// Deduplicated images appear in several slots, destroy each one once
+	std::unordered_set<VkImage> destroyedImages;
 	for (AllocatedImage& value : _imagesByIndex) {
 		if (value.image == _enginePtr->_errorCheckerboardImage.image) {
 			// Dont destroy the default images
 			continue;
 		}
-		_enginePtr->DestroyImage(value);
+		if (destroyedImages.insert(value.image).second) {
+			_enginePtr->DestroyImage(value);
+		}
 	}
 
 	for (const VkSampler& sampler : _samplers) {
@@ -582,7 +988,7 @@ void LoadedGLTF::ClearAll() {
 
 /*
     // Load HDRI using STBI
-    // Then allocate it on the GPU
+    // Then resample it into an E5B9G9R9 cubemap with mips and allocate it on the GPU
  */
 std::optional<std::shared_ptr<LoadedHDRI>> LoadHDRI(PantomirEngine* engine, const std::string_view& filePath) {
 	LOG(Engine, Info, "Loading HDRI: {}", filePath);
@@ -592,7 +998,7 @@ std::optional<std::shared_ptr<LoadedHDRI>> LoadHDRI(PantomirEngine* engine, cons
 	int                         width = 0;
 	int                         height = 0;
 	int                         channelCount = 0;
-	constexpr int               desiredChannelCount = 4;
+	constexpr int               desiredChannelCount = 3; // E5B9G9R9 has no alpha
 	stbi_set_flip_vertically_on_load(true);
 	float* imageData = stbi_loadf(filePath.data(), &width, &height, &channelCount, desiredChannelCount); // HDR's have float format
 	stbi_set_flip_vertically_on_load(false);
@@ -611,7 +1017,7 @@ std::optional<std::shared_ptr<LoadedHDRI>> LoadHDRI(PantomirEngine* engine, cons
 		.magFilter = VK_FILTER_LINEAR,
 		.minFilter = VK_FILTER_LINEAR,
 		.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
-		.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, // Cube lookups filter across face edges regardless
 		.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
 		.minLod = 0,
 		.maxLod = VK_LOD_CLAMP_NONE,
@@ -621,22 +1027,30 @@ std::optional<std::shared_ptr<LoadedHDRI>> LoadHDRI(PantomirEngine* engine, cons
 	vkCreateSampler(engine->_logicalGPU, &samplerCreateInfo, nullptr, &newSampler);
 	loadedHDRI->_sampler = newSampler;
 
-	// Step 2: Load data to a staging buffer, then create image and views on the device
+	// Step 2: Build the packed cubemap, then create image and views on the device
 	VkExtent3D imageExtent;
 	imageExtent.width = static_cast<uint32_t>(width);
 	imageExtent.height = static_cast<uint32_t>(height);
 	imageExtent.depth = 1; // Only going to be 1, we aren't making smokes or CT/MRI scans.
 
-	loadedHDRI->_allocatedImage = engine->CreateImage(imageData, imageExtent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_USAGE_SAMPLED_BIT, false);
-
+	const std::chrono::time_point<std::chrono::steady_clock> convertStart = std::chrono::steady_clock::now();
+	const MipmappedTexture                                   texture = BuildHDRCubemap(imageData, imageExtent, engine->_threadPool);
+	const std::chrono::duration<float, std::milli>           convertTime = std::chrono::steady_clock::now() - convertStart;
 	stbi_image_free(imageData);
 
+	loadedHDRI->_allocatedImage = engine->CreateImage(texture, VK_IMAGE_USAGE_SAMPLED_BIT);
+	LOG(Engine, Info, "HDRI resampled into a {}x{} cubemap ({:.2f} MB with {} mips) in {:.2f} ms", texture.extent.width, texture.extent.height, static_cast<double>(texture.pixels.size()) / (1024.0 * 1024.0), texture.mipRegions.size(), convertTime.count());
+
+	loadedHDRI->_uploadHandle = engine->_uploadBatcher.Submit();
+
 	return loadedHDRI;
 }
 
 void LoadedHDRI::ClearAll() {
 	const VkDevice device = _enginePtr->_logicalGPU;
 
+	_enginePtr->_uploadBatcher.Wait(_uploadHandle);
+
 	_enginePtr->DestroyImage(_allocatedImage);
 	vkDestroySampler(device, _sampler, nullptr);
 }
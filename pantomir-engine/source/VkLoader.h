@@ -3,6 +3,7 @@
 
 #include "VkDescriptors.h"
 #include "VkTypes.h"
+#include "VkUploadBatcher.h"
 #include <filesystem>
 #include <unordered_map>
 
@@ -11,6 +12,18 @@ namespace fastgltf {
 	class Asset;
 } // namespace fastgltf
 
+// Encoded (PNG, JPEG, ...) bytes of a glTF image, viewed in place in the asset's buffers or mapped image files.
+struct EncodedImage {
+	std::span<const std::byte> bytes;
+};
+
+// CPU-side result of decoding a glTF image. Produced on worker threads, uploaded on the main thread.
+struct DecodedImage {
+	std::vector<uint8_t> pixels;
+	VkExtent3D           extent {};
+	VkFormat             format = VK_FORMAT_UNDEFINED;
+};
+
 struct GLTFMaterial {
 	MaterialInstance data;
 };
@@ -21,31 +34,63 @@ struct Bounds {
 	glm::vec3 extents;
 };
 
+// Simplified index range of a surface, drawn with the surface's own vertices. Level 0 is the surface itself.
+struct SurfaceLOD {
+	uint32_t startIndex; // Into the scene-wide index buffer once loaded, relative to the owning mesh while cooked
+	uint32_t count;
+	float    error;      // How far it strays from the full-detail surface, relative to the surface's largest extent
+};
+
+constexpr uint32_t MAX_SURFACE_LODS = 4; // Simplified levels per surface, each roughly half the triangles of the one before
+
 struct GeoSurface {
-	uint32_t                      startIndex;
+	uint32_t                      startIndex;   // Into the scene-wide indices of the owning MeshAsset's indexType
 	uint32_t                      count;
+	int32_t                       vertexOffset; // Indices are mesh-local, this is where the mesh starts in the scene-wide vertex buffer
 	Bounds                        bounds;
 	std::shared_ptr<GLTFMaterial> material;
+	uint32_t                      firstMeshlet; // Into the owning LoadedGLTF's meshlets, which tile [startIndex, startIndex + count)
+	uint32_t                      meshletCount;
+	uint32_t                      firstLOD;     // Into the owning MeshAsset's lods, levels 1 to lodCount in order
+	uint32_t                      lodCount;
 };
 
 struct RenderObject {
-	uint32_t          indexCount;
-	uint32_t          firstIndex;
-	VkBuffer          indexBuffer;
-
-	MaterialInstance* material;
-	Bounds            bounds;
-	glm::mat4         transform;
-	VkDeviceAddress   vertexBufferAddress;
+	uint32_t                    indexCount;
+	uint32_t                    firstIndex;
+	int32_t                     vertexOffset;
+	VkBuffer                    indexBuffer;
+	VkDeviceSize                indexBufferOffset; // Where the indices of indexType start, firstIndex counts from here
+	VkIndexType                 indexType;
+
+	MaterialInstance*           material;
+	Bounds                      bounds;
+	glm::mat4                   transform;
+	VkDeviceAddress             vertexBufferAddress;
+	glm::vec3                   positionOffset; // Dequantizes the mesh's packed positions
+	glm::vec3                   positionScale;
+
+	std::span<const Meshlet>    meshlets;             // Empty when the surface can't be cluster culled
+	uint32_t                    firstMeshlet;         // Index of meshlets[0] in the buffer at meshletBufferAddress
+	VkDeviceAddress             meshletBufferAddress;
+
+	std::span<const SurfaceLOD> lods; // Levels 1 and up, SelectSurfaceLOD swaps one in for the range above
 };
 
 struct MeshAsset {
-	std::string             name;
-	std::vector<GeoSurface> surfaces;
-	GPUMeshBuffers          meshBuffers;
+	std::string              name;
+	std::vector<GeoSurface>  surfaces;
+	GPUMeshBuffers           meshBuffers;                      // Not owned, every mesh of a LoadedGLTF shares its scene-wide buffers
+	VkIndexType              indexType = VK_INDEX_TYPE_UINT32; // 16-bit whenever the mesh has few enough vertices
+	glm::vec3                positionOffset { 0.F };
+	glm::vec3                positionScale { 1.F };
+	std::span<const Meshlet> meshlets;                 // Not owned, every meshlet of the LoadedGLTF, GeoSurfaces index into it
+	VkDeviceAddress          meshletBufferAddress = 0; // GPU copy of meshlets, for the compute culling pass
+	std::vector<SurfaceLOD>  lods;                     // Rebased onto meshBuffers, GeoSurfaces index into it
 };
 
 class PantomirEngine;
+struct GLTFTextureStream;
 
 struct LoadedGLTF final : IRenderable {
 	// Storage for all the data on a given glTF file
@@ -58,8 +103,14 @@ struct LoadedGLTF final : IRenderable {
 	// Nodes that don't have a parent, for iterating through the file in tree order
 	std::vector<std::shared_ptr<Node>>                             _topNodes;
 	std::vector<VkSampler>                                         _samplers;
-	DescriptorPoolManager                                          _descriptorPool;
-	AllocatedBuffer                                                _materialDataBuffer;
+	std::vector<uint32_t>                                          _materialIndices; // Entries of the engine's material buffer this file owns
+	GPUMeshBuffers                                                 _meshBuffers {}; // One vertex and one index allocation for the whole file
+	std::vector<Meshlet>                                           _meshlets;       // Rebased onto _meshBuffers, read by CPU cluster culling
+	AllocatedBuffer                                                _meshletBuffer {};
+	VkDeviceAddress                                                _meshletBufferAddress = 0;
+	UploadHandle                                                   _uploadHandle;        // Buffers and images are usable once this completes
+	std::shared_ptr<GLTFTextureStream>                             _textureStream;       // Textures still decoding or uploading, null once all have arrived
+	UploadHandle                                                   _textureUploadHandle; // Latest batch of streamed textures
 	PantomirEngine*                                                _enginePtr;
 
 	~LoadedGLTF() override {
@@ -68,6 +119,10 @@ struct LoadedGLTF final : IRenderable {
 
 	void FillDrawContext(const glm::mat4& topMatrix, DrawContext& drawContext) override;
 
+	// Uploads textures that finished decoding and rebinds the materials sampling the ones whose upload completed.
+	// Main thread, once per frame. Does nothing once every texture has arrived.
+	void UpdateTextureStream();
+
 private:
 	void ClearAll();
 };
@@ -75,6 +130,7 @@ private:
 struct LoadedHDRI {
 	AllocatedImage  _allocatedImage;
 	VkSampler       _sampler;
+	UploadHandle    _uploadHandle;
 	PantomirEngine* _enginePtr;
 
 	~LoadedHDRI() {
@@ -86,8 +142,12 @@ private:
 };
 
 // Free functions
+std::optional<EncodedImage>                ReadEncodedImage(const fastgltf::Asset& asset, const fastgltf::Image& image);
+std::optional<DecodedImage>                DecodeImage(const EncodedImage& encodedImage);
 std::optional<AllocatedImage>              LoadImage(PantomirEngine* engine, fastgltf::Asset& asset, fastgltf::Image& image);
 std::optional<std::shared_ptr<LoadedGLTF>> LoadGltf(PantomirEngine* engine, const std::string_view& filePath);
+std::optional<std::shared_ptr<LoadedGLTF>> LoadObj(PantomirEngine* engine, const std::string_view& filePath);
+std::optional<std::shared_ptr<LoadedGLTF>> LoadScene(PantomirEngine* engine, const std::string_view& filePath);
 std::optional<std::shared_ptr<LoadedHDRI>> LoadHDRI(PantomirEngine* engine, const std::string_view& filePath);
 
 #endif /*! VKLOADER_H_ */
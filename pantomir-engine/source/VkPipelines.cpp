@@ -5,7 +5,7 @@
 
 #include <fstream>
 
-VkPipeline PipelineBuilder::BuildPipeline(VkDevice device) {
+VkPipeline PipelineBuilder::BuildPipeline(VkDevice device, VkPipelineCache pipelineCache) {
 	// Make viewport state from our stored viewport and scissor.
 	// at the moment we won't support multiple viewports or scissors
 	VkPipelineViewportStateCreateInfo viewportState = {};
@@ -31,7 +31,12 @@ VkPipeline PipelineBuilder::BuildPipeline(VkDevice device) {
 	// We know use all of the info structs we have been writing into, into this one to create the pipeline
 	VkGraphicsPipelineCreateInfo         pipelineInfo = { .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
 	// Connect the renderInfo to the pNext extension mechanism
-	pipelineInfo.pNext = &_renderInfo;
+	// Point at our own format, a copied builder would still point at the one it was copied from
+	VkPipelineRenderingCreateInfo renderInfo = _renderInfo;
+	if (renderInfo.colorAttachmentCount > 0) {
+		renderInfo.pColorAttachmentFormats = &_colorAttachmentFormat;
+	}
+	pipelineInfo.pNext = &renderInfo;
 
 	pipelineInfo.stageCount = static_cast<uint32_t>(_shaderStages.size());
 	pipelineInfo.pStages = _shaderStages.data();
@@ -44,17 +49,15 @@ VkPipeline PipelineBuilder::BuildPipeline(VkDevice device) {
 	pipelineInfo.pDepthStencilState = &_depthStencil;
 	pipelineInfo.layout = _pipelineLayout;
 
-	VkDynamicState                   state[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
-
 	VkPipelineDynamicStateCreateInfo dynamicInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
-	dynamicInfo.pDynamicStates = &state[0];
-	dynamicInfo.dynamicStateCount = 2;
+	dynamicInfo.pDynamicStates = _dynamicStates.data();
+	dynamicInfo.dynamicStateCount = static_cast<uint32_t>(_dynamicStates.size());
 	pipelineInfo.pDynamicState = &dynamicInfo;
 
 	// It's easy to error out on create graphics pipeline, so we handle it a bit
 	// Better than the common VK_CHECK case
 	VkPipeline newPipeline;
-	if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &newPipeline) != VK_SUCCESS) {
+	if (vkCreateGraphicsPipelines(device, pipelineCache, 1, &pipelineInfo, nullptr, &newPipeline) != VK_SUCCESS) {
 		LOG(Engine_Renderer, Error, "Failed to create pipeline.");
 		return VK_NULL_HANDLE;
 	} else {
@@ -84,6 +87,10 @@ void PipelineBuilder::SetCullMode(const VkCullModeFlags cullMode, const VkFrontF
 	_rasterizer.frontFace = frontFace;
 }
 
+void PipelineBuilder::AddDynamicState(const VkDynamicState state) {
+	_dynamicStates.push_back(state);
+}
+
 void PipelineBuilder::SetMultisamplingNone() {
 	_multisampling.sampleShadingEnable = VK_FALSE;
 	// Multisampling defaulted to no multisampling (1 sample per pixel)
@@ -146,6 +153,7 @@ void PipelineBuilder::Clear() {
 	_depthStencil = { .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO };
 	_renderInfo = { .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO };
 	_shaderStages.clear();
+	_dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 }
 
 void PipelineBuilder::EnableBlendingAdditive() {
@@ -170,6 +178,71 @@ void PipelineBuilder::EnableBlendingAlphablend() {
 	_colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 }
 
+PipelineBuildTimer::PipelineBuildTimer(const bool bWarmCache)
+    : _start(std::chrono::steady_clock::now())
+    , _bWarmCache(bWarmCache) {
+}
+
+void PipelineBuildTimer::Add() {
+	_pendingBuilds.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PipelineBuildTimer::Finish() {
+	if (_pendingBuilds.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		const std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - _start;
+		LOG(Engine, Info, "Built pipelines in {:.2f} ms ({} pipeline cache)", elapsed.count(), _bWarmCache ? "warm" : "cold");
+	}
+}
+
+void PipelineBuildTimer::Seal() {
+	Finish();
+}
+
+void PipelineBuildGroup::Build(Pantomir::ThreadPool& threadPool, const VkDevice device, const VkPipelineCache pipelineCache, const PipelineBuilder& builder, VkPipeline* out_pipeline) {
+	if (_timer) {
+		_timer->Add();
+	}
+	_builds.push_back(threadPool.Submit([builder, device, pipelineCache, out_pipeline, timer = _timer]() mutable {
+		*out_pipeline = builder.BuildPipeline(device, pipelineCache);
+		if (timer) {
+			timer->Finish();
+		}
+	}));
+}
+
+void PipelineBuildGroup::BuildCompute(Pantomir::ThreadPool& threadPool, const VkDevice device, const VkPipelineCache pipelineCache, const VkComputePipelineCreateInfo& createInfo, VkPipeline* out_pipeline) {
+	if (_timer) {
+		_timer->Add();
+	}
+	_builds.push_back(threadPool.Submit([createInfo, device, pipelineCache, out_pipeline, timer = _timer]() {
+		VK_CHECK(vkCreateComputePipelines(device, pipelineCache, 1, &createInfo, nullptr, out_pipeline));
+		if (timer) {
+			timer->Finish();
+		}
+	}));
+}
+
+void PipelineBuildGroup::AddShaderModule(const VkShaderModule shaderModule) {
+	_shaderModules.push_back(shaderModule);
+}
+
+void PipelineBuildGroup::SetTimer(std::shared_ptr<PipelineBuildTimer> timer) {
+	_timer = std::move(timer);
+}
+
+void PipelineBuildGroup::Wait(const VkDevice device) {
+	for (std::future<void>& build : _builds) {
+		build.get();
+	}
+	_builds.clear();
+	_timer.reset();
+
+	for (const VkShaderModule shaderModule : _shaderModules) {
+		vkDestroyShaderModule(device, shaderModule, nullptr);
+	}
+	_shaderModules.clear();
+}
+
 bool vkutil::LoadShaderModule(const char* filePath, const VkDevice device, VkShaderModule* outShaderModule) {
 	std::ifstream file(filePath, std::ios::ate | std::ios::binary); // Open file with cursor at the end.
 
@@ -1,8 +1,14 @@
 #ifndef VKPIPELINES_H_
 #define VKPIPELINES_H_
 
+#include "ThreadPool.h"
 #include "VkTypes.h"
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+
 class PipelineBuilder {
 public:
 	std::vector<VkPipelineShaderStageCreateInfo> _shaderStages;
@@ -15,16 +21,18 @@ public:
 	VkPipelineDepthStencilStateCreateInfo        _depthStencil;
 	VkPipelineRenderingCreateInfo                _renderInfo;
 	VkFormat                                     _colorAttachmentFormat;
+	std::vector<VkDynamicState>                  _dynamicStates; // Viewport and scissor are always dynamic
 
 	PipelineBuilder() {
 		Clear();
 	}
 	void       Clear();
-	VkPipeline BuildPipeline(VkDevice device);
+	VkPipeline BuildPipeline(VkDevice device, VkPipelineCache pipelineCache);
 	void       SetShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader);
 	void       SetInputTopology(VkPrimitiveTopology topology);
 	void       SetPolygonMode(VkPolygonMode mode);
 	void       SetCullMode(VkCullModeFlags cullMode, VkFrontFace frontFace);
+	void       AddDynamicState(VkDynamicState state);
 	void       SetMultisamplingNone();
 	void       DisableBlending();
 	void       EnableBlendingAdditive();
@@ -35,6 +43,43 @@ public:
 	void       DisableDepthtest();
 };
 
+// Logs how long a set of pipeline builds, possibly spread over several groups, took until the last one finished. One
+// build is held open until Seal, so an early build finishing while later ones are still being queued isn't the last.
+class PipelineBuildTimer {
+public:
+	explicit PipelineBuildTimer(bool bWarmCache);
+	void Add();
+	// Any thread, once a build has finished
+	void Finish();
+	// Main thread, once every build has been queued
+	void Seal();
+
+private:
+	std::atomic<uint32_t>                              _pendingBuilds = 1;
+	std::chrono::time_point<std::chrono::steady_clock> _start;
+	bool                                               _bWarmCache;
+};
+
+// Pipelines compiled on the thread pool. Each build writes its handle once the driver is done, which is only safe
+// to read after Wait. Wait blocks on just this group, so a pass waits for its own pipelines and not everyone else's.
+class PipelineBuildGroup {
+public:
+	// The builder is copied, the caller may change or drop it right away
+	void Build(Pantomir::ThreadPool& threadPool, VkDevice device, VkPipelineCache pipelineCache, const PipelineBuilder& builder, VkPipeline* out_pipeline);
+	void BuildCompute(Pantomir::ThreadPool& threadPool, VkDevice device, VkPipelineCache pipelineCache, const VkComputePipelineCreateInfo& createInfo, VkPipeline* out_pipeline);
+	// Destroyed once every build of the group has finished with it
+	void AddShaderModule(VkShaderModule shaderModule);
+	// Builds queued from here on report to the timer, until Wait
+	void SetTimer(std::shared_ptr<PipelineBuildTimer> timer);
+	// Main thread. Returns right away once the group has been waited on.
+	void Wait(VkDevice device);
+
+private:
+	std::vector<std::future<void>>      _builds;
+	std::vector<VkShaderModule>         _shaderModules;
+	std::shared_ptr<PipelineBuildTimer> _timer;
+};
+
 namespace vkutil {
 	bool LoadShaderModule(const char*     filePath,
 	                      VkDevice        device,
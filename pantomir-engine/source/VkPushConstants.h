@@ -17,10 +17,41 @@ struct ComputeEffect {
 	ComputePushConstants pushConstants;
 };
 
-// Push constants for our mesh object draws
+// Push constants for our mesh object draws. Vec4s keep the C++ offsets equal to std430 without explicit alignment.
 struct GPUDrawPushConstants {
 	glm::mat4       worldSpaceTransform;
+	glm::vec4       positionOffset; // xyz, object space position of a packed 0
+	glm::vec4       positionScale;  // xyz, object space extent of a packed 1
 	VkDeviceAddress vertexBufferAddress;
+	uint32_t        materialIndex;  // Into the global material buffer
+};
+
+// Push constants for meshlet_cull.comp. The frustum planes are extracted from viewProjection in the shader.
+struct ClusterCullPushConstants {
+	glm::mat4       viewProjection;
+	glm::vec4       cameraPosition; // xyz
+	VkDeviceAddress cullObjectBufferAddress;
+	VkDeviceAddress drawCommandBufferAddress;
+	VkDeviceAddress drawCountBufferAddress;
+	uint32_t        cullObjectCount;
+	uint32_t        meshletCount;   // Sum over the cull objects, one invocation each
+};
+
+// Push constants for mesh_indirect.vert, everything else about a draw is in its GPUDrawObject
+struct GPUDrawIndirectPushConstants {
+	VkDeviceAddress drawObjectBufferAddress;
+};
+
+// Push constants for object_cull.comp. The frustum planes are extracted from viewProjection in the shader.
+struct ObjectCullPushConstants {
+	glm::mat4       viewProjection;
+	glm::vec4       cameraPosition; // xyz
+	VkDeviceAddress drawObjectBufferAddress;
+	VkDeviceAddress drawCommandBufferAddress;
+	VkDeviceAddress drawCountBufferAddress;
+	uint32_t        drawObjectCount;
+	float           projectionScale; // As in SelectSurfaceLOD
+	float           lodScreenSizeThreshold;
 };
 
 struct HDRIPushConstants {
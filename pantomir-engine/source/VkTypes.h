@@ -27,16 +27,18 @@ enum class MaterialPass : uint8_t {
 
 struct MaterialPipeline {
 	VkPipeline       pipeline;
+	VkPipeline       indirectPipeline; // Same state, draws read their GPUDrawObject at gl_InstanceIndex. Null if the pass has none.
 	VkPipelineLayout layout;
 };
 
 struct MaterialInstance {
 	MaterialPipeline*  pipeline;
-	VkDescriptorSet    descriptorSet;
+	uint32_t           materialIndex; // Into the global material buffer, pushed with every draw
 	MaterialPass       passType;
 	VkCullModeFlagBits cullMode;
 };
 
+// Full precision vertex, used while cooking. The GPU only ever sees PackedVertex.
 struct Vertex {
 	glm::vec3 position;
 	float     uv_x;
@@ -46,6 +48,35 @@ struct Vertex {
 	glm::vec4 color;
 };
 
+// 24 bytes instead of 64, decoded in mesh.vert. Positions are unorm16 inside the mesh's bounding box, which the draw
+// passes as an offset and scale. Normal and tangent directions are octahedral snorm16, UVs half floats, color unorm8.
+struct PackedVertex {
+	uint32_t positionXY;
+	uint32_t positionZ;  // Low half z, high half the tangent handedness (0 for -1, 0xFFFF for +1)
+	uint32_t normal;
+	uint32_t tangent;
+	uint32_t uv;
+	uint32_t color;
+};
+
+static_assert(sizeof(PackedVertex) == 24, "PackedVertex must match the std430 layout in mesh.vert");
+
+// Up to MESHLET_MAX_TRIANGLES consecutive triangles of one surface, touching at most MESHLET_MAX_VERTICES vertices.
+// The renderer culls these individually, against the frustum with the sphere and against the view direction with
+// the normal cone. Bounds are in object space.
+struct Meshlet {
+	glm::vec3 center;
+	float     radius;
+	glm::vec3 coneAxis;     // Average facing direction of the triangles
+	float     coneCutoff;   // Sine of the cone's spread, 1 when the triangles face too many ways to ever cull
+	uint32_t  firstIndex;   // Into the scene-wide index buffer once loaded, relative to the owning mesh while cooked
+	uint32_t  indexCount;
+	int32_t   vertexOffset; // Same as the owning GeoSurface
+	uint32_t  PADDING_0;
+};
+
+static_assert(sizeof(Meshlet) == 48, "Meshlet must match the std430 layout in meshlet_cull.comp");
+
 struct AllocatedBuffer {
 	VkBuffer          buffer;
 	VmaAllocation     allocation;
@@ -54,7 +85,8 @@ struct AllocatedBuffer {
 
 // Holds the resources needed for a mesh
 struct GPUMeshBuffers {
-	AllocatedBuffer indexBuffer;
+	AllocatedBuffer indexBuffer; // 16-bit indices first, then the 32-bit ones
+	VkDeviceSize    index32Offset;
 	AllocatedBuffer vertexBuffer;
 	VkDeviceAddress vertexBufferAddress;
 };
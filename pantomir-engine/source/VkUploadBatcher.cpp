@@ -0,0 +1,412 @@
+#include "VkUploadBatcher.h"
+
+#include "PantomirEngine.h"
+#include "VkImages.h"
+#include "VkInitializers.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	// Satisfies buffer copies and the texel-block alignment of every format we upload.
+	constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+	constexpr uint64_t     AlignUp(const uint64_t value, const uint64_t alignment) {
+		return ((value + alignment - 1) / alignment) * alignment;
+	}
+
+	VkSemaphore CreateTimelineSemaphore(const VkDevice device) {
+		VkSemaphoreTypeCreateInfo timelineCreateInfo { .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+		timelineCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+		timelineCreateInfo.initialValue = 0;
+
+		VkSemaphoreCreateInfo semaphoreCreateInfo = vkinit::SemaphoreCreateInfo();
+		semaphoreCreateInfo.pNext = &timelineCreateInfo;
+
+		VkSemaphore semaphore;
+		VK_CHECK(vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &semaphore));
+		return semaphore;
+	}
+
+	// Make every transfer write of a batch visible to whatever reads the resources afterwards.
+	void RecordTransferWriteBarrier(const VkCommandBuffer commandBuffer) {
+		VkMemoryBarrier2 memoryBarrier { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+		memoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+		memoryBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		memoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+
+		VkDependencyInfo dependencyInfo { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		dependencyInfo.memoryBarrierCount = 1;
+		dependencyInfo.pMemoryBarriers = &memoryBarrier;
+		vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+
+	void SubmitCommandBuffer(const VkQueue queue, const VkCommandBuffer commandBuffer, VkSemaphoreSubmitInfo* signalInfo, VkSemaphoreSubmitInfo* waitInfo) {
+		VkCommandBufferSubmitInfo commandInfo = vkinit::CommandBufferSubmitInfo(commandBuffer);
+		const VkSubmitInfo2       submit = vkinit::SubmitInfo(&commandInfo, signalInfo, waitInfo);
+		VK_CHECK(vkQueueSubmit2(queue, 1, &submit, VK_NULL_HANDLE));
+	}
+} // namespace
+
+void UploadBatcher::Init(PantomirEngine* engine, const VkDeviceSize stagingCapacity) {
+	_enginePtr = engine;
+	_stagingCapacity = AlignUp(stagingCapacity, STAGING_ALIGNMENT);
+	_stagingRing = engine->CreateBuffer(_stagingCapacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+
+	const VkDevice                device = engine->_logicalGPU;
+	const VkCommandPoolCreateInfo transferPoolInfo = vkinit::CommandPoolCreateInfo(engine->_transferQueueFamilyIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+	VK_CHECK(vkCreateCommandPool(device, &transferPoolInfo, nullptr, &_transferCommandPool));
+	if (UsesOwnershipTransfer()) {
+		const VkCommandPoolCreateInfo graphicsPoolInfo = vkinit::CommandPoolCreateInfo(engine->_graphicsQueueFamilyIndex, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+		VK_CHECK(vkCreateCommandPool(device, &graphicsPoolInfo, nullptr, &_graphicsCommandPool));
+	}
+
+	_transferTimeline = CreateTimelineSemaphore(device);
+	_uploadTimeline = CreateTimelineSemaphore(device);
+}
+
+void UploadBatcher::Destroy() {
+	Flush();
+
+	const VkDevice device = _enginePtr->_logicalGPU;
+	_freeBatches.clear();
+
+	// Destroying the pools frees every command buffer allocated from them
+	vkDestroyCommandPool(device, _transferCommandPool, nullptr);
+	if (_graphicsCommandPool != VK_NULL_HANDLE) {
+		vkDestroyCommandPool(device, _graphicsCommandPool, nullptr);
+	}
+	vkDestroySemaphore(device, _transferTimeline, nullptr);
+	vkDestroySemaphore(device, _uploadTimeline, nullptr);
+	_enginePtr->DestroyBuffer(_stagingRing);
+}
+
+void UploadBatcher::EnqueueBufferUpload(const VkBuffer destination, const void* data, const VkDeviceSize size, const VkDeviceSize destinationOffset) {
+	if (size == 0) {
+		return;
+	}
+
+	// Allocate before grabbing the command buffer, a full ring may submit the batch being recorded.
+	const StagingAllocation staging = AllocateStaging(size);
+	memcpy(staging.mappedData, data, size);
+
+	const VkCommandBuffer commandBuffer = GetRecordingCommandBuffer();
+
+	VkBufferCopy          copyRegion {};
+	copyRegion.srcOffset = staging.offset;
+	copyRegion.dstOffset = destinationOffset;
+	copyRegion.size = size;
+	vkCmdCopyBuffer(commandBuffer, staging.buffer, destination, 1, &copyRegion);
+
+	if (UsesOwnershipTransfer()) {
+		VkBufferMemoryBarrier2 release { .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
+		release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+		release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		release.srcQueueFamilyIndex = _enginePtr->_transferQueueFamilyIndex;
+		release.dstQueueFamilyIndex = _enginePtr->_graphicsQueueFamilyIndex;
+		release.buffer = destination;
+		release.offset = destinationOffset;
+		release.size = size;
+		_recordingBatch.bufferReleases.push_back(release);
+	}
+}
+
+void UploadBatcher::EnqueueImageUpload(const AllocatedImage& destination, const void* data, const VkDeviceSize size, const bool mipmapped) {
+	const StagingAllocation staging = AllocateStaging(size);
+	memcpy(staging.mappedData, data, size);
+
+	const VkCommandBuffer commandBuffer = GetRecordingCommandBuffer();
+
+	VkBufferImageCopy     copyRegion = {};
+	copyRegion.bufferOffset = staging.offset;
+	copyRegion.bufferRowLength = destination.imageExtent.width;
+	copyRegion.bufferImageHeight = destination.imageExtent.height;
+
+	copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	copyRegion.imageSubresource.mipLevel = 0;
+	copyRegion.imageSubresource.baseArrayLayer = 0;
+	copyRegion.imageSubresource.layerCount = 1;
+	copyRegion.imageExtent = destination.imageExtent;
+
+	vkutil::TransitionImage(commandBuffer, destination.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	vkCmdCopyBufferToImage(commandBuffer, staging.buffer, destination.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+	const VkExtent2D extent { destination.imageExtent.width, destination.imageExtent.height };
+	if (!UsesOwnershipTransfer()) {
+		mipmapped ? vkutil::GenerateMipmaps(commandBuffer, destination.image, extent)
+		          : vkutil::TransitionImage(commandBuffer, destination.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		return;
+	}
+
+	// Mipmapped images stay in TRANSFER_DST, the graphics queue blits the chain after acquiring them.
+	VkImageMemoryBarrier2 release { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+	release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+	release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	release.newLayout = mipmapped ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	release.srcQueueFamilyIndex = _enginePtr->_transferQueueFamilyIndex;
+	release.dstQueueFamilyIndex = _enginePtr->_graphicsQueueFamilyIndex;
+	release.image = destination.image;
+	release.subresourceRange = vkinit::ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT);
+	_recordingBatch.imageReleases.push_back(release);
+
+	if (mipmapped) {
+		_recordingBatch.mipmapRequests.push_back(MipmapRequest { destination.image, extent });
+	}
+}
+
+void UploadBatcher::EnqueueImageUpload(const AllocatedImage& destination, const std::span<const std::byte> data, const std::span<const VkBufferImageCopy> mipRegions) {
+	const StagingAllocation staging = AllocateStaging(data.size());
+	memcpy(staging.mappedData, data.data(), data.size());
+
+	const VkCommandBuffer commandBuffer = GetRecordingCommandBuffer();
+
+	// Every level is already in the staging memory, one copy command fills the whole chain.
+	std::vector<VkBufferImageCopy> copyRegions(mipRegions.begin(), mipRegions.end());
+	for (VkBufferImageCopy& copyRegion : copyRegions) {
+		copyRegion.bufferOffset += staging.offset;
+	}
+
+	vkutil::TransitionImage(commandBuffer, destination.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	vkCmdCopyBufferToImage(commandBuffer, staging.buffer, destination.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
+
+	if (!UsesOwnershipTransfer()) {
+		vkutil::TransitionImage(commandBuffer, destination.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		return;
+	}
+
+	VkImageMemoryBarrier2 release { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+	release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+	release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	release.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	release.srcQueueFamilyIndex = _enginePtr->_transferQueueFamilyIndex;
+	release.dstQueueFamilyIndex = _enginePtr->_graphicsQueueFamilyIndex;
+	release.image = destination.image;
+	release.subresourceRange = vkinit::ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT);
+	_recordingBatch.imageReleases.push_back(release);
+}
+
+UploadHandle UploadBatcher::Submit() {
+	if (!_bRecording) {
+		// Nothing new was recorded, the latest submitted batch already covers everything.
+		return UploadHandle { _nextBatchId - 1 };
+	}
+
+	const VkCommandBuffer transferCommandBuffer = _recordingBatch.transferCommandBuffer;
+
+	VkSemaphoreSubmitInfo uploadSignalInfo = vkinit::SemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, _uploadTimeline);
+	uploadSignalInfo.value = _recordingBatch.id;
+
+	if (UsesOwnershipTransfer()) {
+		// Release everything the batch wrote in one barrier, the graphics queue acquires it with a matching one.
+		VkDependencyInfo releaseInfo { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+		releaseInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(_recordingBatch.bufferReleases.size());
+		releaseInfo.pBufferMemoryBarriers = _recordingBatch.bufferReleases.data();
+		releaseInfo.imageMemoryBarrierCount = static_cast<uint32_t>(_recordingBatch.imageReleases.size());
+		releaseInfo.pImageMemoryBarriers = _recordingBatch.imageReleases.data();
+		vkCmdPipelineBarrier2(transferCommandBuffer, &releaseInfo);
+		VK_CHECK(vkEndCommandBuffer(transferCommandBuffer));
+
+		VkSemaphoreSubmitInfo transferSignalInfo = vkinit::SemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, _transferTimeline);
+		transferSignalInfo.value = _recordingBatch.id;
+		SubmitCommandBuffer(_enginePtr->_transferQueue, transferCommandBuffer, &transferSignalInfo, nullptr);
+
+		RecordAcquire(_recordingBatch);
+
+		VkSemaphoreSubmitInfo transferWaitInfo = vkinit::SemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, _transferTimeline);
+		transferWaitInfo.value = _recordingBatch.id;
+		SubmitCommandBuffer(_enginePtr->_graphicsQueue, _recordingBatch.acquireCommandBuffer, &uploadSignalInfo, &transferWaitInfo);
+	} else {
+		RecordTransferWriteBarrier(transferCommandBuffer);
+		VK_CHECK(vkEndCommandBuffer(transferCommandBuffer));
+
+		SubmitCommandBuffer(_enginePtr->_transferQueue, transferCommandBuffer, &uploadSignalInfo, nullptr);
+	}
+
+	_recordingBatch.ringEnd = _ringHead;
+	const UploadHandle handle { _recordingBatch.id };
+
+	_inFlightBatches.push_back(std::move(_recordingBatch));
+	_recordingBatch = {};
+	_bRecording = false;
+
+	return handle;
+}
+
+bool UploadBatcher::IsComplete(const UploadHandle handle) {
+	RetireCompletedBatches();
+	return handle.timelineValue <= _completedBatchId;
+}
+
+void UploadBatcher::Wait(const UploadHandle handle) {
+	if (_bRecording && handle.timelineValue >= _recordingBatch.id) {
+		Submit();
+	}
+
+	while (_completedBatchId < handle.timelineValue && !_inFlightBatches.empty()) {
+		WaitForOldestBatch();
+	}
+}
+
+void UploadBatcher::Flush() {
+	Wait(Submit());
+}
+
+void UploadBatcher::RetireCompletedBatches() {
+	if (_inFlightBatches.empty()) {
+		return;
+	}
+
+	uint64_t completedValue = 0;
+	VK_CHECK(vkGetSemaphoreCounterValue(_enginePtr->_logicalGPU, _uploadTimeline, &completedValue));
+
+	while (!_inFlightBatches.empty() && _inFlightBatches.front().id <= completedValue) {
+		RecycleBatch(std::move(_inFlightBatches.front()));
+		_inFlightBatches.pop_front();
+	}
+}
+
+bool UploadBatcher::UsesOwnershipTransfer() const {
+	return _enginePtr->_transferQueueFamilyIndex != _enginePtr->_graphicsQueueFamilyIndex;
+}
+
+UploadBatcher::StagingAllocation UploadBatcher::AllocateStaging(const VkDeviceSize size) {
+	// Too large for the ring, give it a dedicated staging buffer that lives as long as the batch.
+	if (size > _stagingCapacity) {
+		GetRecordingCommandBuffer();
+		const AllocatedBuffer overflowBuffer = _enginePtr->CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+		_recordingBatch.overflowStagingBuffers.push_back(overflowBuffer);
+		return StagingAllocation { overflowBuffer.buffer, 0, overflowBuffer.info.pMappedData };
+	}
+
+	while (true) {
+		// Nothing in the ring is referenced anymore, restart at a physical offset of zero.
+		if (_ringTail == _ringHead) {
+			_ringHead = AlignUp(_ringHead, _stagingCapacity);
+			_ringTail = _ringHead;
+		}
+
+		uint64_t           begin = AlignUp(_ringHead, STAGING_ALIGNMENT);
+		const VkDeviceSize physicalBegin = begin % _stagingCapacity;
+		if (physicalBegin + size > _stagingCapacity) {
+			// An allocation can't straddle the end of the ring, skip to the start.
+			begin += _stagingCapacity - physicalBegin;
+		}
+
+		if (begin + size - _ringTail <= _stagingCapacity) {
+			_ringHead = begin + size;
+			const VkDeviceSize physicalOffset = begin % _stagingCapacity;
+			return StagingAllocation { _stagingRing.buffer, physicalOffset, static_cast<char*>(_stagingRing.info.pMappedData) + physicalOffset };
+		}
+
+		// Ring is full. If only the recording batch holds space, it has to go out before anything can be reclaimed.
+		if (_inFlightBatches.empty()) {
+			Submit();
+		}
+		WaitForOldestBatch();
+	}
+}
+
+VkCommandBuffer UploadBatcher::GetRecordingCommandBuffer() {
+	if (_bRecording) {
+		return _recordingBatch.transferCommandBuffer;
+	}
+
+	RetireCompletedBatches();
+
+	const VkDevice device = _enginePtr->_logicalGPU;
+	if (!_freeBatches.empty()) {
+		_recordingBatch = std::move(_freeBatches.back());
+		_freeBatches.pop_back();
+		VK_CHECK(vkResetCommandBuffer(_recordingBatch.transferCommandBuffer, 0));
+		if (_recordingBatch.acquireCommandBuffer != VK_NULL_HANDLE) {
+			VK_CHECK(vkResetCommandBuffer(_recordingBatch.acquireCommandBuffer, 0));
+		}
+	} else {
+		const VkCommandBufferAllocateInfo transferAllocInfo = vkinit::CommandBufferAllocateInfo(_transferCommandPool, 1);
+		VK_CHECK(vkAllocateCommandBuffers(device, &transferAllocInfo, &_recordingBatch.transferCommandBuffer));
+		if (UsesOwnershipTransfer()) {
+			const VkCommandBufferAllocateInfo acquireAllocInfo = vkinit::CommandBufferAllocateInfo(_graphicsCommandPool, 1);
+			VK_CHECK(vkAllocateCommandBuffers(device, &acquireAllocInfo, &_recordingBatch.acquireCommandBuffer));
+		}
+	}
+
+	_recordingBatch.id = _nextBatchId++;
+	_bRecording = true;
+
+	constexpr VkCommandBufferBeginInfo commandBufferBeginInfo = vkinit::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	VK_CHECK(vkBeginCommandBuffer(_recordingBatch.transferCommandBuffer, &commandBufferBeginInfo));
+
+	return _recordingBatch.transferCommandBuffer;
+}
+
+void UploadBatcher::RecordAcquire(const Batch& batch) const {
+	const VkCommandBuffer              commandBuffer = batch.acquireCommandBuffer;
+
+	constexpr VkCommandBufferBeginInfo commandBufferBeginInfo = vkinit::CommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	VK_CHECK(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+	// Acquire barriers mirror the releases. Queue families and layouts must match, only the access scopes move to the dst side.
+	std::vector<VkBufferMemoryBarrier2> bufferAcquires = batch.bufferReleases;
+	for (VkBufferMemoryBarrier2& acquire : bufferAcquires) {
+		acquire.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+		acquire.srcAccessMask = VK_ACCESS_2_NONE;
+		acquire.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		acquire.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+	}
+
+	std::vector<VkImageMemoryBarrier2> imageAcquires = batch.imageReleases;
+	for (VkImageMemoryBarrier2& acquire : imageAcquires) {
+		acquire.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+		acquire.srcAccessMask = VK_ACCESS_2_NONE;
+		acquire.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+		acquire.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+	}
+
+	VkDependencyInfo acquireInfo { .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+	acquireInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferAcquires.size());
+	acquireInfo.pBufferMemoryBarriers = bufferAcquires.data();
+	acquireInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageAcquires.size());
+	acquireInfo.pImageMemoryBarriers = imageAcquires.data();
+	vkCmdPipelineBarrier2(commandBuffer, &acquireInfo);
+
+	for (const MipmapRequest& request : batch.mipmapRequests) {
+		vkutil::GenerateMipmaps(commandBuffer, request.image, request.extent);
+	}
+
+	RecordTransferWriteBarrier(commandBuffer);
+	VK_CHECK(vkEndCommandBuffer(commandBuffer));
+}
+
+void UploadBatcher::WaitForOldestBatch() {
+	Batch&                    oldestBatch = _inFlightBatches.front();
+
+	const VkSemaphoreWaitInfo waitInfo {
+		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+		.semaphoreCount = 1,
+		.pSemaphores = &_uploadTimeline,
+		.pValues = &oldestBatch.id,
+	};
+	VK_CHECK(vkWaitSemaphores(_enginePtr->_logicalGPU, &waitInfo, UINT64_MAX));
+
+	RecycleBatch(std::move(oldestBatch));
+	_inFlightBatches.pop_front();
+}
+
+void UploadBatcher::RecycleBatch(Batch&& batch) {
+	for (const AllocatedBuffer& overflowBuffer : batch.overflowStagingBuffers) {
+		_enginePtr->DestroyBuffer(overflowBuffer);
+	}
+	batch.overflowStagingBuffers.clear();
+	batch.bufferReleases.clear();
+	batch.imageReleases.clear();
+	batch.mipmapRequests.clear();
+
+	// Batches complete in submission order, the acquire of batch N waits on its own transfer and is queued after N-1
+	_ringTail = std::max(_ringTail, batch.ringEnd);
+	_completedBatchId = batch.id;
+
+	_freeBatches.push_back(std::move(batch));
+}
@@ -0,0 +1,88 @@
+#ifndef VKUPLOADBATCHER_H_
+#define VKUPLOADBATCHER_H_
+
+#include "VkTypes.h"
+
+class PantomirEngine;
+
+// Identifies a submitted upload batch by the value its timeline semaphore reaches once the batch has completed.
+struct UploadHandle {
+	uint64_t timelineValue = 0; // 0 means there is nothing to wait for
+};
+
+// Records many buffer and image uploads into a single command buffer, staged through one persistently mapped ring buffer.
+// Copies run on the transfer queue when the device exposes a separate one. Ownership is then released to the graphics
+// queue, which acquires it and generates mipmaps (blits need a graphics queue). Completion is tracked with a timeline
+// semaphore, so the renderer can poll a handle every frame instead of blocking on it.
+class UploadBatcher {
+public:
+	void         Init(PantomirEngine* engine, VkDeviceSize stagingCapacity);
+	void         Destroy();
+
+	void         EnqueueBufferUpload(VkBuffer destination, const void* data, VkDeviceSize size, VkDeviceSize destinationOffset = 0);
+	void         EnqueueImageUpload(const AllocatedImage& destination, const void* data, VkDeviceSize size, bool mipmapped);
+	// Uploads a mip chain built on the CPU. Region offsets are relative to the start of data.
+	void         EnqueueImageUpload(const AllocatedImage& destination, std::span<const std::byte> data, std::span<const VkBufferImageCopy> mipRegions);
+
+	// Submits everything recorded so far. The returned handle also covers every earlier batch.
+	UploadHandle Submit();
+	bool         IsComplete(UploadHandle handle);
+	void         Wait(UploadHandle handle);
+	void         Flush();
+
+	// Recycles batches the GPU has finished. Cheap, meant to be called once per frame.
+	void         RetireCompletedBatches();
+
+private:
+	struct StagingAllocation {
+		VkBuffer     buffer;
+		VkDeviceSize offset;
+		void*        mappedData;
+	};
+
+	struct MipmapRequest {
+		VkImage    image;
+		VkExtent2D extent;
+	};
+
+	struct Batch {
+		uint64_t                             id = 0; // Also the value both timelines reach for this batch
+		VkCommandBuffer                      transferCommandBuffer = VK_NULL_HANDLE;
+		VkCommandBuffer                      acquireCommandBuffer = VK_NULL_HANDLE; // Only used when transfer and graphics families differ
+		uint64_t                             ringEnd = 0;
+		std::vector<AllocatedBuffer>         overflowStagingBuffers; // Uploads larger than the whole ring
+
+		std::vector<VkBufferMemoryBarrier2>  bufferReleases;
+		std::vector<VkImageMemoryBarrier2>   imageReleases;
+		std::vector<MipmapRequest>           mipmapRequests;
+	};
+
+	bool               UsesOwnershipTransfer() const;
+
+	StagingAllocation  AllocateStaging(VkDeviceSize size);
+	VkCommandBuffer    GetRecordingCommandBuffer();
+	void               RecordAcquire(const Batch& batch) const;
+	void               WaitForOldestBatch();
+	void               RecycleBatch(Batch&& batch);
+
+	PantomirEngine*    _enginePtr = nullptr;
+	VkCommandPool      _transferCommandPool = VK_NULL_HANDLE;
+	VkCommandPool      _graphicsCommandPool = VK_NULL_HANDLE;
+
+	VkSemaphore        _transferTimeline = VK_NULL_HANDLE; // Copies done, graphics side may acquire
+	VkSemaphore        _uploadTimeline = VK_NULL_HANDLE;   // Resources usable by the renderer
+
+	AllocatedBuffer    _stagingRing {};
+	VkDeviceSize       _stagingCapacity = 0;
+	uint64_t           _ringHead = 0; // Monotonic write cursor, the physical offset is taken modulo capacity
+	uint64_t           _ringTail = 0; // Everything before this cursor has been consumed by the GPU
+
+	Batch              _recordingBatch {};
+	bool               _bRecording = false;
+	std::deque<Batch>  _inFlightBatches;
+	std::vector<Batch> _freeBatches;
+	uint64_t           _nextBatchId = 1;
+	uint64_t           _completedBatchId = 0;
+};
+
+#endif /*! VKUPLOADBATCHER_H_ */